@@ -12,6 +12,21 @@ extern "C" {
 #include <stdint.h>              // Find integer types like "uint8_t"  
 #include <stdbool.h>             // Find type "bool"
 
+// Constant data (compile time display list blobs, UI text, log formats) lives in flash.  Non-AVR Arduino cores
+// supply a compatible avr/pgmspace.h, and anywhere else flash is simply ordinary const memory.  Only what is used
+// here is stood in for.  sprintf_P() is always given arguments (the Arduino core's version needs one).
+#ifdef ARDUINO
+#include <avr/pgmspace.h>
+#else
+#define PROGMEM
+#define PSTR(s)                  (s)
+#define pgm_read_byte(a)         (*(const uint8_t *)(a))
+#define strcpy_P                 strcpy
+#define sprintf_P                sprintf
+#define snprintf_P               snprintf
+#define vsnprintf_P              vsnprintf
+#endif
+
 // defines related to hardware and relevant only to the hardware abstraction layer (this and .ino files)
 #define EveChipSelect_PIN          9  // PB1
 #define EveAudioEnable_PIN         1  // PD1
@@ -21,8 +36,17 @@ extern "C" {
 #define OneWire_PIN                5  // PD5
 #define ControlOutput_PIN          8  // PB0
 
+// Chip select and PDN pins of each display, in the order of EveDevices (Eve2_81x.h).  A second display on the bus
+// would be EVE_DEVICE(EveChipSelect_PIN, EvePDN_PIN), EVE_DEVICE(6, 7) with EVE_DEVICES 2.
+#ifndef EVE_DEVICE_PINS
+#define EVE_DEVICE_PINS            EVE_DEVICE(EveChipSelect_PIN, EvePDN_PIN)
+#endif
+
 #define SPISpeed            10000000
 
+#define HEATER_HZ                0.2  // Rate at which the PIDs are stepped - CheckHeaterInterval
+#define LOAD_HZ               0.0625  // CheckSolutionInterval
+
 #define NumProbes                  2
 #define OWTP_Solution              0
 #define OWTP_Plate                 1
@@ -37,8 +61,9 @@ extern "C" {
 #define WorkBuffSz 64UL
 extern char LogBuf[WorkBuffSz];         // The singular universal data array used for all things including logging
 
-#define Log(...)  { sprintf(LogBuf,__VA_ARGS__); DebugPrint(LogBuf); } // Stuff string and parms via sprintf and output
-// #define Log(...) // Liberate (a lot of) RAM by uncommenting this empty definition (remove all serial logging)
+#define Log(Fmt, ...) Log_P(PSTR(Fmt), ##__VA_ARGS__)  // Format string kept in flash - formatted into LogBuf and output
+// #define Log(...) // Liberate flash and a little RAM by uncommenting this empty definition (remove all serial logging)
+void Log_P(const char *Fmt, ...);
 
 void MainLoop(void);
 void GlobalInit(void);
@@ -49,15 +74,34 @@ void SetPin(uint8_t, bool);
 void SD_Init(void);
 void SPI_Enable(void);
 void SPI_Disable(void);
+void SPI_Release(void);
 void SPI_Write(uint8_t data);
 void SPI_WriteByte(uint8_t data);
 void SPI_WriteBuffer(uint8_t *Buffer, uint32_t Length);
 void SPI_ReadBuffer(uint8_t *Buffer, uint32_t Length);
+void SPI_WriteFlash(const uint8_t *Buffer, uint32_t Length);
+void SPI_WriteAsync(const uint8_t *Buffer, uint32_t Length, void (*Done)(void));
+bool SPI_AsyncPoll(void);
+void SPI_AsyncWait(void);
 
 // These functions encapsulate Arduino library functions
 void DebugPrint(char *str);
 void MyDelay(uint32_t DLY);
 uint32_t MyMillis(void);
+uint32_t MyMicros(void);
+void MCU_Sleep(uint32_t Until);
+void FlashRead(void *Dest, const void *Src, uint16_t Length);
+void CheckMemory(void);
+
+// RAM use at run time.  Mem_Paint() fills the free RAM between the heap and the stack with a pattern, first thing
+// in setup(), and Mem_StackUsed() finds how deep the stack has reached into it since.  All are 0 where the board
+// does not say where its stack and heap are.
+#define MEM_CHECK_INTERVAL     60000  // in mS - between CheckMemory() reports
+#define MEM_MIN_FREE             128  // Bytes left between heap and stack below which CheckMemory() warns
+void Mem_Paint(void);
+uint16_t Mem_StackUsed(void);
+uint16_t Mem_HeapPeak(void);
+uint16_t Mem_Free(void);
 void SaveTouchMatrix(void);
 bool LoadTouchMatrix(void);
 void Eve_Reset_HW(void);
@@ -71,21 +115,44 @@ uint8_t PID_Heater_Step(uint16_t SetPoint, uint16_t CurrentVal);
 uint16_t PID_Load_Step(uint16_t SetPoint, uint16_t CurrentVal);
 void PID_ClearAll(void);
 void PID_Load_SetRange(uint16_t Lowend, uint16_t Highend);
-
-// Function encapsulation for file operations
-void FileOpen(char *filename, uint8_t mode);
-void FileClose(void);
-uint8_t FileReadByte(void);
-void FileReadBuf(uint8_t *data, uint32_t NumBytes);
-void FileWrite(uint8_t data);
-void FileWriteStr(uint8_t *str, uint16_t MaxChars);
-uint32_t FileSize(void);
-uint32_t FilePosition(void);
-bool FileSeek(uint32_t offset);
-bool myFileIsOpen(void);
+bool PID_Heater_SetGains(float Kp, float Ki, float Kd);
+bool PID_Load_SetGains(float Kp, float Ki, float Kd);
+void SavePIDGains(void);
+bool LoadPIDGains(void);
+
+// Non volatile storage (EEPROM) for settings.c.  NV_Size() is 0 where the board has none.
+uint16_t NV_Size(void);
+uint8_t NV_Read(uint16_t Address);
+void NV_Write(uint16_t Address, uint8_t Data);
+bool NV_Busy(void);
+void NV_Commit(void);
+
+// Function encapsulation for file operations.  Files are open by handle, from a pool of FILE_HANDLES, so one can
+// stay open (the PID log) while others come and go.  FileOpen() returns FILE_NONE when the file could not be opened
+// or the pool is used up, and every other function does nothing with FILE_NONE.  FILEWRITE starts the file afresh,
+// FILEAPPEND writes on at its end.  Writes are only sure to be on the card after FileFlush() or FileClose().
+#ifndef FILE_HANDLES
+#define FILE_HANDLES               2  // Each one is a File object of RAM in the sketch
+#endif
+#define FILE_NONE               0xFF
+
+typedef uint8_t FileHandle;
+
+FileHandle FileOpen(const char *filename, uint8_t mode);
+void FileClose(FileHandle h);
+void FileFlush(FileHandle h);
+uint8_t FileReadByte(FileHandle h);
+uint32_t FileReadBuf(FileHandle h, uint8_t *data, uint32_t NumBytes);
+void FileWrite(FileHandle h, uint8_t data);
+uint32_t FileWriteBuf(FileHandle h, const uint8_t *data, uint32_t NumBytes);
+uint16_t FileWriteStr(FileHandle h, const char *str, uint16_t MaxChars);
+uint32_t FileSize(FileHandle h);
+uint32_t FilePosition(FileHandle h);
+bool FileSeek(FileHandle h, uint32_t offset);
+void FileRemove(const char *filename);
 
 #ifdef __cplusplus
 }
 #endif
 
-#endif
+#endif
@@ -36,6 +36,7 @@
 // requires adding the base address (RAM_CMD 0x308000) to the resultant 32 bit value.
 
 #include <stdint.h>              // Find integer types like "uint8_t"  
+#include <string.h>              // memset()
 #include "Eve2_81x.h"            // Header for this file with prototypes, defines, and typedefs
 #include "MatrixEve2Conf.h"      // Header for this EVE2 Display configuration settings
 
@@ -49,13 +50,109 @@
 #include "Arduino_AL.h"        // Include the hardware abstraction layer for your target processor
 
 // Global Variables 
-uint16_t FifoWriteLocation = 0;
+EveDevice EveDevices[EVE_DEVICES] = { EVE_DEVICE_PINS };
+#if EVE_DEVICES > 1
+EveDevice *EveDev = EveDevices;
+#endif
+
+const EvePanel EvePanelConf PROGMEM = {
+  HCYCLE, HOFFSET, HSYNC0, HSYNC1, VCYCLE, VOFFSET, VSYNC0, VSYNC1, HSIZE, VSIZE, PCLK, SWIZZLE, PCLK_POL, CSPREAD, DITHER };
+
+#ifdef EVE_STATS
+EveStatsType EveStats;                                             // All displays together
+#endif
+
+#ifdef EVE_SHADOW
+// Register shadow - the last value written to the registers which only we write.  Eve never changes them itself,
+// so writing the same value again is left out and reading one back is answered from here.  Also the coprocessor
+// colours set directly (not captured) and whether REG_ID has been seen.  A hardware reset forgets it all.
+#define SHADOW_FG         0x01
+#define SHADOW_BG         0x02
+
+static int8_t Shadow_Slot(uint32_t address)
+{
+  switch (address)
+  {
+  case REG_CMD_WRITE + RAM_REG: return 0;
+  case REG_PCLK + RAM_REG:      return 1;
+  case REG_PWM_HZ + RAM_REG:    return 2;
+  case REG_PWM_DUTY + RAM_REG:  return 3;
+  case REG_VOL_PB + RAM_REG:    return 4;
+  case REG_VOL_SOUND + RAM_REG: return 5;
+  case REG_SOUND + RAM_REG:     return 6;
+  default:                      return -1;
+  }
+}
+
+// True if the write would change nothing.  Otherwise the shadow takes the new value and the write must be made.
+static bool Shadow_Write(uint32_t address, uint32_t value, uint8_t size)
+{
+  int8_t Slot = Shadow_Slot(address);
+
+  if (Slot < 0)
+    return false;
+  if ((EveDev->ShadowSize[Slot] == size) && (EveDev->ShadowVal[Slot] == value))
+  {
+    EVE_STAT(Suppressed, 1);
+    return true;
+  }
+  EveDev->ShadowVal[Slot] = value;
+  EveDev->ShadowSize[Slot] = size;
+  return false;
+}
+
+// True if the value of the register is known - only from a write of at least the size being read
+static bool Shadow_Read(uint32_t address, uint8_t size, uint32_t *value)
+{
+  int8_t Slot = Shadow_Slot(address);
+
+  if ((Slot < 0) || (EveDev->ShadowSize[Slot] < size))
+    return false;
+  *value = EveDev->ShadowVal[Slot];
+  EVE_STAT(Cached, 1);
+  return true;
+}
 
-// Call this function once at powerup to reset and initialize the Eve chip
+// True if the colour is set already.  Captured commands run later, so they neither use nor change the shadow.
+static bool Shadow_Color(uint32_t *Known, uint8_t Bit, uint32_t c)
+{
+  if (EveDev->CaptureBuf)
+    return false;
+  if ((EveDev->ShadowColors & Bit) && (*Known == c))
+  {
+    EVE_STAT(Suppressed, 1);
+    return true;
+  }
+  *Known = c;
+  EveDev->ShadowColors |= Bit;
+  return false;
+}
+#endif
+
+// Make the display at Index of EveDevices the one every other function works on.  A frame still going out to the
+// display selected before is let finish, as its chip select and FIFO pointer are that display's.
+void Eve_Select(uint8_t Index)
+{
+#if EVE_DEVICES > 1
+  if ((Index >= EVE_DEVICES) || (EveDev == &EveDevices[Index]))
+    return;
+#ifdef EVE_ASYNC
+  SPI_AsyncWait();
+#endif
+  EveDev = &EveDevices[Index];
+#else
+  (void)Index;
+#endif
+}
+
+// Call this function once at powerup to reset and initialize the selected Eve chip
 void FT81x_Init(void)
 {  
   uint8_t ready = false;
-  
+  EvePanel Panel;
+
+  FlashRead(&Panel, EveDev->Panel ? EveDev->Panel : &EvePanelConf, sizeof(Panel));
+
   Eve_Reset(); // Hard reset of the Eve chip
 
   // Wakeup Eve
@@ -74,20 +171,20 @@ void FT81x_Init(void)
 
   // load parameters of the physical screen to the Eve
   // All of these registers are 32 bits, but most bits are reserved, so only write what is actually used
-  wr16(REG_HCYCLE + RAM_REG, HCYCLE);         // Set H_Cycle to 548
-  wr16(REG_HOFFSET + RAM_REG, HOFFSET);       // Set H_Offset to 43
-  wr16(REG_HSYNC0 + RAM_REG, HSYNC0);         // Set H_SYNC_0 to 0
-  wr16(REG_HSYNC1 + RAM_REG, HSYNC1);         // Set H_SYNC_1 to 41
-  wr16(REG_VCYCLE + RAM_REG, VCYCLE);         // Set V_Cycle to 292
-  wr16(REG_VOFFSET + RAM_REG, VOFFSET);       // Set V_OFFSET to 12
-  wr16(REG_VSYNC0 + RAM_REG, VSYNC0);         // Set V_SYNC_0 to 0
-  wr16(REG_VSYNC1 + RAM_REG, VSYNC1);         // Set V_SYNC_1 to 10
-  wr8(REG_SWIZZLE + RAM_REG, SWIZZLE);        // Set SWIZZLE to 0
-  wr8(REG_PCLK_POL + RAM_REG, PCLK_POL);      // Set PCLK_POL to 1
-  wr16(REG_HSIZE + RAM_REG, HSIZE);           // Set H_SIZE to 480
-  wr16(REG_VSIZE + RAM_REG, VSIZE);           // Set V_SIZE to 272
-  wr8(REG_CSPREAD + RAM_REG, CSPREAD);        // Set CSPREAD to 1    (32 bit register - write only 8 bits)
-  wr8(REG_DITHER + RAM_REG, DITHER);          // Set DITHER to 1     (32 bit register - write only 8 bits)
+  wr16(REG_HCYCLE + RAM_REG, Panel.HCycle);   // Set H_Cycle to 548
+  wr16(REG_HOFFSET + RAM_REG, Panel.HOffset); // Set H_Offset to 43
+  wr16(REG_HSYNC0 + RAM_REG, Panel.HSync0);   // Set H_SYNC_0 to 0
+  wr16(REG_HSYNC1 + RAM_REG, Panel.HSync1);   // Set H_SYNC_1 to 41
+  wr16(REG_VCYCLE + RAM_REG, Panel.VCycle);   // Set V_Cycle to 292
+  wr16(REG_VOFFSET + RAM_REG, Panel.VOffset); // Set V_OFFSET to 12
+  wr16(REG_VSYNC0 + RAM_REG, Panel.VSync0);   // Set V_SYNC_0 to 0
+  wr16(REG_VSYNC1 + RAM_REG, Panel.VSync1);   // Set V_SYNC_1 to 10
+  wr8(REG_SWIZZLE + RAM_REG, Panel.Swizzle);  // Set SWIZZLE to 0
+  wr8(REG_PCLK_POL + RAM_REG, Panel.PClkPol); // Set PCLK_POL to 1
+  wr16(REG_HSIZE + RAM_REG, Panel.HSize);     // Set H_SIZE to 480
+  wr16(REG_VSIZE + RAM_REG, Panel.VSize);     // Set V_SIZE to 272
+  wr8(REG_CSPREAD + RAM_REG, Panel.CSpread);  // Set CSPREAD to 1    (32 bit register - write only 8 bits)
+  wr8(REG_DITHER + RAM_REG, Panel.Dither);    // Set DITHER to 1     (32 bit register - write only 8 bits)
 
   // configure touch & audio
   wr16(REG_TOUCH_RZTHRESH + RAM_REG, 1200);          // set touch resistance threshold
@@ -106,7 +203,7 @@ void FT81x_Init(void)
   wr32(RAM_DL+4, CLEAR(1,1,1));
   wr32(RAM_DL+8, DISPLAY());
   wr8(REG_DLSWAP + RAM_REG, DLSWAP_FRAME);          // swap display lists
-  wr8(REG_PCLK + RAM_REG, 5);                       // after this display is visible on the LCD
+  wr8(REG_PCLK + RAM_REG, Panel.PClk);              // after this display is visible on the LCD
 
 //  Log("First screen written\n");
 }
@@ -114,7 +211,17 @@ void FT81x_Init(void)
 // Reset Eve chip via the hardware PDN line
 void Eve_Reset(void)
 {
+#ifdef EVE_ASYNC
+  SPI_AsyncWait();
+  EveDev->StageLen = 0;
+#endif
+  EveDev->RoomLeft = 0;
   Eve_Reset_HW();
+#ifdef EVE_SHADOW
+  memset(EveDev->ShadowSize, 0, sizeof(EveDev->ShadowSize));
+  EveDev->ShadowColors = 0;
+  EveDev->ShadowID = false;
+#endif
 }
 
 // *** Host Command - FT81X Embedded Video Engine Datasheet - 4.1.5 **********************************************
@@ -132,6 +239,8 @@ void HostCommand(uint8_t HCMD)
   SPI_Write(0x00);   
   
   SPI_Disable();
+  EVE_STAT(Frames, 1);
+  EVE_STAT(Bytes, 3);
 }
 
 // *** Eve API Reference Definitions *****************************************************************************
@@ -140,6 +249,11 @@ void HostCommand(uint8_t HCMD)
 // ***************************************************************************************************************
 void wr32(uint32_t address, uint32_t parameter)
 {
+#ifdef EVE_SHADOW
+  if (Shadow_Write(address, parameter, 4))
+    return;
+#endif
+
   SPI_Enable();
   
   SPI_Write((uint8_t)((address >> 16) | 0x80));   // RAM_REG = 0x302000 and high bit is set - result always 0xB0
@@ -152,10 +266,17 @@ void wr32(uint32_t address, uint32_t parameter)
   SPI_Write((uint8_t)((parameter >> 24) & 0xff));
   
   SPI_Disable();
+  EVE_STAT(Frames, 1);
+  EVE_STAT(Bytes, 7);
 }
 
 void wr16(uint32_t address, uint16_t parameter)
 {
+#ifdef EVE_SHADOW
+  if (Shadow_Write(address, parameter, 2))
+    return;
+#endif
+
   SPI_Enable();
   
   SPI_Write((uint8_t)((address >> 16) | 0x80)); // RAM_REG = 0x302000 and high bit is set - result always 0xB0
@@ -166,10 +287,17 @@ void wr16(uint32_t address, uint16_t parameter)
   SPI_Write((uint8_t)(parameter >> 8));
   
   SPI_Disable();
+  EVE_STAT(Frames, 1);
+  EVE_STAT(Bytes, 5);
 }
 
 void wr8(uint32_t address, uint8_t parameter)
 {
+#ifdef EVE_SHADOW
+  if (Shadow_Write(address, parameter, 1))
+    return;
+#endif
+
   SPI_Enable();
   
   SPI_Write((uint8_t)((address >> 16) | 0x80)); // RAM_REG = 0x302000 and high bit is set - result always 0xB0
@@ -179,6 +307,8 @@ void wr8(uint32_t address, uint8_t parameter)
   SPI_Write(parameter);             
   
   SPI_Disable();
+  EVE_STAT(Frames, 1);
+  EVE_STAT(Bytes, 4);
 }
 
 uint32_t rd32(uint32_t address)
@@ -186,6 +316,11 @@ uint32_t rd32(uint32_t address)
   uint8_t buf[4];
   uint32_t Data32;
   
+#ifdef EVE_SHADOW
+  if (Shadow_Read(address, 4, &Data32))
+    return (Data32);
+#endif
+
   SPI_Enable();
   
   SPI_Write((address >> 16) & 0x3F);    
@@ -195,6 +330,8 @@ uint32_t rd32(uint32_t address)
   SPI_ReadBuffer(buf, 4);
   
   SPI_Disable();
+  EVE_STAT(Frames, 1);
+  EVE_STAT(Bytes, 8);
   
   Data32 = buf[0] + ((uint32_t)buf[1] << 8) + ((uint32_t)buf[2] << 16) + ((uint32_t)buf[3] << 24);
   return (Data32);  
@@ -204,6 +341,13 @@ uint16_t rd16(uint32_t address)
 {
   uint8_t buf[2];
     
+#ifdef EVE_SHADOW
+  uint32_t Known;
+
+  if (Shadow_Read(address, 2, &Known))
+    return (Known);
+#endif
+
   SPI_Enable();
   
   SPI_Write((address >> 16) & 0x3F);    
@@ -213,6 +357,8 @@ uint16_t rd16(uint32_t address)
   SPI_ReadBuffer(buf, 2);
   
   SPI_Disable();
+  EVE_STAT(Frames, 1);
+  EVE_STAT(Bytes, 6);
   
   uint16_t Data16 = buf[0] + ((uint16_t)buf[1] << 8);
   return (Data16);  
@@ -222,6 +368,13 @@ uint8_t rd8(uint32_t address)
 {
   uint8_t buf[1];
   
+#ifdef EVE_SHADOW
+  uint32_t Known;
+
+  if (Shadow_Read(address, 1, &Known))
+    return (Known);
+#endif
+
   SPI_Enable();
   
   SPI_Write((address >> 16) & 0x3F);    
@@ -231,19 +384,343 @@ uint8_t rd8(uint32_t address)
   SPI_ReadBuffer(buf, 1);
   
   SPI_Disable();
+  EVE_STAT(Frames, 1);
+  EVE_STAT(Bytes, 5);
   
   return (buf[0]);  
 }
 
+// *** Eve_RunBatch() - run a list of register reads and writes back to back ************************************
+// Each operation would otherwise be a call of its own to rd8() ... wr32().  Here they all go out in one call, and an
+// operation at the address following the one before it, going the same way, shares that one's chip select frame:
+// Eve steps the address itself, so the address bytes (and the dummy byte of a read) are sent once for the run.
+// The bus is claimed by the first frame and not let go between frames (see SPI_Release()).
+void Eve_RunBatch(EveRegOp *Ops, uint8_t Count)
+{
+  uint8_t Buf[EVE_BATCH_RUN];
+  uint8_t First, Last, Len, Pos, i;
+  uint32_t Value;
+
+#ifdef EVE_STATS
+  EveStats.Batches++;
+  EveStats.BatchOps += Count;
+  if (Count > EveStats.BatchMax)
+    EveStats.BatchMax = Count;
+#endif
+
+  for (First = 0; First < Count; First = Last)
+  {
+#ifdef EVE_SHADOW
+    Last = First + 1;
+    if (Ops[First].Write && Shadow_Write(Ops[First].Address, Ops[First].Value, Ops[First].Size))
+      continue;
+#endif
+
+    // Find the run of operations carrying on from this one
+    Len = Ops[First].Size;
+    for (Last = First + 1; Last < Count; Last++)
+    {
+      if ((Ops[Last].Write != Ops[First].Write) || (Ops[Last].Address != Ops[First].Address + Len) ||
+          (Len + Ops[Last].Size > EVE_BATCH_RUN))
+        break;
+#ifdef EVE_SHADOW
+      if (Ops[Last].Write)                                         // Cheaper to write along than to break the frame
+        Shadow_Write(Ops[Last].Address, Ops[Last].Value, Ops[Last].Size);
+#endif
+      Len += Ops[Last].Size;
+    }
+    EVE_STAT(BatchFrames, 1);
+    EVE_STAT(BatchSaved, (uint32_t)(Last - First - 1) * (Ops[First].Write ? 3 : 4));
+
+    SPI_Enable();
+    SPI_Write((uint8_t)((Ops[First].Address >> 16) | (Ops[First].Write ? 0x80 : 0)));
+    SPI_Write((uint8_t)(Ops[First].Address >> 8));
+    SPI_Write((uint8_t)Ops[First].Address);
+    if (Ops[First].Write)
+    {
+      for (i = First; i < Last; i++)
+        for (Pos = 0; Pos < Ops[i].Size; Pos++)
+          SPI_Write((uint8_t)(Ops[i].Value >> (Pos * 8)));     // Little endian
+    }
+    else
+    {
+      SPI_ReadBuffer(Buf, Len);                                    // Dummy byte and then the whole run
+      for (i = First, Pos = 0; i < Last; Pos += Ops[i].Size, i++)
+      {
+        Value = Buf[Pos];
+        if (Ops[i].Size > 1)
+          Value |= (uint16_t)Buf[Pos + 1] << 8;
+        if (Ops[i].Size > 2)
+          Value |= ((uint32_t)Buf[Pos + 2] << 16) | ((uint32_t)Buf[Pos + 3] << 24);
+        if (!Ops[i].Result)
+          continue;
+        if (Ops[i].Size == 1)
+          *(uint8_t *)Ops[i].Result = Value;
+        else if (Ops[i].Size == 2)
+          *(uint16_t *)Ops[i].Result = Value;
+        else
+          *(uint32_t *)Ops[i].Result = Value;
+      }
+    }
+    SPI_Disable();
+    EVE_STAT(Frames, 1);
+    EVE_STAT(Bytes, 3 + Len + (Ops[First].Write ? 0 : 1));
+  }
+}
+
+// *** Eve_ReadTouch() - take one consistent sample of the touch engine *****************************************
+// REG_TOUCH_RAW_XY through REG_TOUCH_TAG are neighbours and come in one frame, so the tag belongs to the same
+// conversion as the coordinates and there is no need to wait for the next one before reading it.  REG_TRACKER
+// is elsewhere and costs a second frame, so it is only read when Tracker is set.
+void Eve_ReadTouch(EveTouch *Touch, uint8_t Tracker)
+{
+  EveRegOp Ops[6] = {
+    EVE_RD32(REG_TOUCH_RAW_XY + RAM_REG, &Touch->RawXY),
+    EVE_RD32(REG_TOUCH_RZ + RAM_REG, &Touch->RZ),
+    EVE_RD32(REG_TOUCH_SCREEN_XY + RAM_REG, &Touch->ScreenXY),
+    EVE_RD32(REG_TOUCH_TAG_XY + RAM_REG, &Touch->TagXY),
+    EVE_RD8(REG_TOUCH_TAG + RAM_REG, &Touch->Tag),
+    EVE_RD32(REG_TRACKER + RAM_REG, &Touch->Tracker) };
+
+  Touch->Tracker = 0;
+  Eve_RunBatch(Ops, Tracker ? 6 : 5);
+}
+
+// Log the SPI traffic counted since power up - nothing unless EVE_STATS is defined
+void Eve_LogStats(void)
+{
+#ifdef EVE_STATS
+  Log("SPI: %lu frames %lu bytes\n", (unsigned long)EveStats.Frames, (unsigned long)EveStats.Bytes);   // Log() has
+  Log("Batch: %lu, %lu ops in %lu frames\n", (unsigned long)EveStats.Batches,                   // WorkBuffSz chars
+      (unsigned long)EveStats.BatchOps, (unsigned long)EveStats.BatchFrames);
+  Log("Batch max %u, %lu bytes saved\n", EveStats.BatchMax, (unsigned long)EveStats.BatchSaved);
+  Log("Shadow: %lu writes, %lu reads saved\n", (unsigned long)EveStats.Suppressed, (unsigned long)EveStats.Cached);
+#endif
+}
+
+#ifdef EVE_ASYNC
+// *** Command staging - double buffered FIFO writes ************************************************************
+// Commands for the FIFO are collected in one half of StageBuf.  Stage_Flush() starts that half on its way to the
+// FIFO with SPI_WriteAsync() and switches to the other half, so the next commands are made while these are on the
+// wire.  FifoWriteLocation moves as commands are staged; REG_CMD_WRITE is only written once the bytes are in Eve.
+static void Stage_Sent(void)
+{
+  uint16_t Len = EveDev->WrappedLen;
+
+  SPI_Disable();
+  if (Len)                                                         // The rest of it from the start of the FIFO
+  {
+    EveDev->WrappedLen = 0;
+    StartCoProTransfer(RAM_CMD, false);
+    SPI_WriteAsync(EveDev->Wrapped, Len, Stage_Sent);
+    EVE_STAT(Bytes, Len);
+    return;
+  }
+  if (EveDev->Publish)
+    wr16(REG_CMD_WRITE + RAM_REG, EveDev->PublishAt);              // Now Eve may start on it
+}
+
+// Send what is staged, writing REG_CMD_WRITE afterwards if Done.  Returns as soon as it is on its way.
+static void Stage_Flush(bool Done)
+{
+  uint16_t Len;
+
+  if (!EveDev->StageLen)
+  {
+    SPI_AsyncWait();                                               // Let a pending pointer write land first
+    if (Done)
+      wr16(REG_CMD_WRITE + RAM_REG, EveDev->WriteLocation);
+    return;
+  }
+
+  SPI_AsyncWait();                                                 // The other half may still be going
+  Len = FT_CMD_FIFO_SIZE - EveDev->StageStart;                     // Room before the FIFO wraps
+  if (Len > EveDev->StageLen)
+    Len = EveDev->StageLen;
+  EveDev->Wrapped = EveDev->StageBuf[EveDev->Stage] + Len;
+  EveDev->WrappedLen = EveDev->StageLen - Len;
+  EveDev->Publish = Done;
+  EveDev->PublishAt = EveDev->WriteLocation;
+
+  StartCoProTransfer(EveDev->StageStart + RAM_CMD, false);
+  SPI_WriteAsync(EveDev->StageBuf[EveDev->Stage], Len, Stage_Sent);
+  EVE_STAT(Bytes, Len);
+
+  EveDev->Stage ^= 1;
+  EveDev->StageLen = 0;
+}
+
+// Add bytes for the FIFO to the staging buffer, sending it on when it is full.  Words are copied as they are in
+// memory, which is the order Eve wants on the little endian processors EVE_ASYNC is for.
+static void Stage_Write(const uint8_t *Data, uint16_t Len, bool Flash)
+{
+  uint16_t Part;
+
+  while (Len)
+  {
+    if (EveDev->StageLen == EVE_STAGE_SIZE)
+      Stage_Flush(false);
+    if (!EveDev->StageLen)
+      EveDev->StageStart = EveDev->WriteLocation;
+
+    Part = EVE_STAGE_SIZE - EveDev->StageLen;
+    if (Part > Len)
+      Part = Len;
+    if (Flash)
+      FlashRead(EveDev->StageBuf[EveDev->Stage] + EveDev->StageLen, Data, Part);
+    else
+      memcpy(EveDev->StageBuf[EveDev->Stage] + EveDev->StageLen, Data, Part);
+
+    EveDev->StageLen += Part;
+    Data += Part;
+    Len -= Part;
+    EveDev->WriteLocation = (EveDev->WriteLocation + Part) % FT_CMD_FIFO_SIZE;
+  }
+}
+#endif
+
 // *** Send_Cmd() - this is like cmd() in (some) Eve docs - sends 32 bits but does not update the write pointer ***
 // FT81x Series Programmers Guide Section 5.1.1 - Circular Buffer (AKA "the FIFO" and "Command buffer" and "CoProcessor")
 // Don't miss section 5.3 - Interaction with RAM_DL
 void Send_CMD(uint32_t data)
 {
-  wr32(FifoWriteLocation + RAM_CMD, data);                         // write the command at the globally tracked "write pointer" for the FIFO
+  if (EveDev->CaptureBuf)                                          // Capturing commands for later (see CoProCaptureStart())
+  {
+    if (EveDev->CaptureCount < EveDev->CaptureMax)
+      EveDev->CaptureBuf[EveDev->CaptureCount] = data;
+    EveDev->CaptureCount++;                                        // Counts on past the end so that overflow can be seen
+    return;
+  }
+
+  EveDev->RoomLeft = 0;                                            // What CoProWrCmdBuf() saw of the FIFO is gone
+#ifdef EVE_ASYNC
+  Stage_Write((const uint8_t *)&data, FT_CMD_SIZE, false);         // Staged - it goes out with the rest at UpdateFIFO()
+#else
+  wr32(EveDev->WriteLocation + RAM_CMD, data);                     // write the command at the globally tracked "write pointer" for the FIFO
+
+  EveDev->WriteLocation += FT_CMD_SIZE;                            // Increment the Write Address by the size of a command - which we just sent
+  EveDev->WriteLocation %= FT_CMD_FIFO_SIZE;                       // Wrap the address to the FIFO space
+#endif
+}
+
+// *** Send_CMD_Str() - pack a null terminated string into command words and send them **************************
+// Strings follow their command 4 bytes at a time, little endian, padded with zeros to a whole word.  At least one
+// word always goes out so that the terminator is present - even for an empty string.
+void Send_CMD_Str(const char *str)
+{
+  uint32_t Word;
+  uint8_t Shift;
+
+  do {
+    Word = 0;
+    for (Shift = 0; (Shift < 32) && *str; Shift += 8)
+      Word |= (uint32_t)(uint8_t)*str++ << Shift;
+    Send_CMD(Word);                                                // These text bytes get sucked up 4 at a time and fired at the FIFO
+  }while (Shift == 32);                                            // A full word means the terminator is yet to be sent
+}
+
+// *** Send_CMD_Str_P() - Send_CMD_Str() for a string in flash (PROGMEM), so constant text never takes up RAM ******
+void Send_CMD_Str_P(const char *str)
+{
+  uint32_t Word;
+  uint8_t Shift, c;
+
+  do {
+    Word = 0;
+    for (Shift = 0; (Shift < 32) && (c = pgm_read_byte(str)); Shift += 8, str++)
+      Word |= (uint32_t)c << Shift;
+    Send_CMD(Word);
+  }while (Shift == 32);
+}
+
+// Stream a run of command words into the FIFO behind a single address header - two if the run crosses the end of
+// the FIFO space.  Words come either from flash or from RAM.  Like Send_CMD(), this does not update the write pointer.
+static void Send_CMD_Run(const uint32_t *Words, uint16_t Count, bool Flash)
+{
+  uint16_t Run, i;
+
+  if (EveDev->CaptureBuf)                                          // Capturing - copy the words instead of sending them
+  {
+    for (i = 0; i < Count; i++)
+    {
+      if (EveDev->CaptureCount + i < EveDev->CaptureMax)
+      {
+        if (Flash)
+          FlashRead(&EveDev->CaptureBuf[EveDev->CaptureCount + i], &Words[i], FT_CMD_SIZE);
+        else
+          EveDev->CaptureBuf[EveDev->CaptureCount + i] = Words[i];
+      }
+    }
+    EveDev->CaptureCount += Count;
+    return;
+  }
+
+  EveDev->RoomLeft = 0;                                            // As in Send_CMD()
+#ifdef EVE_SHADOW
+  EveDev->ShadowColors = 0;                                        // The words may set colours of their own
+#endif
+#ifdef EVE_ASYNC
+  Stage_Write((const uint8_t *)Words, Count * FT_CMD_SIZE, Flash);
+  return;
+#endif
+  while (Count)
+  {
+    Run = (FT_CMD_FIFO_SIZE - EveDev->WriteLocation) / FT_CMD_SIZE; // Number of words which fit before the FIFO wraps
+    if (Run > Count)
+      Run = Count;
+
+    StartCoProTransfer(EveDev->WriteLocation + RAM_CMD, false);    // Address header for the current write pointer
+    if (Flash)
+      SPI_WriteFlash((const uint8_t *)Words, (uint32_t)Run * FT_CMD_SIZE); // Words are stored little endian just as Eve wants them
+    else
+    {
+      for (i = 0; i < Run; i++)
+      {
+        SPI_Write((uint8_t)Words[i]);                              // Little endian regardless of what the MCU is
+        SPI_Write((uint8_t)(Words[i] >> 8));
+        SPI_Write((uint8_t)(Words[i] >> 16));
+        SPI_Write((uint8_t)(Words[i] >> 24));
+      }
+    }
+    SPI_Disable();
+    EVE_STAT(Bytes, (uint32_t)Run * FT_CMD_SIZE);
+
+    Words += Run;
+    Count -= Run;
+    EveDev->WriteLocation = (EveDev->WriteLocation + (Run * FT_CMD_SIZE)) % FT_CMD_FIFO_SIZE;
+  }
+}
+
+// *** Send_CMD_Blob() - stream a run of pre-encoded command words out of flash into the FIFO *******************
+// The words are encoded at compile time (see Eve2_81x_DL.h) so there is no packing to be done here.  Instead of
+// one complete wr32() transaction per word, the whole run goes out in one transaction.
+void Send_CMD_Blob(const uint32_t *Blob, uint16_t Words)
+{
+  Send_CMD_Run(Blob, Words, true);
+}
+
+// *** Send_CMD_Words() - stream a run of already encoded command words out of RAM into the FIFO ****************
+void Send_CMD_Words(const uint32_t *Words, uint16_t Count)
+{
+  Send_CMD_Run(Words, Count, false);
+}
+
+// *** CoProCaptureStart() / CoProCaptureStop() - record commands instead of sending them ***********************
+// Everything which goes through Send_CMD() - and therefore every Cmd_xxx() function - is stored into Buffer until
+// CoProCaptureStop() is called.  The captured words may be sent later with Send_CMD_Words().  This allows command 
+// sequences to be encoded once and sent many times.  Stop returns the number of words the commands needed, which 
+// is more than Max if they did not all fit.
+void CoProCaptureStart(uint32_t *Buffer, uint16_t Max)
+{
+  EveDev->CaptureBuf = Buffer;
+  EveDev->CaptureMax = Max;
+  EveDev->CaptureCount = 0;
+}
 
-  FifoWriteLocation += FT_CMD_SIZE;                                // Increment the Write Address by the size of a command - which we just sent
-  FifoWriteLocation %= FT_CMD_FIFO_SIZE;                           // Wrap the address to the FIFO space
+uint16_t CoProCaptureStop(void)
+{
+  EveDev->CaptureBuf = 0;
+  return (EveDev->CaptureCount);
 }
 
 // UpdateFIFO - Cause the CoProcessor to realize that it has work to do in the form of a 
@@ -251,7 +728,11 @@ void Send_CMD(uint32_t data)
 // nothing until you tell it that the write position in the FIFO RAM has changed
 void UpdateFIFO(void)
 {
-  wr16(REG_CMD_WRITE + RAM_REG, FifoWriteLocation);               // We manually update the write position pointer
+#ifdef EVE_ASYNC
+  Stage_Flush(true);                                               // Sent while the caller gets on, then the pointer
+#else
+  wr16(REG_CMD_WRITE + RAM_REG, EveDev->WriteLocation);           // We manually update the write position pointer
+#endif
 }
 
 // Read the specific ID register and return TRUE if it is the expected 0x7C otherwise.
@@ -259,16 +740,28 @@ uint8_t Cmd_READ_REG_ID(void)
 {
   uint8_t readData[2];
   
+#ifdef EVE_SHADOW
+  if (EveDev->ShadowID)              // It does not change once Eve is up
+  {
+    EVE_STAT(Cached, 1);
+    return 1;
+  }
+#endif
   SPI_Enable();
   SPI_Write(0x30);                   // Base address RAM_REG = 0x302000
   SPI_Write(0x20);    
   SPI_Write(REG_ID);                 // REG_ID offset = 0x00
   SPI_ReadBuffer(readData, 1);       // There was a dummy read of the first byte in there
   SPI_Disable();
+  EVE_STAT(Frames, 1);
+  EVE_STAT(Bytes, 5);
   
   if (readData[0] == 0x7C)           // FT81x Datasheet section 5.1, Table 5-2. Return value always 0x7C
   {
 //    Log("\nGood ID: 0x%02x\n", readData[0]);
+#ifdef EVE_SHADOW
+    EveDev->ShadowID = true;
+#endif
     return 1;
   }
   else
@@ -358,60 +851,53 @@ void Cmd_Gradient(uint16_t x0, uint16_t y0, uint32_t rgb0, uint16_t x1, uint16_t
 // *** Draw Button - FT81x Series Programmers Guide Section 5.28 **************************************************
 void Cmd_Button(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t font, uint16_t options, const char* str)
 { 
-  uint16_t DataPtr, LoopCount, StrPtr;
-  
-  uint16_t length = strlen(str);
-  if(!length) 
+  if(!*str) 
     return;
   
-  uint32_t* data = (uint32_t*) calloc((length/4)+1, sizeof(uint32_t));
-  
-  StrPtr = 0;
-  for(DataPtr=0; DataPtr<(length/4); DataPtr++, StrPtr += 4)
-    data[DataPtr] = (uint32_t)str[StrPtr+3]<<24 | (uint32_t)str[StrPtr+2]<<16 | (uint32_t)str[StrPtr+1]<<8 | (uint32_t)str[StrPtr];
-  
-  for(LoopCount=0; LoopCount<(length%4); LoopCount++, StrPtr++)
-    data[DataPtr] |= (uint32_t)str[StrPtr] << (LoopCount * 8);
-  
   Send_CMD(CMD_BUTTON);
   Send_CMD( ((uint32_t)y << 16) | x ); // Put two 16 bit values together into one 32 bit value - do it little endian
   Send_CMD( ((uint32_t)h << 16) | w );
   Send_CMD( ((uint32_t)options << 16) | font );
-  
-  for(LoopCount=0; LoopCount <= length/4; LoopCount++)
-    Send_CMD(data[LoopCount]);
-
-  free(data);
+  Send_CMD_Str(str);
 }
 
 // *** Draw Text - FT81x Series Programmers Guide Section 5.41 ***************************************************
 void Cmd_Text(uint16_t x, uint16_t y, uint16_t font, uint16_t options, const char* str)
 {
-  uint16_t DataPtr, LoopCount, StrPtr;
-  
-  uint16_t length = strlen(str);
-  if(!length) 
+  if(!*str) 
     return; 
   
-  uint32_t* data = (uint32_t*) calloc((length / 4) + 1, sizeof(uint32_t)); // Allocate memory for the string expansion
-  
-  StrPtr = 0;
-  for(DataPtr=0; DataPtr<(length/4); ++DataPtr, StrPtr=StrPtr+4)
-    data[DataPtr] = (uint32_t)str[StrPtr+3]<<24 | (uint32_t)str[StrPtr+2]<<16 | (uint32_t)str[StrPtr+1]<<8 | (uint32_t)str[StrPtr];
-  
-  for(LoopCount=0; LoopCount<(length%4); ++LoopCount, ++StrPtr)
-    data[DataPtr] |= (uint32_t)str[StrPtr] << (LoopCount*8);
-
   // Set up the command
   Send_CMD(CMD_TEXT);
   Send_CMD( ((uint32_t)y << 16) | x );
   Send_CMD( ((uint32_t)options << 16) | font );
 
   // Send out the text
-  for(LoopCount = 0; LoopCount <= length/4; LoopCount++)
-    Send_CMD(data[LoopCount]);  // These text bytes get sucked up 4 at a time and fired at the FIFO
+  Send_CMD_Str(str);
+}
 
-  free(data);
+// *** Cmd_Button() and Cmd_Text() with the text in flash (PROGMEM) **********************************************
+void Cmd_Button_P(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t font, uint16_t options, const char* str)
+{
+  if(!pgm_read_byte(str))
+    return;
+
+  Send_CMD(CMD_BUTTON);
+  Send_CMD( ((uint32_t)y << 16) | x );
+  Send_CMD( ((uint32_t)h << 16) | w );
+  Send_CMD( ((uint32_t)options << 16) | font );
+  Send_CMD_Str_P(str);
+}
+
+void Cmd_Text_P(uint16_t x, uint16_t y, uint16_t font, uint16_t options, const char* str)
+{
+  if(!pgm_read_byte(str))
+    return;
+
+  Send_CMD(CMD_TEXT);
+  Send_CMD( ((uint32_t)y << 16) | x );
+  Send_CMD( ((uint32_t)options << 16) | font );
+  Send_CMD_Str_P(str);
 }
 
 // ******************** Miscellaneous Operation CoProcessor Command Functions ******************************
@@ -451,6 +937,10 @@ void Cmd_GradientColor(uint32_t c)
 // *** Set FG color - FT81x Series Programmers Guide Section 5.30 ************************************************
 void Cmd_FGcolor(uint32_t c)
 {
+#ifdef EVE_SHADOW
+  if (Shadow_Color(&EveDev->ShadowFG, SHADOW_FG, c))                    // Already that colour
+    return;
+#endif
   Send_CMD(CMD_FGCOLOR);
   Send_CMD(c);
 }
@@ -458,6 +948,10 @@ void Cmd_FGcolor(uint32_t c)
 // *** Set BG color - FT81x Series Programmers Guide Section 5.31 ************************************************
 void Cmd_BGcolor(uint32_t c)
 {
+#ifdef EVE_SHADOW
+  if (Shadow_Color(&EveDev->ShadowBG, SHADOW_BG, c))                    // Already that colour
+    return;
+#endif
   Send_CMD(CMD_BGCOLOR);
   Send_CMD(c);
 }
@@ -500,98 +994,6 @@ void Cmd_Calibrate(uint32_t result)
   Send_CMD(result);
 }
 
-// An interactive calibration screen is created and executed.  
-// New calibration values are written to the touch matrix registers of Eve.
-void Calibrate_Manual(uint16_t Width, uint16_t Height, uint16_t V_Offset, uint16_t H_Offset)
-{
-  uint32_t displayX[3], displayY[3];
-  uint32_t touchX[3], touchY[3]; 
-  uint32_t touchValue = 0, storedValue = 0;  
-  int32_t tmp, k;
-  int32_t TransMatrix[6];
-  uint8_t count = 0;
-  char num[2];
-
-  // These values determine where your calibration points will be drawn on your display
-  displayX[0] = (Width * 0.15) + H_Offset;
-  displayY[0] = (Height * 0.15) + V_Offset;
-  
-  displayX[1] = (Width * 0.85) + H_Offset;
-  displayY[1] = (Height / 2) + V_Offset;
-  
-  displayX[2] = (Width / 2) + H_Offset;
-  displayY[2] = (Height * 0.85) + V_Offset;
-
-  while (count < 3) 
-  {
-    Send_CMD(CMD_DLSTART);
-    Send_CMD(CLEAR_COLOR_RGB(64, 64, 64));
-    Send_CMD(CLEAR(1,1,1));
-
-    // Draw Calibration Point on screen
-    Send_CMD(COLOR_RGB(255, 0, 0));
-    Send_CMD(POINT_SIZE(20 * 16));
-    Send_CMD(BEGIN(POINTS));
-    Send_CMD(VERTEX2F((uint32_t)(displayX[count]) * 16, (uint32_t)((displayY[count])) * 16)); 
-    Send_CMD(END());
-    Send_CMD(COLOR_RGB(255, 255, 255));
-    Cmd_Text((Width / 2) + H_Offset, (Height / 3) + V_Offset, 27, OPT_CENTER, "Calibrating");
-    Cmd_Text((Width / 2) + H_Offset, (Height / 2) + V_Offset, 27, OPT_CENTER, "Please tap the dots");
-    num[0] = count + 0x31; num[1] = 0;                                            // null terminated string of one character
-    Cmd_Text(displayX[count], displayY[count], 27, OPT_CENTER, num);
-
-    Send_CMD(DISPLAY());
-    Send_CMD(CMD_SWAP);
-    UpdateFIFO();                                                                 // Trigger the CoProcessor to start processing commands out of the FIFO
-    Wait4CoProFIFOEmpty();                                                        // wait here until the coprocessor has read and executed every pending command.
-    MyDelay(300);
-
-    touchValue = rd32(REG_TOUCH_DIRECT_XY + RAM_REG);                             // Read for any new touch tag inputs
-    if (!(touchValue & 0x80000000))
-    {
-      touchX[count] = (touchValue>>16) & 0x03FF;                                  // Raw Touchscreen Y coordinate
-      touchY[count] = touchValue & 0x03FF;                                        // Raw Touchscreen Y coordinate
-      
-      //Log("\ndisplay x[%d]: %ld display y[%d]: %ld\n", count, displayX[count], count, displayY[count]);
-      //Log("touch x[%d]: %ld touch y[%d]: %ld\n", count, touchX[count], count, touchY[count]);
-      
-      count++;
-    }
-  }
-
-  k = ((touchX[0] - touchX[2]) * (touchY[1] - touchY[2])) - ((touchX[1] - touchX[2]) * (touchY[0] - touchY[2])); 
-  
-  tmp = (((displayX[0] - displayX[2]) * (touchY[1] - touchY[2])) - ((displayX[1] - displayX[2])*(touchY[0] - touchY[2])));
-  TransMatrix[0] = CalcCoef(tmp, k);
-
-  tmp = (((touchX[0] - touchX[2]) * (displayX[1] - displayX[2])) - ((displayX[0] - displayX[2])*(touchX[1] - touchX[2])));  
-  TransMatrix[1] = CalcCoef(tmp, k);
-  
-  tmp = ((touchY[0] * (((touchX[2] * displayX[1]) - (touchX[1] * displayX[2])))) + (touchY[1] * (((touchX[0] * displayX[2]) - (touchX[2] * displayX[0])))) + (touchY[2] * (((touchX[1] * displayX[0]) - (touchX[0] * displayX[1])))));    
-  TransMatrix[2] = CalcCoef(tmp, k);
-    
-  tmp = (((displayY[0] - displayY[2]) * (touchY[1] - touchY[2])) - ((displayY[1] - displayY[2])*(touchY[0] - touchY[2])));  
-  TransMatrix[3] = CalcCoef(tmp, k);
-    
-  tmp = (((touchX[0] - touchX[2]) * (displayY[1] - displayY[2])) - ((displayY[0] - displayY[2])*(touchX[1] - touchX[2])));  
-  TransMatrix[4] = CalcCoef(tmp, k);
-    
-  tmp = ((touchY[0] * (((touchX[2] * displayY[1]) - (touchX[1] * displayY[2])))) + (touchY[1] * (((touchX[0] * displayY[2]) - (touchX[2] * displayY[0])))) + (touchY[2] * (((touchX[1] * displayY[0]) - (touchX[0] * displayY[1])))));  
-  TransMatrix[5] = CalcCoef(tmp, k);
-  
-  count = 0;
-  do
-  {
-    wr32(REG_TOUCH_TRANSFORM_A + RAM_REG + (count * 4), TransMatrix[count]);  // Write to Eve config registers
-
-//    uint16_t ValH = TransMatrix[count] >> 16;
-//    uint16_t ValL = TransMatrix[count] & 0xFFFF;
-//    Log("TM%d: 0x%04x %04x\n", count, ValH, ValL);
-    
-    count++;
-  }while(count < 6);
-}
-
 // The following propositional functions are not terribly useful.  I note it here in case you are looking for them.
 // Find Inflate used in Load_ZLIB() and Loadimage used in Load_JPG() (process.c)
 // void Cmd_Loadimage( uint32_t addr, uint32_t options )
@@ -601,13 +1003,36 @@ void Calibrate_Manual(uint16_t Width, uint16_t Height, uint16_t V_Offset, uint16
 // *** Utility and helper functions ******************************************************************************
 // ***************************************************************************************************************
 
+// Read the read and write offsets of the FIFO.  REG_CMD_WRITE is only written by us, so with the shadow just
+// REG_CMD_READ is read.  Otherwise both come in one frame: REG_CMD_WRITE is the register after REG_CMD_READ.  The
+// registers are 32 bits with the offset in the low 12.
+static void CoProFIFO_Offsets(uint16_t *Rd, uint16_t *Wr)
+{
+  uint32_t Read, Write;
+  EveRegOp Ops[2] = { EVE_RD32(REG_CMD_READ + RAM_REG, &Read), EVE_RD32(REG_CMD_WRITE + RAM_REG, &Write) };
+
+#ifdef EVE_ASYNC
+  SPI_AsyncWait();                                                 // A staged frame publishes REG_CMD_WRITE at its end
+#endif
+#ifdef EVE_SHADOW
+  if (Shadow_Read(REG_CMD_WRITE + RAM_REG, 2, &Write))
+  {
+    *Rd = rd16(REG_CMD_READ + RAM_REG);
+    *Wr = Write;
+    return;
+  }
+#endif
+  Eve_RunBatch(Ops, 2);
+  *Rd = Read;
+  *Wr = Write;
+}
+
 // Find the space available in the GPU AKA CoProcessor AKA command buffer AKA FIFO
 uint16_t CoProFIFO_FreeSpace(void)
 {
   uint16_t cmdBufferDiff, cmdBufferRd, cmdBufferWr, retval;
   
-  cmdBufferRd = rd16(REG_CMD_READ + RAM_REG);
-  cmdBufferWr = rd16(REG_CMD_WRITE + RAM_REG);
+  CoProFIFO_Offsets(&cmdBufferRd, &cmdBufferWr);
     
   cmdBufferDiff = (cmdBufferWr-cmdBufferRd) % FT_CMD_FIFO_SIZE; // FT81x Programmers Guide 5.1.1
   retval = (FT_CMD_FIFO_SIZE - 4) - cmdBufferDiff;
@@ -627,13 +1052,19 @@ void Wait4CoProFIFO(uint32_t room)
 // Sit and wait until the CoPro FIFO is empty
 void Wait4CoProFIFOEmpty(void)
 {
-  while( rd16(REG_CMD_READ + RAM_REG) != rd16(REG_CMD_WRITE + RAM_REG) );
+  uint16_t cmdBufferRd, cmdBufferWr;
+
+  do {
+    CoProFIFO_Offsets(&cmdBufferRd, &cmdBufferWr);
+  }while (cmdBufferRd != cmdBufferWr);
 }
 
 // Every CoPro transaction starts with enabling the SPI and sending an address
 void StartCoProTransfer(uint32_t address, uint8_t reading)
 {
   SPI_Enable();
+  EVE_STAT(Frames, 1);
+  EVE_STAT(Bytes, reading ? 4 : 3);
   if (reading){
     SPI_Write(address >> 16);
     SPI_Write(address >> 8);
@@ -646,50 +1077,94 @@ void StartCoProTransfer(uint32_t address, uint8_t reading)
   }
 }
 
+// Bytes free in the FIFO after FifoWriteLocation, which may be ahead of what REG_CMD_WRITE says.  The coprocessor
+// only ever moves REG_CMD_READ on, so the answer stays good, if pessimistic, for as long as nothing else is written.
+static uint16_t CoProFIFO_Room(void)
+{
+  uint16_t cmdBufferRd = rd16(REG_CMD_READ + RAM_REG) & (FT_CMD_FIFO_SIZE - 1);
+
+  return ((FT_CMD_FIFO_SIZE - 4) - ((EveDev->WriteLocation - cmdBufferRd) & (FT_CMD_FIFO_SIZE - 1)));
+}
+
 // *** CoProWrCmdBuf() - Transfer a buffer into the CoPro FIFO as part of an ongoing command operation ***********
+// Here is the situation:  You have up to about a megabyte of data to transfer into the FIFO - the data of an
+// inflate or jpeg decode or the like, which the coprocessor reads from the FIFO and writes into RAM_G.  Since the
+// FIFO is 4K in size you can not, obviously, send it all in one step, and since Eve is not capable of updating
+// its own FIFO pointer as data is written you need to intermittently tell Eve to go process some FIFO in order to
+// make room for more.
+//
+// So the buffer, of any size, goes out in the largest pieces there is room for - as one frame up to the end of
+// the FIFO and another from its start - and REG_CMD_WRITE is written every EVE_PUBLISH_BYTES, whenever there is
+// no room left, and at the end.  The room is only read again when what was last read is used up, which carries
+// over to the next call unless Send_CMD(), Send_CMD_Run() or Eve_Reset() have cleared it since.  Being back at the
+// same FIFO offset does not show that on its own: other writes may have gone exactly once round.  The data is
+// padded with zeros to a whole number of words.
 void CoProWrCmdBuf(const uint8_t *buff, uint32_t count)
 {
-  uint32_t TransferSize = 0;
-  int32_t Remaining = count; // signed
-
-  do {                
-    // Here is the situation:  You have up to about a megabyte of data to transfer into the FIFO
-    // Your buffer is LogBuf - limited to 64 bytes (or some other value, but always limited).
-    // You need to go around in loops taking 64 bytes at a time until all the data is gone.
-    //
-    // Most interactions with the FIFO are started and finished in one operation in an obvious fashion, but 
-    // here it is important to understand the difference between Eve RAM registers and Eve FIFO.  Even though 
-    // you are in the middle of a FIFO operation and filling the FIFO is an ongoing task, you are still free 
-    // to write and read non-FIFO registers on the Eve chip.
-    //
-    // Since the FIFO is 4K in size, but the RAM_G space is 1M in size, you can not, obviously, send all
-    // the possible RAM_G data through the FIFO in one step.  Also, since the Eve is not capable of updating
-    // it's own FIFO pointer as data is written, you will need to intermittently tell Eve to go process some
-    // FIFO in order to make room in the FIFO for more RAM_G data.  That data might be part of an inflate
-    // operation or jpeg decode or the like.  You write to the FIFO and it inflates into RAM_G.
-    
-    Wait4CoProFIFO(WorkBuffSz);                           // It is reasonable to wait for a small space instead of firing data piecemeal
+  uint32_t Left = (count + 3) & ~3UL;                      // Whole words, the last padded with zeros
+  uint32_t Len, Data;
+  uint16_t Room, Unpublished = 0, Want;
+#ifdef EVE_ASYNC
+  static const uint8_t Zeros[3] = { 0, 0, 0 };
+#else
+  uint32_t i;
+#endif
+
+#ifdef EVE_SHADOW
+  EveDev->ShadowColors = 0;                                // Whatever this is, it may set colours
+#endif
+  Room = (EveDev->WriteLocation == EveDev->RoomAt) ? EveDev->RoomLeft : 0;
+  while (Left)
+  {
+    Want = EVE_PUBLISH_BYTES - Unpublished;                // Enough to reach the next pointer write
+    if (Want > Left)
+      Want = Left;
+    if (Room < Want)                                       // Wait for the coprocessor to make some room, which it
+    {                                                      // can only do with what it has been told of - commands
+      UpdateFIFO();                                        // ahead of this data too
+      Unpublished = 0;
+      Room = CoProFIFO_Room();
+      continue;
+    }
 
-    if (Remaining > WorkBuffSz)                            // Remaining data exceeds the size of our buffer
-      TransferSize = WorkBuffSz;                           // So set the transfer size to that of our buffer
-    else
+    Len = EVE_PUBLISH_BYTES - Unpublished;
+    if (Len > Room)
+      Len = Room;
+    if (Len > Left)
+      Len = Left;
+    Data = (count > Len) ? Len : count;                    // The rest of Len is padding
+
+#ifdef EVE_ASYNC
+    Stage_Write(buff, Data, false);                        // Copied into the free half while the last piece goes out
+    Stage_Write(Zeros, Len - Data, false);
+#else
+    if (Len > (uint32_t)(FT_CMD_FIFO_SIZE - EveDev->WriteLocation))
     {
-      TransferSize = Remaining;                            // Set size to this last dribble of data
-      TransferSize = (TransferSize + 3) & 0xFFC;           // 4 byte alignment
+      Len = FT_CMD_FIFO_SIZE - EveDev->WriteLocation;      // Stop where the FIFO wraps, the rest goes round next time
+      Data = (count > Len) ? Len : count;
     }
-    
-    StartCoProTransfer(FifoWriteLocation + RAM_CMD, false);// Base address of the Command Buffer plus our offset into it - Start SPI transaction
-    
-    SPI_WriteBuffer((uint8_t*)buff, TransferSize);         // write the little bit for which we found space
-    buff += TransferSize;                                  // move the working data read pointer to the next fresh data
-
-    FifoWriteLocation  = (FifoWriteLocation + TransferSize) % FT_CMD_FIFO_SIZE;  
-    SPI_Disable();                                         // End SPI transaction with the FIFO
-    
-    wr16(REG_CMD_WRITE + RAM_REG, FifoWriteLocation);      // Manually update the write position pointer to initiate processing of the FIFO
-    Remaining -= TransferSize;                             // reduce what we want by what we sent
-    
-  }while (Remaining > 0);                                  // keep going as long as we still want more
+    StartCoProTransfer(EveDev->WriteLocation + RAM_CMD, false);
+    for (i = 0; i < Len; i++)
+      SPI_Write((i < Data) ? buff[i] : 0);
+    SPI_Disable();
+    EVE_STAT(Bytes, Len);
+    EveDev->WriteLocation = (EveDev->WriteLocation + Len) % FT_CMD_FIFO_SIZE;
+#endif
+    buff += Data;
+    count -= Data;
+    Left -= Len;
+    Room -= Len;
+    Unpublished += Len;
+    if (Unpublished >= EVE_PUBLISH_BYTES)
+    {
+      UpdateFIFO();
+      Unpublished = 0;
+    }
+  }
+  if (Unpublished)
+    UpdateFIFO();
+  EveDev->RoomAt = EveDev->WriteLocation;
+  EveDev->RoomLeft = Room;
 }
 
 // Write a block of data into Eve RAM space a byte at a time.
@@ -705,33 +1180,3 @@ uint32_t WriteBlockRAM(uint32_t Add, const uint8_t *buff, uint32_t count)
   }
   return (WriteAddress);
 }
-
-int32_t CalcCoef(int32_t Q, int32_t K)
-{
-  int8_t sn = 0;
-
-  if (Q < 0)                                       // We need to work with positive values
-  {
-    Q *= -1;                                       // So here we make them positive
-    sn++;                                          // and remember that fact
-  }
-
-  if (K < 0)                                       
-  {
-    K *= -1;
-    sn++;                                          // 1 + 1 = 2 = 0b00000010
-  }  
-
-  
-  uint32_t I = ((uint32_t)Q / (uint32_t)K) << 16;  // get the integer part and shift it by 16
-  uint32_t R = Q % K;                              // get the remainder of a/k;
-  R = R << 14;                                     // shift by 14 
-  R = R / K;                                       // divide
-  R = R << 2;                                      // Make up for the missing bits  
-  int32_t returnValue = I + R;                     // combine them
-
-  if (sn & 0x01)                                   // If the result is supposed to be negative
-    returnValue *= -1;                             // then return it to that state.
-      
-  return (returnValue);
-}
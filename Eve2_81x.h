@@ -14,6 +14,8 @@
 // Pin control
 // void SetPin(uint8_t, Boolean);
 // void Eve_Reset_HW(void);
+// Chip select (SPI_Enable() and SPI_Disable()) and Eve_Reset_HW() are for the selected display, EveDev->CSPin
+// and EveDev->PDNPin.
 //
 // SPI functions
 // void SPI_Enable(void);
@@ -22,6 +24,8 @@
 // void SPI_WriteByte(uint8_t data);
 // void SPI_WriteBuffer(uint8_t *Buffer, uint32_t Length);
 // void SPI_ReadBuffer(uint8_t *Buffer, uint32_t Length);
+// void SPI_WriteAsync(const uint8_t *Buffer, uint32_t Length, void (*Done)(void));  (EVE_ASYNC only)
+// void SPI_AsyncWait(void);                                                         (EVE_ASYNC only)
 //
 // #define WorkBuffSz 64 
 //
@@ -304,15 +308,147 @@ extern "C" {
 #define POINT_SIZE(sighs) ((13UL<<24)|(((sighs)&8191UL)<<0))                                                                                                             // POINT_SIZE - FT-PG Section 4.36
 #define BEGIN(PrimitiveTypeRef) ((31UL<<24)|(((PrimitiveTypeRef)&15UL)<<0))                                                                                              // BEGIN - FT-PG Section 4.05
 #define END() ((33UL<<24))                                                                                                                                               // END - FT-PG Section 4.30
+#define NOP() ((45UL<<24))                                                                                                                                               // NOP - FT-PG Section 4.34
 #define DISPLAY() ((0UL<<24))                                                                                                                                            // DISPLAY - FT-PG Section 4.29
 
 // Non FTDI Helper Macros
 #define MAKE_COLOR(r,g,b) (( r << 16) | ( g << 8) | (b))
 
-// Global Variables
-extern uint16_t FifoWriteLocation;
+// #define EVE_STATS                  // Uncomment to count the SPI traffic to the Eve in EveStats (see Eve_LogStats())
+#define EVE_SHADOW                    // Comment out to send every register write and read every register (see Eve2_81x.c)
+
+// Commands for the FIFO are staged in RAM and sent with SPI_WriteAsync() (DMA where the board has it) while the
+// next are made.  It takes 2 * EVE_STAGE_SIZE bytes of RAM and a little endian processor, so not on the AVR.
+#if !defined(__AVR__) && !defined(EVE_SYNC)
+#define EVE_ASYNC
+#define EVE_STAGE_SIZE     512        // Bytes in each half of the staging buffer
+#endif
+
+// CoProWrCmdBuf() writes REG_CMD_WRITE, letting the coprocessor at what it has been given so far, after every
+// EVE_PUBLISH_BYTES of data and waits for that much room when the FIFO is full.  Smaller starts the coprocessor
+// sooner, larger spends less of the SPI bus on pointers and frames.  Anything up to 4092.
+#ifndef EVE_PUBLISH_BYTES
+#define EVE_PUBLISH_BYTES 1024
+#endif
+
+// One register read or write of a batch run by Eve_RunBatch().  Size is 1, 2 or 4 bytes.  A read leaves its value
+// in *Result (a uint8_t, uint16_t or uint32_t to match Size), or nowhere if Result is 0.
+typedef struct {
+  uint32_t Address;
+  uint32_t Value;                     // What to write
+  void    *Result;                    // Where a read goes
+  uint8_t  Size;
+  uint8_t  Write;
+} EveRegOp;
+
+#define EVE_RD8(Add, Res)    { (Add), 0, (Res), 1, false }
+#define EVE_RD16(Add, Res)   { (Add), 0, (Res), 2, false }
+#define EVE_RD32(Add, Res)   { (Add), 0, (Res), 4, false }
+#define EVE_WR8(Add, Val)    { (Add), (Val), 0, 1, true }
+#define EVE_WR16(Add, Val)   { (Add), (Val), 0, 2, true }
+#define EVE_WR32(Add, Val)   { (Add), (Val), 0, 4, true }
+
+#define EVE_BATCH_RUN       24        // Most bytes a run of neighbouring operations may share in one frame
+
+// One sample of the touch engine, see Eve_ReadTouch()
+typedef struct {
+  uint32_t RawXY;                     // 0xFFFFFFFF with nobody touching
+  uint32_t RZ;                        // Touch resistance, 32767 with nobody touching
+  uint32_t ScreenXY;                  // 0x80008000 with nobody touching
+  uint32_t TagXY;                     // Where the tag was looked up
+  uint32_t Tracker;                   // Tag in the low byte, value in the high 16 bits - only read when asked for
+  uint8_t  Tag;                       // 0 with nobody touching or nothing tagged under the finger
+} EveTouch;
+
+#ifdef EVE_STATS
+typedef struct {
+  uint32_t Frames;                    // Chip select frames
+  uint32_t Bytes;                     // Bytes clocked, address and dummy bytes included
+  uint32_t Batches;                   // Calls of Eve_RunBatch()
+  uint32_t BatchOps;                  // Operations they ran
+  uint32_t BatchFrames;               // Frames they took - fewer than BatchOps where neighbours shared a frame
+  uint32_t BatchSaved;                // Address and dummy bytes not sent thanks to that
+  uint8_t  BatchMax;                  // Largest batch
+  uint32_t Suppressed;                // Writes left out by the shadow - the value was there already
+  uint32_t Cached;                    // Reads answered by the shadow
+} EveStatsType;
+
+extern EveStatsType EveStats;
+#define EVE_STAT(Field, n)  (EveStats.Field += (n))
+#else
+#define EVE_STAT(Field, n)
+#endif
+
+// Several displays may share the SPI bus, each with its own chip select and PDN line (EVE_DEVICE_PINS in the
+// hardware abstraction layer).  Everything the library keeps about a display is in its EveDevice, and every function
+// works on the one selected by Eve_Select(), so the screens are drawn with the same calls whichever display they are
+// for.  With a single display the selected device is a constant address and costs nothing over plain globals.
+#ifndef EVE_DEVICES
+#define EVE_DEVICES         1         // Displays on the bus
+#endif
+
+// Timings of a panel, loaded by FT81x_Init().  EvePanelConf is the one MatrixEve2Conf.h selects - in flash.
+typedef struct {
+  uint16_t HCycle, HOffset, HSync0, HSync1;
+  uint16_t VCycle, VOffset, VSync0, VSync1;
+  uint16_t HSize, VSize;
+  uint8_t  PClk, Swizzle, PClkPol, CSpread, Dither;
+} EvePanel;
+
+#define EVE_SHADOW_REGS     7         // Registers the shadow knows (see Eve2_81x.c)
+
+typedef struct {
+  uint8_t  CSPin, PDNPin;             // For the hardware abstraction layer
+  const EvePanel *Panel;              // In flash, 0 for EvePanelConf
+  uint16_t WriteLocation;             // FIFO offset the next command goes to
+  uint32_t *CaptureBuf;               // While set, commands are stored here instead of being sent (CoProCaptureStart())
+  uint16_t CaptureCount, CaptureMax;
+  uint16_t RoomAt, RoomLeft;          // The room CoProWrCmdBuf() left in the FIFO after RoomAt, 0 once others write
+#ifdef EVE_ASYNC
+  uint8_t  StageBuf[2][EVE_STAGE_SIZE];  // Command staging (see Stage_Flush())
+  uint8_t  Stage;                     // The half being filled
+  uint16_t StageLen;                  // Bytes in it
+  uint16_t StageStart;                // FIFO offset of its first byte
+  const uint8_t *Wrapped;             // In flight - what goes to the start of the FIFO
+  uint16_t WrappedLen;                // once the end of it is full
+  uint8_t  Publish;                   // In flight - write REG_CMD_WRITE when it is all out
+  uint16_t PublishAt;
+#endif
+#ifdef EVE_SHADOW
+  uint32_t ShadowVal[EVE_SHADOW_REGS];
+  uint8_t  ShadowSize[EVE_SHADOW_REGS];  // Size of the write which left the value, 0 while unknown
+  uint32_t ShadowFG, ShadowBG;
+  uint8_t  ShadowColors;              // SHADOW_FG, SHADOW_BG when those are known
+  uint8_t  ShadowID;
+#endif
+} EveDevice;
+
+// A display on CS and PDN, for EVE_DEVICE_PINS.  The rest starts zeroed.
+#ifdef EVE_ASYNC
+#define EVE_DEVICE_ASYNC    , { { 0 } }, 0, 0, 0, 0, 0, 0, 0
+#else
+#define EVE_DEVICE_ASYNC
+#endif
+#ifdef EVE_SHADOW
+#define EVE_DEVICE_SHADOW   , { 0 }, { 0 }, 0, 0, 0, 0
+#else
+#define EVE_DEVICE_SHADOW
+#endif
+#define EVE_DEVICE(CS, PDN) { (CS), (PDN), 0, 0, 0, 0, 0, 0, 0 EVE_DEVICE_ASYNC EVE_DEVICE_SHADOW }
+
+extern EveDevice EveDevices[EVE_DEVICES];
+extern const EvePanel EvePanelConf;
+#if EVE_DEVICES > 1
+extern EveDevice *EveDev;             // The selected display
+#else
+#define EveDev              (&EveDevices[0])
+#endif
+
+// Global Variables - the selected display's, for code written before there could be more than one
+#define FifoWriteLocation   (EveDev->WriteLocation)
 
 // Function Prototypes
+void Eve_Select(uint8_t Index);
 void FT81x_Init(void);
 void Eve_Reset(void);
 
@@ -323,7 +459,16 @@ void wr8(uint32_t, uint8_t parameter);
 uint8_t rd8(uint32_t RegAddr);
 uint16_t rd16(uint32_t RegAddr);
 uint32_t rd32(uint32_t RegAddr);
+void Eve_RunBatch(EveRegOp *Ops, uint8_t Count);
+void Eve_ReadTouch(EveTouch *Touch, uint8_t Tracker);
+void Eve_LogStats(void);
 void Send_CMD(uint32_t data);
+void Send_CMD_Str(const char *str);
+void Send_CMD_Str_P(const char *str);
+void Send_CMD_Blob(const uint32_t *Blob, uint16_t Words);
+void Send_CMD_Words(const uint32_t *Words, uint16_t Count);
+void CoProCaptureStart(uint32_t *Buffer, uint16_t Max);
+uint16_t CoProCaptureStop(void);
 void UpdateFIFO(void);
 uint8_t Cmd_READ_REG_ID(void);
 
@@ -337,6 +482,8 @@ void Cmd_Number(uint16_t x, uint16_t y, uint16_t font, uint16_t options, uint32_
 void Cmd_Gradient(uint16_t x0, uint16_t y0, uint32_t rgb0, uint16_t x1, uint16_t y1, uint32_t rgb1);
 void Cmd_Button(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t font, uint16_t options, const char* str);
 void Cmd_Text(uint16_t x, uint16_t y, uint16_t font, uint16_t options, const char* str);
+void Cmd_Button_P(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t font, uint16_t options, const char* str);
+void Cmd_Text_P(uint16_t x, uint16_t y, uint16_t font, uint16_t options, const char* str);
 
 void Cmd_SetBitmap(uint32_t addr, uint16_t fmt, uint16_t width, uint16_t height);
 void Cmd_Memcpy(uint32_t dest, uint32_t src, uint32_t num);
@@ -349,7 +496,6 @@ void Cmd_Rotate(uint32_t a);
 void Cmd_SetRotate(uint32_t rotation);
 void Cmd_Scale(uint32_t sx, uint32_t sy);
 void Cmd_Calibrate(uint32_t result);
-void Calibrate_Manual(uint16_t Width, uint16_t Height, uint16_t V_Offset, uint16_t H_Offset);
 
 uint16_t CoProFIFO_FreeSpace(void);
 void Wait4CoProFIFO(uint32_t room);
@@ -357,10 +503,16 @@ void Wait4CoProFIFOEmpty(void);
 void StartCoProTransfer(uint32_t address, uint8_t reading);
 void CoProWrCmdBuf(const uint8_t *buffer, uint32_t count);
 uint32_t WriteBlockRAM(uint32_t Add, const uint8_t *buff, uint32_t count);
-int32_t CalcCoef(int32_t Q, int32_t K);
+
+// Compile time command blobs - built in Eve2_81x_DL.cpp
+void Blob_FrameEnd(void);
+void Blob_CalHeader(void);
+void Blob_CalPointEnd(void);
+void Blob_CalTitle(void);
+void Blob_CalHint(void);
 
 #ifdef __cplusplus
 }
 #endif
 
-#endif
+#endif
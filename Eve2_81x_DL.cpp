@@ -0,0 +1,17 @@
+// Compile time command blobs used by the Eve2 library itself.  See Eve2_81x_DL.h for how these are made.
+
+#include <stdint.h>              // Find integer types like "uint8_t"
+#include "Eve2_81x.h"            // Header for the library with prototypes, defines, and typedefs
+#include "Eve2_81x_DL.h"         // Compile time display list templates
+
+using namespace EveDL;
+
+// End of every screen - finish the display list and swap it in
+EVE_BLOB(Blob_FrameEnd,    Cmd(DISPLAY()) + Cmd(CMD_SWAP))
+
+// Calibration screen - calibrate.c
+EVE_BLOB(Blob_CalHeader,   Cmd(CMD_DLSTART) + Cmd(CLEAR_COLOR_RGB(64, 64, 64)) + Cmd(CLEAR(1,1,1)) +
+                           Cmd(COLOR_RGB(255, 0, 0)) + Cmd(POINT_SIZE(20 * 16)) + Cmd(BEGIN(POINTS)))
+EVE_BLOB(Blob_CalPointEnd, Cmd(END()) + Cmd(COLOR_RGB(255, 255, 255)))
+EVE_BLOB(Blob_CalTitle,    Str("Calibrating"))
+EVE_BLOB(Blob_CalHint,     Str("Please tap the dots"))
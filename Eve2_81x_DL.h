@@ -0,0 +1,171 @@
+// Compile time display list blobs for the Eve2 library.
+//
+// Most of a screen never changes: the DL start and clear, the gradient, colours, tags and the first four words
+// of every widget.  Sending those through Send_CMD() means packing y<<16|x fields at run time and paying for a
+// full SPI transaction per word - every frame, forever.  The templates here encode such command sequences once,
+// at compile time, into constant arrays which live in flash (PROGMEM).  Send_CMD_Blob() then streams an entire
+// run of them into the FIFO in one go.
+//
+// Build a blob by adding pieces together, then give it a name with EVE_BLOB() in a C++ file:
+//
+//   EVE_BLOB(Blob_Example, EveDL::Cmd(CMD_DLSTART) + EveDL::Cmd(CLEAR(1,1,1)) + EveDL::Text(10, 10, 27, 0, "Hi"))
+//
+// This produces a C callable "void Blob_Example(void)" which sends the words.  Prototype it in a C header.
+// String operands are padded to a whole number of words right here, exactly as Send_CMD_Str() would do it.
+// Pieces ending in "Head" stop before the last (variable) word(s) so that the value can follow from C code.
+//
+// This header is C++ only and sticks to C++11 since that is what the Arduino AVR toolchain speaks.
+
+#ifndef __EVE81X_DL_H
+#define __EVE81X_DL_H
+
+#ifdef __cplusplus
+
+#include <stdint.h>              // Find integer types like "uint8_t"
+#include "Eve2_81x.h"            // Command and display list definitions
+#include "Arduino_AL.h"          // PROGMEM
+
+namespace EveDL {
+
+// A run of encoded command words
+template<uint16_t N> struct Blob
+{
+  uint32_t Word[N];
+};
+
+// Index sequences - C++11 does not have its own
+template<uint16_t... I> struct Seq {};
+template<uint16_t N, uint16_t... I> struct MakeSeq : MakeSeq<N - 1, N - 1, I...> {};
+template<uint16_t... I> struct MakeSeq<0, I...> { typedef Seq<I...> Type; };
+
+// Join two blobs end to end - "a + b"
+template<uint16_t A, uint16_t B>
+constexpr uint32_t Pick(const Blob<A> &a, const Blob<B> &b, uint16_t i)
+{
+  return (i < A) ? a.Word[i] : b.Word[i - A];
+}
+
+template<uint16_t A, uint16_t B, uint16_t... I>
+constexpr Blob<A + B> Join(const Blob<A> &a, const Blob<B> &b, Seq<I...>)
+{
+  return Blob<A + B>{{ Pick(a, b, I)... }};
+}
+
+template<uint16_t A, uint16_t B>
+constexpr Blob<A + B> operator+(const Blob<A> &a, const Blob<B> &b)
+{
+  return Join(a, b, typename MakeSeq<A + B>::Type());
+}
+
+// Two 16 bit values in one word, little endian - the y<<16|x of every widget
+constexpr uint32_t Pair(uint16_t lo, uint16_t hi)
+{
+  return ((uint32_t)hi << 16) | lo;
+}
+
+// Strings - 4 characters per word, zero padded, always including a terminator (so "abcd" takes 2 words)
+template<uint16_t N>
+constexpr uint32_t StrByte(const char (&s)[N], uint16_t i)
+{
+  return (i < N - 1) ? (uint32_t)(uint8_t)s[i] : 0;
+}
+
+template<uint16_t N>
+constexpr uint32_t StrWord(const char (&s)[N], uint16_t i)
+{
+  return StrByte(s, i) | (StrByte(s, i + 1) << 8) | (StrByte(s, i + 2) << 16) | (StrByte(s, i + 3) << 24);
+}
+
+template<uint16_t N, uint16_t... I>
+constexpr Blob<sizeof...(I)> StrWords(const char (&s)[N], Seq<I...>)
+{
+  return Blob<sizeof...(I)>{{ StrWord(s, I * 4)... }};
+}
+
+template<uint16_t N>
+constexpr Blob<(N - 1) / 4 + 1> Str(const char (&s)[N])
+{
+  return StrWords(s, typename MakeSeq<(N - 1) / 4 + 1>::Type());
+}
+
+// Any single word - display list commands such as COLOR_RGB() and TAG(), or bare coprocessor commands
+constexpr Blob<1> Cmd(uint32_t c)
+{
+  return Blob<1>{{ c }};
+}
+
+// Coprocessor commands - parameters are in the same order as the matching Cmd_xxx() functions in Eve2_81x.c
+constexpr Blob<2> FGcolor(uint32_t c)
+{
+  return Blob<2>{{ CMD_FGCOLOR, c }};
+}
+
+constexpr Blob<2> BGcolor(uint32_t c)
+{
+  return Blob<2>{{ CMD_BGCOLOR, c }};
+}
+
+constexpr Blob<5> Gradient(uint16_t x0, uint16_t y0, uint32_t rgb0, uint16_t x1, uint16_t y1, uint32_t rgb1)
+{
+  return Blob<5>{{ CMD_GRADIENT, Pair(x0, y0), rgb0, Pair(x1, y1), rgb1 }};
+}
+
+// Followed by Pair(val, range)
+constexpr Blob<4> GaugeHead(uint16_t x, uint16_t y, uint16_t r, uint16_t options, uint16_t major, uint16_t minor)
+{
+  return Blob<4>{{ CMD_GAUGE, Pair(x, y), Pair(r, options), Pair(major, minor) }};
+}
+
+constexpr Blob<5> Gauge(uint16_t x, uint16_t y, uint16_t r, uint16_t options, uint16_t major, uint16_t minor, uint16_t val, uint16_t range)
+{
+  return GaugeHead(x, y, r, options, major, minor) + Cmd(Pair(val, range));
+}
+
+// Followed by the value
+constexpr Blob<3> DialHead(uint16_t x, uint16_t y, uint16_t r, uint16_t options)
+{
+  return Blob<3>{{ CMD_DIAL, Pair(x, y), Pair(r, options) }};
+}
+
+constexpr Blob<4> Track(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t tag)
+{
+  return Blob<4>{{ CMD_TRACK, Pair(x, y), Pair(w, h), tag }};
+}
+
+// Followed by a string
+constexpr Blob<3> TextHead(uint16_t x, uint16_t y, uint16_t font, uint16_t options)
+{
+  return Blob<3>{{ CMD_TEXT, Pair(x, y), Pair(font, options) }};
+}
+
+template<uint16_t N>
+constexpr Blob<3 + (N - 1) / 4 + 1> Text(uint16_t x, uint16_t y, uint16_t font, uint16_t options, const char (&s)[N])
+{
+  return TextHead(x, y, font, options) + Str(s);
+}
+
+// Followed by a string
+constexpr Blob<4> ButtonHead(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t font, uint16_t options)
+{
+  return Blob<4>{{ CMD_BUTTON, Pair(x, y), Pair(w, h), Pair(font, options) }};
+}
+
+template<uint16_t N>
+constexpr Blob<4 + (N - 1) / 4 + 1> Button(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t font, uint16_t options, const char (&s)[N])
+{
+  return ButtonHead(x, y, w, h, font, options) + Str(s);
+}
+
+} // namespace EveDL
+
+// Place a blob in flash and make a C callable function to send it
+#define EVE_BLOB(Name, Expr)                                                  \
+  static constexpr auto Name##_Words PROGMEM = Expr;                          \
+  extern "C" void Name(void)                                                  \
+  {                                                                           \
+    Send_CMD_Blob(Name##_Words.Word, sizeof(Name##_Words.Word) / sizeof(uint32_t)); \
+  }
+
+#endif // __cplusplus
+
+#endif
@@ -0,0 +1,281 @@
+// Retained widgets on top of the Eve2 library.
+//
+// Building a screen by calling Cmd_Gauge() and friends every frame costs the same whether anything changed or not.
+// Here each widget is encoded by those same Cmd_xxx() functions, but with the command capture of Eve2_81x.c
+// switched on, so the words land in a cache instead of the FIFO.  Every frame the bound values are compared to
+// the values the cache was made with and only the widgets which differ are encoded again.  The whole cache then
+// goes to the FIFO in a single burst with Send_CMD_Words().
+//
+// Every widget has a fixed number of words reserved in the cache.  Text which is shorter than the reservation is
+// followed by NOP() words, so one widget changing size never moves the others.
+//
+// Gauges are drawn at Shown rather than at their bound value.  Widgets_Animate() eases Shown towards the value, an
+// eighth of what is left each frame in 24.8 fixed point, so a new sensor reading swings the needle over in about
+// half a second at 30 frames a second instead of jumping.  Only the value changes while the needle moves, and it
+// is the last word of CMD_GAUGE, so that word is patched in place rather than the widget being encoded again.
+// Widgets_Animate() also tells whether anything at all changed, so a screen which is standing still need not be
+// sent again.
+
+#include <stdint.h>              // Find integer types like "uint8_t"
+#include <stdio.h>               // sprintf() for Log()
+#include "Eve2_81x.h"            // Matrix Orbital Eve2 Driver
+#include "Arduino_AL.h"          // Log()
+#include "Eve2_Widgets.h"        // Header for this file
+
+uint32_t WidgetCache[WIDGET_CACHE_WORDS];  // Encoded command words of the current widget list
+uint8_t  WidgetCacheUsed = 0;              // Number of words in use
+uint16_t WidgetEncodes = 0;
+uint16_t WidgetPatches = 0;
+
+// Value which the widget's words depend on.  Text is compared with the words, or for text in flash by its address.
+static uint16_t Widget_Key(const Widget *w)
+{
+  if (!w->Bind || (w->Type == WIDGET_TEXT) || (w->Type == WIDGET_BUTTON) ||
+      (w->Type == WIDGET_TEXT_P) || (w->Type == WIDGET_BUTTON_P))
+    return 0;
+  if (w->Type == WIDGET_GAUGE)
+    return (w->Shown + 128) >> 8;                                    // Where the needle is, not where it is going
+  return *(const uint16_t *)w->Bind;
+}
+
+// True if str is not the text the widget's cached words hold, from word ValueAt on (packed as Send_CMD_Str() does).
+// A checksum would do with less work, but short numbers such as "20.0" and "21.4" have the same one.
+static bool Widget_TextDiffers(const Widget *w, const char *str)
+{
+  uint8_t At = w->ValueAt, Shift = 0;
+
+  do {
+    if (At >= w->Size)                                               // Cut short by an overflow - the rest is not
+      return false;                                                  // shown whatever it is
+    if ((char)(WidgetCache[w->Start + At] >> Shift) != *str)
+      return true;
+    Shift += 8;
+    if (Shift == 32)
+    {
+      Shift = 0;
+      At++;
+    }
+  }while (*str++);
+  return false;
+}
+
+// True if the widget must be made again (or, for a gauge, its needle patched)
+static bool Widget_Changed(const Widget *w)
+{
+  if (w->Dirty)
+    return true;
+  if (!w->Bind)
+    return false;
+  if ((w->Type == WIDGET_TEXT) || (w->Type == WIDGET_BUTTON))
+    return Widget_TextDiffers(w, (const char *)w->Bind);
+  if ((w->Type == WIDGET_TEXT_P) || (w->Type == WIDGET_BUTTON_P))
+    return (*(const char * const *)w->Bind != w->ShownText);         // Flash strings do not change where they are
+  return (Widget_Key(w) != w->Last);
+}
+
+// Number of words a widget can need at the most
+static uint8_t Widget_Size(const Widget *w)
+{
+  uint8_t Size = 0;
+
+  if (w->Type == WIDGET_GRADIENT)
+    return 5;
+
+  if (w->Fill != WIDGET_NOFILL) Size += 2;                           // Cmd_FGcolor() or Cmd_BGcolor()
+  if (w->Color)                 Size += 1;                           // COLOR_RGB()
+  if (w->Tag)                   Size += (w->Type == WIDGET_DIAL) ? 5 : 1; // TAG() and maybe Cmd_Track()
+
+  switch (w->Type)
+  {
+  case WIDGET_GAUGE:  Size += 5; break;
+  case WIDGET_DIAL:   Size += 4; break;
+  case WIDGET_TEXT:
+  case WIDGET_TEXT_P:   Size += 3 + (w->Range / 4) + 1; break;
+  case WIDGET_BUTTON:
+  case WIDGET_BUTTON_P: Size += 4 + (w->Range / 4) + 1; break;
+  default:;
+  }
+  return (Size);
+}
+
+// Make the cached words for one widget
+static void Widget_Encode(Widget *w)
+{
+  uint16_t Count;
+  uint16_t Val = 0;
+
+  w->Last = Widget_Key(w);
+  w->Dirty = false;
+  WidgetEncodes++;
+
+  if ((w->Type == WIDGET_GAUGE) || (w->Type == WIDGET_DIAL))
+    Val = (w->Last + w->Offset) * w->Scale;
+  else if (w->Bind && ((w->Type == WIDGET_TEXT_P) || (w->Type == WIDGET_BUTTON_P)))
+    w->ShownText = *(const char * const *)w->Bind;
+
+  CoProCaptureStart(&WidgetCache[w->Start], w->Size);
+
+  if (w->Type == WIDGET_GRADIENT)
+    Cmd_Gradient(w->X, w->Y, w->Color, w->W, w->H, w->Fill);
+  else
+  {
+    if (w->Fill != WIDGET_NOFILL)
+    {
+      if (w->Type == WIDGET_GAUGE)
+        Cmd_BGcolor(w->Fill);
+      else
+        Cmd_FGcolor(w->Fill);
+    }
+    if (w->Color)
+      Send_CMD(w->Color);
+    if (w->Tag)
+    {
+      if (w->Type == WIDGET_DIAL)
+        Cmd_Track(w->X, w->Y, 1, 1, w->Tag);                         // Rotary tracker for the dial
+      Send_CMD(TAG(w->Tag));
+    }
+
+    switch (w->Type)
+    {
+    case WIDGET_GAUGE:
+      Cmd_Gauge(w->X, w->Y, w->W, w->Options, w->Font & 0xFF, w->Font >> 8, Val, w->Range);
+      break;
+    case WIDGET_DIAL:
+      Cmd_Dial(w->X, w->Y, w->W, w->Options, Val);
+      break;
+    case WIDGET_TEXT:
+      Cmd_Text(w->X, w->Y, w->Font, w->Options, (const char *)w->Bind);
+      break;
+    case WIDGET_BUTTON:
+      Cmd_Button(w->X, w->Y, w->W, w->H, w->Font, w->Options, (const char *)w->Bind);
+      break;
+    case WIDGET_TEXT_P:
+      Cmd_Text_P(w->X, w->Y, w->Font, w->Options, *(const char * const *)w->Bind);
+      break;
+    case WIDGET_BUTTON_P:
+      Cmd_Button_P(w->X, w->Y, w->W, w->H, w->Font, w->Options, *(const char * const *)w->Bind);
+      break;
+    default:;
+    }
+  }
+
+  Count = CoProCaptureStop();
+  if (Count > w->Size)
+  {
+    Log("Widget overflow %d\n", Count);                              // Text longer than its Range - the tail is lost
+    Count = w->Size;
+  }
+  if (w->Type == WIDGET_GAUGE)
+    w->ValueAt = Count - 1;                                          // CMD_GAUGE comes last and ends with the value
+  else if ((w->Type == WIDGET_TEXT) || (w->Type == WIDGET_BUTTON))  // The text follows the colours, the tag and
+    w->ValueAt = ((w->Fill != WIDGET_NOFILL) ? 2 : 0) + (w->Color ? 1 : 0) + (w->Tag ? 1 : 0) +   // CMD_TEXT or
+                 ((w->Type == WIDGET_TEXT) ? 3 : 4);                                               // CMD_BUTTON
+  else
+    w->ValueAt = 0;
+  while (Count < w->Size)
+    WidgetCache[w->Start + Count++] = NOP();                         // Fill out the reservation
+}
+
+// A gauge whose needle has moved only needs the value word of its CMD_GAUGE made again
+static void Widget_Patch(Widget *w, uint16_t Key)
+{
+  w->Last = Key;
+  WidgetCache[w->Start + w->ValueAt] = ((uint32_t)w->Range << 16) | (uint16_t)((Key + w->Offset) * w->Scale);
+  WidgetPatches++;
+}
+
+// Lay out a list of widgets in the cache.  All of them will be encoded on the next Widgets_Send().
+// Returns false if the cache is too small for the list.
+bool Widgets_Init(Widget *List, uint8_t Count)
+{
+  uint8_t i;
+  uint16_t Used = 0;
+
+  for (i = 0; i < Count; i++)
+  {
+    List[i].Start = Used;
+    List[i].Size = Widget_Size(&List[i]);
+    List[i].Dirty = true;
+    List[i].ValueAt = 0;
+    if ((List[i].Type == WIDGET_GAUGE) && List[i].Bind)
+      List[i].Shown = (uint32_t)*(const uint16_t *)List[i].Bind << 8;  // Needles start out at their values
+    Used += List[i].Size;
+  }
+
+  if (Used > WIDGET_CACHE_WORDS)
+  {
+    Log("Widget cache needs %d\n", Used);
+    WidgetCacheUsed = 0;
+    return false;
+  }
+  WidgetCacheUsed = Used;
+  return true;
+}
+
+// Move each needle a step towards its bound value - quickly at first, slowing as it gets there.  Call once a frame.
+// Returns true if the next Widgets_Send() will send anything different from the last one.
+bool Widgets_Animate(Widget *List, uint8_t Count)
+{
+  Widget *w;
+  int32_t Step;
+  bool Changed = false;
+  uint8_t i;
+
+  for (i = 0; i < Count; i++)
+  {
+    w = &List[i];
+    if ((w->Type == WIDGET_GAUGE) && w->Bind)
+    {
+      Step = (int32_t)(((uint32_t)*(const uint16_t *)w->Bind << 8) - w->Shown) / (1 << WIDGET_EASE_SHIFT);
+      if (Step)
+        w->Shown += Step;
+      else
+        w->Shown = (uint32_t)*(const uint16_t *)w->Bind << 8;        // The last fraction of a step is made at once
+    }
+    if (Widget_Changed(w))
+      Changed = true;
+  }
+  return Changed;
+}
+
+// Re-encode whatever changed and send the whole list to the FIFO
+void Widgets_Send(Widget *List, uint8_t Count)
+{
+  Widget *w;
+  uint16_t Key;
+  uint8_t i;
+
+  if (!WidgetCacheUsed)                                              // Widgets_Init() failed
+    return;
+
+  for (i = 0; i < Count; i++)
+  {
+    w = &List[i];
+    if (!Widget_Changed(w))
+      continue;
+    Key = Widget_Key(w);
+    if (!w->Dirty && (w->Type == WIDGET_GAUGE) && w->ValueAt)
+      Widget_Patch(w, Key);                                          // Only the needle has moved
+    else
+      Widget_Encode(w);
+  }
+
+  Send_CMD_Words(WidgetCache, WidgetCacheUsed);
+}
+
+// Change the colours of a widget - it is only re-encoded if they are actually different
+void Widget_SetColor(Widget *w, uint32_t Color, uint32_t Fill)
+{
+  if ((w->Color != Color) || (w->Fill != Fill))
+  {
+    w->Color = Color;
+    w->Fill = Fill;
+    w->Dirty = true;
+  }
+}
+
+// Force a widget to be re-encoded on the next Widgets_Send()
+void Widget_Invalidate(Widget *w)
+{
+  w->Dirty = true;
+}
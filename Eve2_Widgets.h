@@ -0,0 +1,82 @@
+#ifndef __EVE2_WIDGETS_H
+#define __EVE2_WIDGETS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>              // Find integer types like "uint8_t"
+#include <stdbool.h>             // Find type "bool"
+
+// Retained widgets - each widget keeps its own encoded command words in a shared cache and is only re-encoded
+// when its bound value, bound text or colours change.  A frame is then just the cache sent in one burst.
+// Positions and styles are fixed once the widget list has been handed to Widgets_Init().  Colours may change
+// later through Widget_SetColor(), but whether a widget has a Color/Fill at all may not (its cache space is fixed).
+//
+// Gauge needles are animated: each Widgets_Animate() moves the needle a fraction of the way to the bound value,
+// and a needle which has moved only has the one word of its CMD_GAUGE holding the value patched in the cache.
+
+#define WIDGET_CACHE_WORDS        96  // Total command words cached for the current widget list (255 at most)
+#define WIDGET_EASE_SHIFT          3  // Needles move 1/8 of the way to their value at each Widgets_Animate()
+
+#define WIDGET_GAUGE               1
+#define WIDGET_DIAL                2
+#define WIDGET_BUTTON              3
+#define WIDGET_TEXT                4
+#define WIDGET_GRADIENT            5
+#define WIDGET_TEXT_P              6  // WIDGET_TEXT and WIDGET_BUTTON with the text in flash
+#define WIDGET_BUTTON_P            7
+
+#define WIDGET_NOFILL     0xFF000000  // Fill value meaning no FG/BG colour is set by this widget
+
+// Field usage which is not obvious from the name:
+//   W, H     - Radius in W for gauges and dials.  Second point for gradients.
+//   Font     - Ticks for gauges as (minor << 8) | major.
+//   Range    - Gauge range.  Maximum text length for text and buttons (cache space is reserved for it).
+//   Color    - COLOR_RGB() word sent before the widget, 0 for none.  First gradient colour (0xRRGGBB).
+//   Fill     - BG colour for gauges, FG colour for buttons and dials, WIDGET_NOFILL for none.  Second gradient colour.
+//   Tag      - TAG() sent before the widget, 0 leaves the current tag alone.  A tagged dial also gets a rotary tracker.
+//   Bind     - Pointer to a uint16_t value (gauges and dials) or a string (text and buttons).  For the _P types,
+//              pointer to a const char * which points to the string in flash (PROGMEM).
+//   Offset, Scale - The bound value is sent as (value + Offset) * Scale.
+typedef struct {
+  uint8_t  Type;
+  uint8_t  Tag;
+  uint16_t X, Y;
+  uint16_t W, H;
+  uint16_t Font;
+  uint16_t Options;
+  uint16_t Range;
+  int16_t  Offset;
+  uint16_t Scale;
+  uint32_t Color;
+  uint32_t Fill;
+  const void *Bind;
+  // The following are private to Eve2_Widgets.c
+  uint8_t  Start;                     // Offset of this widget's words in the cache
+  uint8_t  Size;                      // Number of words reserved in the cache
+  uint16_t Last;                      // Value the cached words were made with
+  bool     Dirty;                     // Cached words must be remade
+  uint8_t  ValueAt;                   // Gauges - offset of the word holding the value in its words, 0 for unknown.
+                                      // Text and buttons - of the first word of the text, which bound text is
+                                      // compared with.
+  union {
+    uint32_t Shown;                   // Gauges - value the needle is drawn at x256
+    const char *ShownText;            // _P types - string in flash the cached words were made with
+  };
+} Widget;
+
+extern uint16_t WidgetEncodes;        // Number of widget encodes done - for profiling
+extern uint16_t WidgetPatches;        // Number of needle values patched in without an encode
+
+bool Widgets_Init(Widget *List, uint8_t Count);
+bool Widgets_Animate(Widget *List, uint8_t Count);
+void Widgets_Send(Widget *List, uint8_t Count);
+void Widget_SetColor(Widget *w, uint32_t Color, uint32_t Fill);
+void Widget_Invalidate(Widget *w);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,87 @@
+// Compile time pins and SPI for the hardware abstraction layer.  This is C++ and only SolutionWarmer.ino uses it.
+//
+// The pin and the SPI settings are template parameters, so on the ATmega328P a pin write folds into a single
+// sbi/cbi on its port (2 cycles) and setting up the SPI unit into two register stores.  digitalWrite() finds the
+// port and bit through three tables in flash, checks the pin for a PWM timer and saves/restores SREG around the
+// write, which is about 60 cycles.  SPI.beginTransaction() builds SPCR/SPSR and checks the interrupt masking
+// for another 20 or so.  Other processors get the plain Arduino calls.
+//
+// WriteAsync() starts a write which AsyncDone() tells the end of.  On the RP2040 that is a DMA transfer; everywhere
+// else the write is done by the time WriteAsync() returns.
+
+#ifndef __FASTIO_H
+#define __FASTIO_H
+
+#include <SPI.h>
+
+#if defined(__AVR_ATmega328P__)
+
+// Uno pin numbering: 0-7 are PORTD, 8-13 PORTB and 14-19 (A0-A5) PORTC
+template <uint8_t Pin> struct FastPin
+{
+  static_assert(Pin < 20, "FastPin only knows the ATmega328P pins of the Uno");
+  static const uint8_t Mask = 1 << ((Pin < 8) ? Pin : ((Pin < 14) ? (Pin - 8) : (Pin - 14)));
+
+  static inline volatile uint8_t &Port(void) { return (Pin < 8) ? PORTD : ((Pin < 14) ? PORTB : PORTC); }
+  static inline volatile uint8_t &Ddr(void)  { return (Pin < 8) ? DDRD : ((Pin < 14) ? DDRB : DDRC); }
+  static inline volatile uint8_t &In(void)   { return (Pin < 8) ? PIND : ((Pin < 14) ? PINB : PINC); }
+
+  static inline void Output(void) { Ddr() |= Mask; }
+  static inline void High(void)   { Port() |= Mask; }
+  static inline void Low(void)    { Port() &= ~Mask; }
+  static inline void Set(bool State) { if (State) High(); else Low(); }
+  static inline bool Read(void)   { return (In() & Mask); }
+};
+
+// SPCR/SPSR worked out at compile time the way SPISettings does it at run time: the fastest divider of F_CPU
+// (2, 4 ... 128) not over Clock, spread over the SPR bits and SPI2X.
+template <uint32_t Clock, uint8_t BitOrder, uint8_t DataMode> struct FastSPI
+{
+  static const uint8_t Div = (Clock >= F_CPU / 2) ? 0 : (Clock >= F_CPU / 4) ? 1 : (Clock >= F_CPU / 8) ? 2 :
+                             (Clock >= F_CPU / 16) ? 3 : (Clock >= F_CPU / 32) ? 4 : (Clock >= F_CPU / 64) ? 5 : 7;
+  static const uint8_t Spcr = _BV(SPE) | _BV(MSTR) | ((BitOrder == LSBFIRST) ? _BV(DORD) : 0) |
+                              (DataMode & SPI_MODE_MASK) | (((Div ^ 1) >> 1) & SPI_CLOCK_MASK);
+  static const uint8_t Spsr = (Div ^ 1) & SPI_2XCLOCK_MASK;
+
+  static inline void Claim(void)   { SPCR = Spcr; SPSR = Spsr; }
+  static inline void Release(void) { }
+  static inline uint8_t Transfer(uint8_t Data)
+  {
+    SPDR = Data;
+    asm volatile("nop");                       // As SPI.transfer() - skips a wasted loop at the fastest clock
+    while (!(SPSR & _BV(SPIF)));
+    return SPDR;
+  }
+  static inline void WriteAsync(const uint8_t *Data, uint32_t Length) { while (Length--) Transfer(*Data++); }
+  static inline bool AsyncDone(void) { return true; }
+};
+
+#else
+
+template <uint8_t Pin> struct FastPin
+{
+  static inline void Output(void) { pinMode(Pin, OUTPUT); }
+  static inline void High(void)   { digitalWrite(Pin, HIGH); }
+  static inline void Low(void)    { digitalWrite(Pin, LOW); }
+  static inline void Set(bool State) { digitalWrite(Pin, State); }
+  static inline bool Read(void)   { return digitalRead(Pin); }
+};
+
+template <uint32_t Clock, uint8_t BitOrder, uint8_t DataMode> struct FastSPI
+{
+  static inline void Claim(void)   { SPI.beginTransaction(SPISettings(Clock, BitOrder, DataMode)); }
+  static inline void Release(void) { SPI.endTransaction(); }
+  static inline uint8_t Transfer(uint8_t Data) { return SPI.transfer(Data); }
+#if defined(ARDUINO_ARCH_RP2040)
+  // arduino-pico streams the buffer out by DMA and is polled for the end
+  static inline void WriteAsync(const uint8_t *Data, uint32_t Length) { SPI.transferAsync(Data, NULL, Length); }
+  static inline bool AsyncDone(void) { return SPI.finishedAsync(); }
+#else
+  static inline void WriteAsync(const uint8_t *Data, uint32_t Length) { while (Length--) SPI.transfer(*Data++); }
+  static inline bool AsyncDone(void) { return true; }
+#endif
+};
+
+#endif
+
+#endif
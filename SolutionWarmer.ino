@@ -4,12 +4,25 @@
 #include <OneWire.h>
 #include <FastPID.h>
 #include <stdlib.h>
+#include <stdarg.h>
+#if defined(__AVR__) || defined(ARDUINO_ARCH_RP2040)
+#include <EEPROM.h>
+#endif
+#if defined(__AVR__)
+#include <avr/sleep.h>
+#endif
 #include "Eve2_81x.h"           
 #include "MatrixEve2Conf.h"      // Header for EVE2 Display configuration settings
 #include "process.h"
+#include "screens.h"
+#include "autotune.h"
+#include "settings.h"
+#include "calibrate.h"
+#include "power.h"
 #include "Arduino_AL.h"
+#include "FastIO.h"
 
-File myFile;
+static File Files[FILE_HANDLES];  // The pool FileOpen() hands out
 char LogBuf[WorkBuffSz];
 uint8_t OWTP_addr[NumProbes][8]; // Buffer to store One wire Address
 bool OWTP_Plate_Connected;       // Bool to indicate if the DS18S20 is connected
@@ -27,14 +40,51 @@ bool OWTP_Solution_Connected;    // Bool to indicate if the DS18S20 is connected
 // https://github.com/mike-matera/FastPID     // Reference code for FastPID
 
 OneWire OWTP(OneWire_PIN); 
-FastPID PID_Heater(10, 0.0025, 40, 0.2, 8, false);      // FastPID(Kp, Ki, Kd, Hz, output_bits, output_signed);
-FastPID PID_Load(12.0, 0.0013, 0.0, 0.0625, 16, false); 
+
+// Eve's chip select and SPI settings are fixed at compile time (see FastIO.h).  The SPI unit is set up for Eve
+// by the first transaction and stays that way until the SD card takes the bus, so back-to-back transactions
+// only move chip select.  With more than one display (EVE_DEVICES) chip select is the selected one's, through
+// SetPin().
+#if EVE_DEVICES > 1
+struct EveCS
+{
+  static inline void High(void) { SetPin(EveDev->CSPin, 1); }
+  static inline void Low(void)  { SetPin(EveDev->CSPin, 0); }
+};
+#else
+typedef FastPin<EveChipSelect_PIN> EveCS;
+#endif
+typedef FastSPI<SPISpeed, MSBFIRST, SPI_MODE0> EveSPI;
+static bool EveClaimed = false;
+static bool AsyncBusy = false;                          // A SPI_WriteAsync() has not been seen to finish
+static void (*AsyncDone)(void);
+float HeaterGains[3] = { 10, 0.0025, 40 };              // Kp, Ki, Kd - replaced by autotuned gains from pidgains.txt
+float LoadGains[3]   = { 12.0, 0.0013, 0.0 };
+uint16_t LoadLow, LoadHigh;                             // Output range of PID_Load, kept to put back after a reconfigure
+FastPID PID_Heater(HeaterGains[0], HeaterGains[1], HeaterGains[2], HEATER_HZ, 8, false);  // FastPID(Kp, Ki, Kd, Hz, output_bits, output_signed);
+FastPID PID_Load(LoadGains[0], LoadGains[1], LoadGains[2], LOAD_HZ, 16, false); 
+
+// EEPROM for settings.c.  The AVR has it, the RP2040 core keeps it in a sector of flash which NV_Commit() writes,
+// and other boards go without - the settings are only on the SD card there.
+#if defined(__AVR__)
+#define NV_SIZE                   (E2END + 1)
+#elif defined(ARDUINO_ARCH_RP2040)
+#define NV_SIZE                   1024
+#else
+#define NV_SIZE                   0
+#endif
 
 void setup()
 {
+  bool Calibrated;
+
   // Initializations.  Order is important
+  Mem_Paint();         // Before the stack has been anywhere, so how deep it goes can be found later
   GlobalInit();
   FT81x_Init();
+  Settings_Load();     // Out of EEPROM - calibration, goal and gains without waiting for the SD card
+  if (Settings.Have & SET_TOUCH)
+    LoadTouchMatrix();
   SD_Init();
 
   OWTP.reset_search(); // Reset the one-wire bus to search from address zero
@@ -52,22 +102,20 @@ void setup()
     while(1); // We can not operate without successful probe interaction
   }
   
-  if (!LoadTouchMatrix())
-  {
-    // We failed to read calibration matrix values from the SD card.
-    Calibrate_Manual(DWIDTH, DHEIGHT, PIXVOFFSET, PIXHOFFSET);
-    SaveTouchMatrix(); // Save to flash
-    LoadTouchMatrix(); // reload from flash to compare values
-  }
+  // Calibration out of EEPROM, or failing that from the SD card.  With neither, the dots are tapped in MainLoop().
+  Calibrated = (Settings.Have & SET_TOUCH) || LoadTouchMatrix();
+  LoadPIDGains();      // Autotuned gains, if there are any
   
 //  Load_JPG(RAM_G, 0, "MainScr.jpg");  // Preload background jpg image into Eve GRAM
   Cmd_SetRotate(1);  // Rotate the display
-  wr8(REG_PWM_DUTY + RAM_REG, 128);      // set backlight
+  wr8(REG_PWM_DUTY + RAM_REG, POWER_BRIGHT);  // set backlight
 
-  if(SD.exists("pidlog.txt"))
-    SD.remove("pidlog.txt");
+  FileRemove("pidlog.txt");
 
   SetupMainScreen();
+  Screens_Init();      // Build the static parts of all screens into RAM_G
+  if (!Calibrated)
+    Calibrate_Start(true);  // The dots are tapped with MainLoop() running
   MainLoop(); // jump to "main()"
 }
 
@@ -77,10 +125,17 @@ void MainLoop(void)
   while(1)
   {
     CheckScreen();          // Update the screen at an effective rate
-    CheckSensors();         // Read the sensors at the correct rate
-    CheckSolution();        // Check the sensor data and update TimeTillCat value
+    CheckSensors();         // Read the sensors at the correct rate (and update the time to READY estimate)
+    CheckAutotune();        // Run the PID autotuner when it has been started
+    CheckSolution();        // Run the load PID loop to set the plate goal
     CheckHeater();          // Run PID loop for heater
+    CheckHistory();         // Record the temperatures for the History screen
     CheckTouch();           // Check for user touching and update values (blocks on touch)
+    CheckCalibrate();       // Take the calibration taps while the calibration dots are showing
+    SPI_AsyncPoll();        // Finish off a frame still going out to Eve
+    CheckSettings();        // Write saved settings into EEPROM a byte at a time
+    CheckMemory();          // Log the stack high-water mark as it rises
+    CheckPower();           // Dim the display when idle, and sleep until the next thing to do
   }
 }
 
@@ -100,87 +155,165 @@ void MainLoop(void)
 
 void GlobalInit(void)
 {
+  uint8_t i;
+
   Wire.begin();                          // Setup I2C bus
 
   Serial.begin(115200);                  // Setup serial port for debug
   while (!Serial) {;}                    // wait for serial port to connect.
   
   // Matrix Orbital Eve display interface initialization
-  pinMode(EvePDN_PIN, OUTPUT);            // Pin setup as output for Eve PDN pin.
-  SetPin(EvePDN_PIN, 0);                  // Apply a resetish condition on Eve
-  pinMode(EveChipSelect_PIN, OUTPUT);     // SPI CS Initialization
-  SetPin(EveChipSelect_PIN, 1);           // Deselect Eve
+  for (i = 0; i < EVE_DEVICES; i++)
+  {
+    pinMode(EveDevices[i].PDNPin, OUTPUT);   // Pin setup as output for Eve PDN pin.
+    SetPin(EveDevices[i].PDNPin, 0);         // Apply a resetish condition on Eve
+    pinMode(EveDevices[i].CSPin, OUTPUT);    // SPI CS Initialization
+    SetPin(EveDevices[i].CSPin, 1);          // Deselect Eve
+  }
   pinMode(EveAudioEnable_PIN, OUTPUT);    // Audio Enable PIN
   SetPin(EveAudioEnable_PIN, 0);          // Disable Audio
   pinMode(ControlOutput_PIN, OUTPUT);     // Pin setup as output for the software PWM pin controlling the heater
   SetPin(ControlOutput_PIN, 0);           // Turn that heater OFF!
 
   SPI.begin();                            // Enable SPI
+#if defined(ARDUINO_ARCH_RP2040)
+  EEPROM.begin(NV_SIZE);                  // Copies the flash sector into RAM
+#endif
 //  Log("Startup\n");
 }
 
+// Set the SPI unit up for Eve unless it still is from the last transaction
+static inline void SPI_Claim(void)
+{
+  if (!EveClaimed)
+  {
+    EveSPI::Claim();
+    EveClaimed = true;
+  }
+}
+
+// Hand the bus over to something else (the SD card).  Eve's next transaction claims it back.
+void SPI_Release(void)
+{
+#ifdef EVE_ASYNC
+  SPI_AsyncWait();
+#endif
+  if (EveClaimed)
+  {
+    EveSPI::Release();
+    EveClaimed = false;
+  }
+}
+
 // Send a single byte through SPI
 void SPI_WriteByte(uint8_t data)
 {
-  SPI.beginTransaction(SPISettings(SPISpeed, MSBFIRST, SPI_MODE0));
-  digitalWrite(EveChipSelect_PIN, LOW);
+#ifdef EVE_ASYNC
+  SPI_AsyncWait();                          // Whatever is still going out goes first
+#endif
+  SPI_Claim();
+  EveCS::Low();
 
-  SPI.transfer(data);
+  EveSPI::Transfer(data);
       
-  digitalWrite(EveChipSelect_PIN, HIGH);
-  SPI.endTransaction();
+  EveCS::High();
 }
 
 // Send a series of bytes (contents of a buffer) through SPI
 void SPI_WriteBuffer(uint8_t *Buffer, uint32_t Length)
 {
-  SPI.beginTransaction(SPISettings(SPISpeed, MSBFIRST, SPI_MODE0));
-  digitalWrite(EveChipSelect_PIN, LOW);
+#ifdef EVE_ASYNC
+  SPI_AsyncWait();                          // Whatever is still going out goes first
+#endif
+  SPI_Claim();
+  EveCS::Low();
 
-  SPI.transfer(Buffer, Length);
+  while (Length--)                          // Like SPI.transfer(Buffer, Length), what comes back replaces it
+  {
+    *Buffer = EveSPI::Transfer(*Buffer);
+    Buffer++;
+  }
       
-  digitalWrite(EveChipSelect_PIN, HIGH);
-  SPI.endTransaction();
+  EveCS::High();
 }
 
 // Send a byte through SPI as part of a larger transmission.  Does not enable/disable SPI CS
 void SPI_Write(uint8_t data)
 {
 //  Log("W-0x%02x\n", data);
-  SPI.transfer(data);
+  EveSPI::Transfer(data);
 }
 
 // Read a series of bytes from SPI and store them in a buffer
 void SPI_ReadBuffer(uint8_t *Buffer, uint32_t Length)
 {
-  uint8_t a = SPI.transfer(0x00); // dummy read
+  EveSPI::Transfer(0x00); // dummy read
 
   while (Length--)
   {
-    *(Buffer++) = SPI.transfer(0x00);
+    *(Buffer++) = EveSPI::Transfer(0x00);
+  }
+}
+
+// Send a series of bytes out of flash (PROGMEM) as part of a larger transmission.  Does not enable/disable SPI CS
+void SPI_WriteFlash(const uint8_t *Buffer, uint32_t Length)
+{
+  while (Length--)
+  {
+    EveSPI::Transfer(pgm_read_byte(Buffer++));
   }
 }
 
+// Start writing a buffer as part of a larger transmission and return, where the board can do that (see FastIO.h).
+// Done is called, from SPI_AsyncPoll(), once it is all out - chip select is left to it.  The buffer must stay
+// untouched until then.  Every other SPI function waits for the end first, so nothing can get in between.
+void SPI_WriteAsync(const uint8_t *Buffer, uint32_t Length, void (*Done)(void))
+{
+  SPI_AsyncWait();
+  AsyncBusy = true;
+  AsyncDone = Done;
+  EveSPI::WriteAsync(Buffer, Length);
+  SPI_AsyncPoll();                          // Where the write was not asynchronous it is finished already
+}
+
+// Returns true while an asynchronous write is going out.  Calls its Done when it has finished.
+bool SPI_AsyncPoll(void)
+{
+  if (!AsyncBusy || !EveSPI::AsyncDone())
+    return AsyncBusy;
+  AsyncBusy = false;
+  if (AsyncDone)
+    AsyncDone();                            // Which may start another
+  return AsyncBusy;
+}
+
+void SPI_AsyncWait(void)
+{
+  while (SPI_AsyncPoll());
+}
+
 // Enable SPI by activating chip select line
 void SPI_Enable(void)
 {
-  SPI.beginTransaction(SPISettings(SPISpeed, MSBFIRST, SPI_MODE0));
-  digitalWrite(EveChipSelect_PIN, LOW);
+#ifdef EVE_ASYNC
+  SPI_AsyncWait();                          // Whatever is still going out goes first
+#endif
+  SPI_Claim();
+  EveCS::Low();
 }
 
 // Disable SPI by deasserting the chip select line
 void SPI_Disable(void)
 {
-  digitalWrite(EveChipSelect_PIN, HIGH);
-  SPI.endTransaction();
+  EveCS::High();
 }
 
 void Eve_Reset_HW(void)
 {
   // Reset Eve
-  SetPin(EvePDN_PIN, 0);                    // Set the Eve PDN pin low
+  SetPin(EveDev->PDNPin, 0);                // Set the Eve PDN pin low
   MyDelay(50);                              // delay
-  SetPin(EvePDN_PIN, 1);                    // Set the Eve PDN pin high
+  SetPin(EveDev->PDNPin, 1);                // Set the Eve PDN pin high
   MyDelay(100);                             // delay
 }
 
@@ -189,6 +322,17 @@ void DebugPrint(char *str)
   Serial.print(str);
 }
 
+// Log() - the format is in flash.  Lines are cut short at the size of LogBuf.
+void Log_P(const char *Fmt, ...)
+{
+  va_list Args;
+
+  va_start(Args, Fmt);
+  vsnprintf_P(LogBuf, WorkBuffSz, Fmt, Args);
+  va_end(Args);
+  DebugPrint(LogBuf);
+}
+
 // A millisecond delay wrapper for the Arduino function
 void MyDelay(uint32_t DLY)
 {
@@ -202,10 +346,132 @@ uint32_t MyMillis(void)
   return millis();
 }
 
+// Externally accessible abstraction for micros()
+uint32_t MyMicros(void)
+{
+  return micros();
+}
+
+// Sleep until millis() reaches Until.  On the AVR the idle sleep mode keeps the timers, SPI and the serial port
+// running, and timer 0 wakes it every millisecond to look at the time.  Other boards return at once.
+void MCU_Sleep(uint32_t Until)
+{
+#if defined(__AVR__)
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  while (millis() < Until)
+    sleep_mode();
+#endif
+}
+
+// Copy constant data out of flash (PROGMEM) into RAM
+void FlashRead(void *Dest, const void *Src, uint16_t Length)
+{
+  memcpy_P(Dest, Src, Length);
+}
+
+// RAM use.  On the AVR the heap grows up from the end of the static variables (__heap_start) to __brkval, and the
+// stack down from RAMEND.  Between them is painted, and the stack has been as deep as the lowest byte that is no
+// longer paint.  The heap peak is looked at here and by FileOpen(), as the SD library allocates its open files.
+#define MEM_PAINT               0xA5
+
+#if defined(__AVR__)
+extern char __heap_start, *__brkval;
+static uint16_t HeapPeak;
+
+static uint8_t *Mem_HeapTop(void)
+{
+  uint8_t *Top = (uint8_t *)(__brkval ? __brkval : &__heap_start);
+
+  if ((uint16_t)(Top - (uint8_t *)&__heap_start) > HeapPeak)
+    HeapPeak = Top - (uint8_t *)&__heap_start;
+  return ((uint8_t *)&__heap_start + HeapPeak);
+}
+
+void Mem_Paint(void)
+{
+  uint8_t *p = Mem_HeapTop();
+
+  while (p < (uint8_t *)SP)                // Up to the stack pointer - this function's frame is above it
+    *p++ = MEM_PAINT;
+}
+
+uint16_t Mem_StackUsed(void)
+{
+  uint8_t *p = Mem_HeapTop();
+
+  while ((p <= (uint8_t *)RAMEND) && (*p == MEM_PAINT))
+    p++;
+  return ((uint8_t *)RAMEND - p + 1);
+}
+
+uint16_t Mem_HeapPeak(void)
+{
+  Mem_HeapTop();
+  return (HeapPeak);
+}
+
+// Bytes the stack and heap have never reached
+uint16_t Mem_Free(void)
+{
+  return ((RAMEND + 1) - Mem_StackUsed() - (uint16_t)Mem_HeapTop());
+}
+#else
+void Mem_Paint(void)
+{
+}
+
+uint16_t Mem_StackUsed(void)
+{
+  return 0;
+}
+
+uint16_t Mem_HeapPeak(void)
+{
+  return 0;
+}
+
+uint16_t Mem_Free(void)
+{
+  return 0;
+}
+#endif
+
+// Log how deep the stack has been each time that grows, and warn when little RAM has never been used
+void CheckMemory(void)
+{
+  static uint32_t Time2CheckMemory = MEM_CHECK_INTERVAL;
+  static uint16_t Reported = 0;            // Stack use last logged
+  uint16_t Used;
+
+  if (MyMillis() < Time2CheckMemory)
+    return;
+  Time2CheckMemory = MyMillis() + MEM_CHECK_INTERVAL;
+
+  Used = Mem_StackUsed();
+  if (!Used)                               // Not known on this board
+    return;
+  if (Used > Reported)
+  {
+    Reported = Used;
+    Log("RAM: stack %u heap %u free %u\n", Used, Mem_HeapPeak(), Mem_Free());
+  }
+  if (Mem_Free() < MEM_MIN_FREE)
+    Log("Low RAM: %u free\n", Mem_Free());
+}
+
 // An abstracted pin write that may be called from outside this file.
+// The pins the code drives go straight to their port.  None of them is used for PWM, so skipping what
+// digitalWrite() does to turn a timer off is safe.
 void SetPin(uint8_t pin, bool state)
 {
-  digitalWrite(pin, state); 
+  switch (pin)
+  {
+  case ControlOutput_PIN:  FastPin<ControlOutput_PIN>::Set(state);  break;
+  case EveAudioEnable_PIN: FastPin<EveAudioEnable_PIN>::Set(state); break;
+  case EvePDN_PIN:         FastPin<EvePDN_PIN>::Set(state);         break;
+  case EveChipSelect_PIN:  FastPin<EveChipSelect_PIN>::Set(state);  break;
+  default:                 digitalWrite(pin, state);
+  }
 }
 
 // An abstracted pin read that may be called from outside this file.
@@ -236,9 +502,39 @@ void PID_ClearAll(void)
 
 void PID_Load_SetRange(uint16_t Lowend, uint16_t Highend)
 {
+  LoadLow = Lowend;
+  LoadHigh = Highend;
   PID_Load.setOutputRange(Lowend, Highend); // Set the solution PID to demand temperatures between low and high
 }
 
+// Change the gains of a PID.  FastPID refuses gains it can not represent in its fixed point, in which case
+// the PID is configured again with the gains it had.
+static bool PID_SetGains(FastPID &Pid, float *Gains, float Hz, int Bits, float Kp, float Ki, float Kd)
+{
+  if (Pid.setCoefficients(Kp, Ki, Kd, Hz))
+  {
+    Gains[0] = Kp;
+    Gains[1] = Ki;
+    Gains[2] = Kd;
+    return true;
+  }
+  Pid.configure(Gains[0], Gains[1], Gains[2], Hz, Bits, false);
+  return false;
+}
+
+bool PID_Heater_SetGains(float Kp, float Ki, float Kd)
+{
+  return (PID_SetGains(PID_Heater, HeaterGains, HEATER_HZ, 8, Kp, Ki, Kd));
+}
+
+bool PID_Load_SetGains(float Kp, float Ki, float Kd)
+{
+  if (PID_SetGains(PID_Load, LoadGains, LOAD_HZ, 16, Kp, Ki, Kd))
+    return true;
+  PID_Load.setOutputRange(LoadLow, LoadHigh); // configure() forgot it
+  return false;
+}
+
 //================================== One-Wire Functions ====================================
 int8_t searchTempProbe(uint8_t ProbeNum)
 {
@@ -289,6 +585,7 @@ int16_t readTempProbe(uint8_t ProbeNum)
 void SD_Init(void)
 {
 //  Log("Initializing SD card...\n");
+  SPI_Release();
   if (!SD.begin(SDChipSelect_PIN)) 
   {
     Log("SD initialization failed!\n");
@@ -297,164 +594,363 @@ void SD_Init(void)
 //  Log("SD initialization done\n");
 }
 
-// Read the touch digitizer calibration matrix values from the Eve and write them to a file
+// Read the touch digitizer calibration matrix values from the Eve into the settings, to be saved in EEPROM, and
+// write them to a file as well
 void SaveTouchMatrix(void)
 {
+  uint8_t Buf[sizeof(Settings.TouchMatrix)];
   uint8_t count = 0;
   uint32_t data;
+  FileHandle h;
+  EveRegOp Ops[6];
   uint32_t address = REG_TOUCH_TRANSFORM_A + RAM_REG;
   
 //  Log("Enter SaveTouchMatrix\n");
-  
-  // If the file exists already from previous run, then delete it.
-  if(SD.exists("tmatrix.txt"))
+
+  for (count = 0; count < 6; count++)      // The six registers are neighbours - read them all in one frame
   {
-    SD.remove("tmatrix.txt");
-    MyDelay(50);
+    Ops[count].Address = address + (count * 4);
+    Ops[count].Result = &Settings.TouchMatrix[count];
+    Ops[count].Size = 4;
+    Ops[count].Write = false;
   }
-  
-  FileOpen("tmatrix.txt", FILEWRITE);
-  if(!myFileIsOpen())
+  Eve_RunBatch(Ops, 6);
+  Settings.Have |= SET_TOUCH;
+  Settings_Save();
+
+  for (count = 0; count < 6; count++)
   {
-    Log("No create file\n");
-    FileClose();
-    return false;
+    data = Settings.TouchMatrix[count];
+    Log("TM%dw: 0x%08lx\n", count, data);
+    Buf[(count * 4)]     = data & 0xff;      // Little endian file storage to match Eve
+    Buf[(count * 4) + 1] = (data >> 8) & 0xff;
+    Buf[(count * 4) + 2] = (data >> 16) & 0xff;
+    Buf[(count * 4) + 3] = (data >> 24) & 0xff;
   }
-  
-  do
+
+  h = FileOpen("tmatrix.txt", FILEWRITE);  // Replaces the file of a previous run
+  if(h == FILE_NONE)
   {
-    data = rd32(address + (count * 4));
-    Log("TM%dw: 0x%08lx\n", count, data);
-    FileWrite(data & 0xff);                // Little endian file storage to match Eve
-    FileWrite((data >> 8) & 0xff);
-    FileWrite((data >> 16) & 0xff);
-    FileWrite((data >> 24) & 0xff);
-    count++;
-  }while(count < 6);
-  FileClose();
+    Log("No create file\n");
+    return;
+  }
+  FileWriteBuf(h, Buf, sizeof(Buf));
+  FileClose(h);
   Log("Matrix Saved\n\n");
 }
 
-// Read the touch digitizer calibration matrix values from a file and write them to the Eve.
+// Write the touch digitizer calibration matrix values to the Eve.  They come from the settings, or if there are
+// none there, from a file - and then go into the settings to be found there next time.
 bool LoadTouchMatrix(void)
 {
+  uint8_t Buf[sizeof(Settings.TouchMatrix)];
   uint8_t count = 0;
   uint32_t data;
+  FileHandle h;
+  EveRegOp Ops[6];
   uint32_t address = REG_TOUCH_TRANSFORM_A + RAM_REG;
   
-  FileOpen("tmatrix.txt", FILEREAD);
-  if(!myFileIsOpen())
+  if (!(Settings.Have & SET_TOUCH))
   {
-    Log("tmatrix.txt not open\n");
-    FileClose();
-    return false;
+    h = FileOpen("tmatrix.txt", FILEREAD);
+    if((FileSize(h) != sizeof(Buf)) || (FileReadBuf(h, Buf, sizeof(Buf)) != sizeof(Buf)))
+    {
+      Log("tmatrix.txt not open\n");
+      FileClose(h);
+      return false;
+    }
+    FileClose(h);
+
+    for (count = 0; count < 6; count++)
+    {
+      data = Buf[(count * 4)] + ((uint32_t)Buf[(count * 4) + 1] << 8) + ((uint32_t)Buf[(count * 4) + 2] << 16) +
+             ((uint32_t)Buf[(count * 4) + 3] << 24);
+      Log("TM%dr: 0x%08lx\n", count, data);
+      Settings.TouchMatrix[count] = data;
+    }
+    Settings.Have |= SET_TOUCH;
+    Settings_Save();
   }
   
-  do
+  for (count = 0; count < 6; count++)
   {
-    data = FileReadByte() +  ((uint32_t)FileReadByte() << 8) + ((uint32_t)FileReadByte() << 16) + ((uint32_t)FileReadByte() << 24);
-    Log("TM%dr: 0x%08lx\n", count, data);
-    wr32(address + (count * 4), data);
-    count++;
-  }while(count < 6);
-  
-  FileClose();
+    Ops[count].Address = address + (count * 4);
+    Ops[count].Value = Settings.TouchMatrix[count];
+    Ops[count].Size = 4;
+    Ops[count].Write = true;
+  }
+  Eve_RunBatch(Ops, 6);                    // All six in one frame
   Log("Matrix Loaded \n\n");
   return true;
 }
 
+// Put the PID gains (heater then load, Kp Ki Kd each) into the settings, to be saved in EEPROM, and write them to
+// a file as little endian floats as well
+void SavePIDGains(void)
+{
+  float *Gains[2] = { HeaterGains, LoadGains };
+  uint8_t Buf[sizeof(Settings.HeaterGains) + sizeof(Settings.LoadGains)];
+  uint8_t *p = Buf;
+  uint32_t data;
+  uint8_t i, j;
+  FileHandle h;
+
+  memcpy(Settings.HeaterGains, HeaterGains, sizeof(Settings.HeaterGains));
+  memcpy(Settings.LoadGains, LoadGains, sizeof(Settings.LoadGains));
+  Settings.Have |= SET_GAINS;
+  Settings_Save();
+
+  for (i = 0; i < 2; i++)
+  {
+    for (j = 0; j < 3; j++)
+    {
+      memcpy(&data, &Gains[i][j], 4);
+      p[0] = data & 0xff;
+      p[1] = (data >> 8) & 0xff;
+      p[2] = (data >> 16) & 0xff;
+      p[3] = (data >> 24) & 0xff;
+      p += 4;
+    }
+  }
+
+  h = FileOpen("pidgains.txt", FILEWRITE);
+  if(h == FILE_NONE)
+  {
+    Log("No create file\n");
+    return;
+  }
+  FileWriteBuf(h, Buf, sizeof(Buf));
+  FileClose(h);
+  Log("Gains Saved\n");
+}
+
+// Put the PID gains saved by SavePIDGains() to use - from the settings, or if there are none there, from the file
+bool LoadPIDGains(void)
+{
+  float Gains[6];
+  uint8_t Buf[sizeof(Gains)];
+  uint32_t data;
+  uint8_t i;
+  FileHandle h;
+
+  if (Settings.Have & SET_GAINS)
+  {
+    memcpy(&Gains[0], Settings.HeaterGains, sizeof(Settings.HeaterGains));
+    memcpy(&Gains[3], Settings.LoadGains, sizeof(Settings.LoadGains));
+  }
+  else
+  {
+    h = FileOpen("pidgains.txt", FILEREAD);
+    if((FileSize(h) != sizeof(Buf)) || (FileReadBuf(h, Buf, sizeof(Buf)) != sizeof(Buf)))
+    {
+      FileClose(h);
+      return false;
+    }
+    FileClose(h);
+
+    for (i = 0; i < 6; i++)
+    {
+      data = Buf[(i * 4)] + ((uint32_t)Buf[(i * 4) + 1] << 8) + ((uint32_t)Buf[(i * 4) + 2] << 16) +
+             ((uint32_t)Buf[(i * 4) + 3] << 24);
+      memcpy(&Gains[i], &data, 4);
+    }
+  }
+
+  if (!PID_Heater_SetGains(Gains[0], Gains[1], Gains[2]) || !PID_Load_SetGains(Gains[3], Gains[4], Gains[5]))
+  {
+    Log("Bad gains\n");
+    return false;
+  }
+  if (!(Settings.Have & SET_GAINS))        // Into the settings for next time
+  {
+    memcpy(Settings.HeaterGains, HeaterGains, sizeof(Settings.HeaterGains));
+    memcpy(Settings.LoadGains, LoadGains, sizeof(Settings.LoadGains));
+    Settings.Have |= SET_GAINS;
+    Settings_Save();
+  }
+  Log("Gains Loaded\n");
+  return true;
+}
+
+//================================== EEPROM Functions ====================================
+uint16_t NV_Size(void)
+{
+  return NV_SIZE;
+}
+
+uint8_t NV_Read(uint16_t Address)
+{
+#if NV_SIZE
+  return EEPROM.read(Address);
+#else
+  return 0xFF;
+#endif
+}
+
+// Starts writing a byte, unless it is there already.  On the AVR that takes 3.3 mS, which NV_Busy() tells the end of.
+void NV_Write(uint16_t Address, uint8_t Data)
+{
+#if defined(__AVR__)
+  EEPROM.update(Address, Data);
+#elif NV_SIZE
+  EEPROM.write(Address, Data);
+#endif
+}
+
+bool NV_Busy(void)
+{
+#if defined(__AVR__)
+  return !eeprom_is_ready();
+#else
+  return false;
+#endif
+}
+
+// The end of a record.  The RP2040 writes its copy of the EEPROM to flash (only if it changed).
+void NV_Commit(void)
+{
+#if defined(ARDUINO_ARCH_RP2040)
+  EEPROM.commit();
+#endif
+}
+
 // ************************************************************************************
-// Following are abstracted file operations for Arduino.  This is possible by using a * 
-// global pointer to a single file.  It is enough for our needs and it hides file     *
-// handling details within the abstraction.                                           *
+// Following are abstracted file operations for Arduino.  Open files live in a small  *
+// pool and are known outside by their index in it, which hides the file handling     *
+// details (and the File class) within the abstraction.                               *
 // ************************************************************************************
-void FileOpen(char *filename, uint8_t mode)
+FileHandle FileOpen(const char *filename, uint8_t mode)
 {
+  FileHandle h;
+
+  for (h = 0; (h < FILE_HANDLES) && Files[h]; h++)
+    ;
+  if (h == FILE_HANDLES)
+  {
+    Log("No file handle\n");
+    return FILE_NONE;
+  }
+
   // Since one also loses access to defined values like FILE_READ from outside the .ino
   // I have been forced to make up values and pass them here (mode) where I can use the 
   // Arduino defines.
+  SPI_Release();                            // The card shares the bus with Eve
   switch(mode)
   {
   case FILEREAD:
-    myFile = SD.open(filename, FILE_READ);
+    Files[h] = SD.open(filename, FILE_READ);
     break;
   case FILEWRITE:
-    myFile = SD.open(filename, FILE_WRITE);
+    if(SD.exists(filename))                 // FILE_WRITE would append to what is there
+      SD.remove(filename);
+    Files[h] = SD.open(filename, FILE_WRITE);
+    break;
+  case FILEAPPEND:
+    Files[h] = SD.open(filename, FILE_WRITE);
     break;
   default:;
   }
+  Mem_HeapPeak();                           // An open file has its buffer on the heap
+  return (Files[h] ? h : FILE_NONE);
 }
 
-void FileClose(void)
+void FileClose(FileHandle h)
 {
-  myFile.close();
-  if(myFileIsOpen())
+  if ((h >= FILE_HANDLES) || !Files[h])
+    return;
+  SPI_Release();
+  Files[h].close();
+  if(Files[h])
   {
     Log("Failed to close file\n");
   }
 }
 
-// Read a single byte from a file
-uint8_t FileReadByte(void)
+// Put what has been written so far on the card
+void FileFlush(FileHandle h)
+{
+  if ((h >= FILE_HANDLES) || !Files[h])
+    return;
+  SPI_Release();
+  Files[h].flush();
+}
+
+// Read a single byte from a file - 0xFF past the end
+uint8_t FileReadByte(FileHandle h)
+{
+  if ((h >= FILE_HANDLES) || !Files[h])
+    return 0xFF;
+  SPI_Release();
+  return(Files[h].read());
+}
+
+// Read bytes from a file into a provided buffer.  Returns how many there were.
+uint32_t FileReadBuf(FileHandle h, uint8_t *data, uint32_t NumBytes)
 {
-  return(myFile.read());
+  int Got;
+
+  if ((h >= FILE_HANDLES) || !Files[h])
+    return 0;
+  SPI_Release();
+  Got = Files[h].read(data, NumBytes);
+  return ((Got > 0) ? Got : 0);
 }
 
-// Read bytes from a file into a provided buffer
-void FileReadBuf(uint8_t *data, uint32_t NumBytes)
+void FileWrite(FileHandle h, uint8_t data)
 {
-  myFile.read(data, NumBytes);
+  if ((h >= FILE_HANDLES) || !Files[h])
+    return;
+  SPI_Release();
+  Files[h].write(data);
 }
 
-void FileWrite(uint8_t data)
+// Write bytes from a buffer to a file.  Returns how many were written.
+uint32_t FileWriteBuf(FileHandle h, const uint8_t *data, uint32_t NumBytes)
 {
-  myFile.write(data);
+  if ((h >= FILE_HANDLES) || !Files[h])
+    return 0;
+  SPI_Release();
+  return(Files[h].write(data, NumBytes));
 }
 
 // Write a string of characters to a file
 // MaxChars does not include the null terminator of the source string.
 // We make no attempt to detect the usage of MaxChars and simply truncate the output
-void FileWriteStr(uint8_t *str, uint16_t MaxChars)
+uint16_t FileWriteStr(FileHandle h, const char *str, uint16_t MaxChars)
 {
-  int16_t count = 0; 
+  uint16_t count = 0; 
 
-  FileOpen("pidlog.txt", FILEWRITE);
-  if(!myFileIsOpen())
-  {
-    Log("No file\n");
-    FileClose();
-    return;
-  }
-  
-  // Write out the string until the terminator or until we've written the max
   while( (count < MaxChars) && str[count] )
-  {
-    FileWrite(str[count]);
     count++;
-  }
-  FileClose();
+  return(FileWriteBuf(h, (const uint8_t *)str, count));
 }
 
-uint32_t FileSize(void)
+uint32_t FileSize(FileHandle h)
 {
-  return(myFile.size());
+  if ((h >= FILE_HANDLES) || !Files[h])
+    return 0;
+  return(Files[h].size());
 }
 
-uint32_t FilePosition(void)
+uint32_t FilePosition(FileHandle h)
 {
-  return(myFile.position());
+  if ((h >= FILE_HANDLES) || !Files[h])
+    return 0;
+  return(Files[h].position());
 }
 
-bool FileSeek(uint32_t offset)
+bool FileSeek(FileHandle h, uint32_t offset)
 {
-  return(myFile.seek(offset));
+  if ((h >= FILE_HANDLES) || !Files[h])
+    return false;
+  SPI_Release();
+  return(Files[h].seek(offset));
 }
 
-bool myFileIsOpen(void)
+// Remove a file if it is there
+void FileRemove(const char *filename)
 {
-  if(myFile)
-    return true;
-  else
-    return false;
+  SPI_Release();
+  if(SD.exists(filename))
+    SD.remove(filename);
 }
-
@@ -0,0 +1,273 @@
+// Relay feedback autotuner for the heater and load PID loops (Astrom-Hagglund).
+//
+// Instead of the PID, a relay drives the loop: full output while the process value is below the set point, low
+// output while it is above.  The loop then settles into a steady oscillation whose period is the ultimate period
+// Tu and whose amplitude a gives the ultimate gain Ku = 4d / (pi * sqrt(a^2 - e^2)), where d is half the relay
+// swing and e its hysteresis.  The PID gains are worked out from Ku and Tu.
+//
+// The heater (plate) loop is tuned first since it is inside the load loop, then the load loop is tuned with the
+// new heater gains in place.  The gains go to the SD card and are loaded again at startup.
+//
+// This file also watches each warm-up (activation or end of tuning) and logs how long the solution took to
+// reach and to settle at its goal and how far it overshot, so the effect of a set of gains (or of the
+// feedforward in model.c) can be seen.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include <stdio.h>                 // sprintf()
+#include <string.h>                // strcpy_P() where flash is ordinary memory
+#include <math.h>                  // sqrt()
+#include "Arduino_AL.h"            // include the hardware specific abstraction layer header for the specific hardware in use.
+#include "process.h"               // MainScreen
+#include "autotune.h"              // Header for this file
+
+typedef struct {
+  uint8_t  Loop;                   // TUNE_xxx being tuned
+  uint8_t  Rises;                  // Times the relay has switched high
+  bool     High;                   // Relay output is high
+  uint16_t SetPoint;               // Relay switching point x10 degrees
+  uint16_t OutHigh, OutLow;        // Relay outputs
+  uint16_t Max, Min;               // Peaks of the process value in the current cycle
+  uint32_t LastRise;               // MyMillis() when the relay last switched high
+  uint32_t PeriodSum;              // mS summed over the measured cycles
+  uint32_t SwingSum;               // Peak to peak swings summed over the measured cycles
+  uint32_t Start;                  // MyMillis() at the start of this loop's test
+} Relay;
+
+Relay    Tune;
+uint32_t Time2CheckAutotune = 0;   // Private variable holding time of next autotune step
+char     TuneStatus[20] = "";      // Shown on the settings screen
+uint32_t WarmupStart = 0;          // MyMillis() at the start of a warm-up being watched - 0 for none
+uint32_t InBandSince = 0;          // MyMillis() since when the solution has been within SETTLE_BAND - 0 for not
+uint16_t WarmupPeak;               // Hottest solution temperature of the warm-up
+bool     WarmupReached;            // The solution has been within SETTLE_BAND of the goal
+
+// Start a relay test on one loop
+static void Relay_Start(uint8_t Loop)
+{
+  Tune.Loop = Loop;
+  Tune.Rises = 0;
+  Tune.PeriodSum = 0;
+  Tune.SwingSum = 0;
+  Tune.Start = MyMillis();
+
+  if (Loop == TUNE_HEATER)
+  {
+    Tune.SetPoint = MainScreen.SolutionGoal + TUNE_HEATER_SPAN;
+    if (Tune.SetPoint > 600)
+      Tune.SetPoint = 600;
+    Tune.OutHigh = 255;                                           // Full heater power
+    Tune.OutLow = 0;
+    Tune.Max = Tune.Min = MainScreen.PlateTemp;
+  }
+  else
+  {
+    Tune.SetPoint = MainScreen.SolutionGoal - TUNE_LOAD_BELOW;
+    Tune.OutHigh = 600;                                           // Top of the range the load PID works in (PID_Load_SetRange)
+    Tune.OutLow = Tune.SetPoint;
+    Tune.Max = Tune.Min = MainScreen.SolutionTemp;
+  }
+  Tune.High = false;
+  strcpy_P(TuneStatus, (Loop == TUNE_HEATER) ? PSTR("Tuning plate") : PSTR("Tuning load"));
+  Log("Autotune %d at %u\n", Loop, Tune.SetPoint);
+}
+
+// Stop tuning, leaving the gains as they are.  Why is in flash.
+static void Autotune_Stop(const char *Why)
+{
+  Tune.Loop = TUNE_IDLE;
+  PID_ClearAll();
+  strcpy_P(TuneStatus, Why);
+  Log("Autotune: %s\n", TuneStatus);
+}
+
+// Work out and apply the gains of a finished relay test.  Returns false if they could not be used.
+static bool Relay_Finish(void)
+{
+  float d = (Tune.OutHigh - Tune.OutLow) / 2.0;
+  float a = Tune.SwingSum / (2.0 * TUNE_CYCLES);
+  float Tu = Tune.PeriodSum / (1000.0 * TUNE_CYCLES);            // Seconds
+  float Ku, Kp, Ki, Kd;
+  bool Ok;
+
+  if (a <= TUNE_HYST)                                             // Lost in the hysteresis - nothing to go on
+    return false;
+  Ku = (4 * d) / (M_PI * sqrt((a * a) - (TUNE_HYST * TUNE_HYST)));
+
+  if (Tune.Loop == TUNE_HEATER)
+  {
+    // Ziegler-Nichols "some overshoot" - the plate may overshoot a little, the solution must not
+    Kp = Ku / 3;
+    Ki = Kp / (Tu / 2);
+    Kd = Kp * (Tu / 3);
+    Ok = PID_Heater_SetGains(Kp, Ki, Kd);
+  }
+  else
+  {
+    // Tyreus-Luyben PI - slow and without overshoot, which is what keeps the solution out of OVER TEMP
+    Kp = Ku / 3.2;
+    Ki = Kp / (2.2 * Tu);
+    Kd = 0;
+    Ok = PID_Load_SetGains(Kp, Ki, Kd);
+  }
+
+  // There is no %f on AVR, so gains are logged x1000
+  Log("Loop %d: Ku*1000 %ld Tu %ld s\n", Tune.Loop, (long)(Ku * 1000), (long)Tu);
+  Log("Kp %ld Ki %ld Kd %ld (x1000)%s\n", (long)(Kp * 1000), (long)(Ki * 1000), (long)(Kd * 1000), Ok ? "" : " rejected");
+  return Ok;
+}
+
+// One step of the relay test with a new process value
+static void Relay_Step(uint16_t PV)
+{
+  uint32_t Now = MyMillis();
+
+  if (PV > Tune.Max) Tune.Max = PV;
+  if (PV < Tune.Min) Tune.Min = PV;
+
+  if (Tune.High && (PV > Tune.SetPoint + TUNE_HYST))
+    Tune.High = false;
+  else if (!Tune.High && (PV < Tune.SetPoint - TUNE_HYST))
+  {
+    // The relay switches high once a cycle, which makes it the place to measure the cycle just gone.
+    // The first cycle is the way in from wherever the test started, so it is not used.
+    Tune.High = true;
+    if (Tune.Rises >= 2)
+    {
+      Tune.PeriodSum += Now - Tune.LastRise;
+      Tune.SwingSum += Tune.Max - Tune.Min;
+    }
+    Tune.Rises++;
+    Tune.LastRise = Now;
+    Tune.Max = Tune.Min = PV;
+    sprintf_P(TuneStatus, (Tune.Loop == TUNE_HEATER) ? PSTR("Tuning plate %d/%d") : PSTR("Tuning load %d/%d"),
+              (Tune.Rises > 1) ? Tune.Rises - 1 : 0, TUNE_CYCLES);
+  }
+
+  if (Tune.Loop == TUNE_HEATER)
+    PWM_Val = Tune.High ? Tune.OutHigh : Tune.OutLow;
+  else
+    MainScreen.PlateGoal = Tune.High ? Tune.OutHigh : Tune.OutLow;
+}
+
+// Start tuning both loops - the system is activated if it is not already
+void Autotune_Start(void)
+{
+  if (!MainScreen.Activated)
+    Warmer_Activate();
+  WarmupStart = 0;
+  Time2CheckAutotune = 0;
+  Relay_Start(TUNE_HEATER);
+}
+
+void Autotune_Cancel(void)
+{
+  if (Tune.Loop != TUNE_IDLE)
+    Autotune_Stop(PSTR("Tune cancelled"));
+}
+
+// Which loop, if any, the autotuner is driving in place of its PID
+uint8_t Autotune_Loop(void)
+{
+  return (Tune.Loop);
+}
+
+const char *Autotune_Status(void)
+{
+  return (TuneStatus);
+}
+
+// Watch a warm-up and log its settling time and overshoot
+void Warmup_Start(void)
+{
+  WarmupStart = MyMillis();
+  InBandSince = 0;
+  WarmupPeak = 0;
+  WarmupReached = false;
+}
+
+static void Warmup_Check(void)
+{
+  uint16_t Temp = MainScreen.SolutionTemp;
+  uint16_t Goal = MainScreen.SolutionGoal;
+
+  if (!WarmupStart)
+    return;
+
+  if (Temp > WarmupPeak)
+    WarmupPeak = Temp;
+
+  if ((Temp + SETTLE_BAND >= Goal) && (Temp <= Goal + SETTLE_BAND))
+  {
+    if (!InBandSince)
+    {
+      if (!WarmupReached)
+        Log("Warm-up reached goal in %lu s\n", (unsigned long)((MyMillis() - WarmupStart) / 1000));
+      WarmupReached = true;
+      InBandSince = MyMillis();
+    }
+    else if (MyMillis() - InBandSince >= SETTLE_HOLD)
+    {
+      Log("Warm-up settled in %lu s, overshoot %d (x10 C)\n", (unsigned long)((InBandSince - WarmupStart) / 1000),
+          (WarmupPeak > Goal) ? WarmupPeak - Goal : 0);
+      WarmupStart = 0;
+    }
+  }
+  else
+    InBandSince = 0;
+}
+
+// Runs the relay tests and the warm-up watch once per sensor reading
+void CheckAutotune(void)
+{
+  if (MyMillis() < Time2CheckAutotune)
+    return;
+  Time2CheckAutotune = MyMillis() + CheckSensorInterval;
+
+  if (!MainScreen.Activated)
+  {
+    if (Tune.Loop != TUNE_IDLE)
+      Autotune_Stop(PSTR("Tune stopped"));                        // Deactivated by the user
+    WarmupStart = 0;
+    return;
+  }
+
+  if (Tune.Loop == TUNE_IDLE)
+  {
+    Warmup_Check();
+    return;
+  }
+
+  if (MainScreen.SolutionTemp > MainScreen.SolutionGoal + 10)    // OVER TEMP - give the PIDs their loops back
+  {
+    Autotune_Stop(PSTR("Tune over temp"));
+    return;
+  }
+  if (MyMillis() - Tune.Start > ((Tune.Loop == TUNE_HEATER) ? TUNE_HEATER_TIMEOUT : TUNE_LOAD_TIMEOUT))
+  {
+    Autotune_Stop(PSTR("Tune timed out"));
+    return;
+  }
+
+  Relay_Step((Tune.Loop == TUNE_HEATER) ? MainScreen.PlateTemp : MainScreen.SolutionTemp);
+
+  if (Tune.Rises >= TUNE_CYCLES + 2)
+  {
+    if (!Relay_Finish())
+    {
+      Autotune_Stop(PSTR("Tune failed"));
+      return;
+    }
+    if (Tune.Loop == TUNE_HEATER)
+    {
+      PID_ClearAll();
+      Relay_Start(TUNE_LOAD);
+    }
+    else
+    {
+      SavePIDGains();
+      Autotune_Stop(PSTR("Tuned"));
+      Warmup_Start();                                             // See how the new gains do
+    }
+  }
+}
@@ -0,0 +1,38 @@
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>                   // Find integer types like "uint8_t"
+#include <stdbool.h>                  // Find type "bool"
+
+// Loop being tuned
+#define TUNE_IDLE                  0
+#define TUNE_HEATER                1  // Plate temperature by heater PWM
+#define TUNE_LOAD                  2  // Solution temperature by plate goal
+
+#define TUNE_HYST                  5  // x10 degrees - relay hysteresis, above the noise of the filtered probes
+#define TUNE_CYCLES                4  // Oscillations averaged per loop, after the first one is thrown away
+#define TUNE_HEATER_SPAN         100  // x10 degrees - plate oscillates around this much above the solution goal
+#define TUNE_LOAD_BELOW           20  // x10 degrees - solution oscillates around this much below its goal, clear of OVER TEMP
+#define TUNE_HEATER_TIMEOUT  2700000  // in mS - 45 minutes
+#define TUNE_LOAD_TIMEOUT   21600000  // in mS - 6 hours, a full bag cycles slowly
+
+// A warm-up has settled once the solution stays this close to the goal for this long
+#define SETTLE_BAND                5  // x10 degrees
+#define SETTLE_HOLD           600000  // in mS
+
+void Autotune_Start(void);
+void Autotune_Cancel(void);
+uint8_t Autotune_Loop(void);
+const char *Autotune_Status(void);
+void Warmup_Start(void);
+void CheckAutotune(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,275 @@
+// Touch screen calibration, a step at a time from CheckCalibrate() in MainLoop(), so the heater and the rest of the
+// firmware carry on while the dots are being tapped.
+//
+// CAL_POINTS dots are shown one after the other.  While the finger is on a dot up to CAL_SAMPLES raw readings of
+// REG_TOUCH_DIRECT_XY are averaged, and the dot is done when the finger comes off.  The touch transform
+//     x = (A * tx + B * ty + C) / 65536        y = (D * tx + E * ty + F) / 65536
+// is then the least squares fit over all of the dots, worked out in 64 bit integers from sums about the mean of the
+// raw readings, so any number of dots from three up can be used and a wobbly tap is averaged out rather than built
+// into the matrix.  How far the fit misses the dots is logged, and a fit which misses any of them by more than
+// CAL_MAX_ERROR pixels is thrown away and the dots are shown again.
+//
+// The screens are not drawn and touches are not acted on while calibrating (see CheckScreen() and CheckTouch()).
+// A recalibration left alone for CAL_TIMEOUT is abandoned with the old matrix still in place.  The one at startup
+// with no matrix to go back to is Required, and waits for as long as it takes.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include "Eve2_81x.h"              // Matrix Orbital Eve2 Driver
+#include "Arduino_AL.h"            // include the hardware specific abstraction layer header for the specific hardware in use.
+#include "MatrixEve2Conf.h"        // Header for EVE2 Display configuration settings
+#include "screens.h"               // Screen_Refresh()
+#include "calibrate.h"             // Header for this file
+
+#define CAL_COEF_MAX  ((int64_t)1 << 46)   // Largest numerator which can still be multiplied by 65536 in 64 bits
+
+// Where the dots are, in % of the width and height of the display
+static const uint8_t CalPoints[CAL_POINTS][2] PROGMEM = {
+  { 15, 15 }, { 85, 15 }, { 85, 85 }, { 15, 85 }, { 50, 50 }
+};
+
+static bool     Active;
+static bool     Required;          // There is no matrix to go back to
+static uint8_t  Point;             // Dot being tapped
+static uint8_t  Samples;           // Raw readings summed for it so far
+static uint16_t SumX, SumY;
+static uint16_t TouchX[CAL_POINTS], TouchY[CAL_POINTS];   // Averaged raw readings of the dots
+static uint32_t Time2CheckCalibrate = 0;
+static uint32_t Deadline;          // MyMillis() at which a recalibration is abandoned
+
+// Screen position of dot i
+void Calibrate_Point(uint8_t i, uint16_t *x, uint16_t *y)
+{
+  *x = (((uint32_t)DWIDTH * pgm_read_byte(&CalPoints[i][0])) / 100) + PIXHOFFSET;
+  *y = (((uint32_t)DHEIGHT * pgm_read_byte(&CalPoints[i][1])) / 100) + PIXVOFFSET;
+}
+
+// Show the dot being tapped
+static void Calibrate_Draw(void)
+{
+  uint16_t x, y;
+  char Num[2];
+
+  Calibrate_Point(Point, &x, &y);
+  Blob_CalHeader();                                             // DL start, clear and red point setup
+  Send_CMD(VERTEX2F((uint32_t)x * 16, (uint32_t)y * 16));
+  Blob_CalPointEnd();                                           // End points and switch to white text
+  Send_CMD(CMD_TEXT);                                           // Text command set up here, but the
+  Send_CMD(((uint32_t)(((DHEIGHT * 3) / 10) + PIXVOFFSET) << 16) | ((DWIDTH / 2) + PIXHOFFSET)); // string itself is prepacked in flash
+  Send_CMD(((uint32_t)OPT_CENTER << 16) | 27);
+  Blob_CalTitle();                                              // "Calibrating"
+  Send_CMD(CMD_TEXT);                                           // Below the middle dot
+  Send_CMD(((uint32_t)(((DHEIGHT * 7) / 10) + PIXVOFFSET) << 16) | ((DWIDTH / 2) + PIXHOFFSET));
+  Send_CMD(((uint32_t)OPT_CENTER << 16) | 27);
+  Blob_CalHint();                                               // "Please tap the dots"
+  Num[0] = '1' + Point;                                         // null terminated string of one character
+  Num[1] = 0;
+  Cmd_Text(x, y, 27, OPT_CENTER, Num);
+  Blob_FrameEnd();                                              // DISPLAY() and swap
+  UpdateFIFO();                                                 // Trigger the CoProcessor to start processing commands out of the FIFO
+}
+
+// Num / Den rounded to the nearest.  Den is positive.
+static int64_t Calibrate_Div(int64_t Num, int64_t Den)
+{
+  return ((Num < 0) ? (Num - (Den / 2)) : (Num + (Den / 2))) / Den;
+}
+
+// Num / Den in 16.16 fixed point.  Both are scaled down together as far as Num needs to be.  False if the result
+// does not fit, which is what points very nearly in a line come to.
+static bool Calibrate_Ratio(int64_t Num, int64_t Den, int32_t *Result)
+{
+  int64_t q;
+
+  while ((Num >= CAL_COEF_MAX) || (Num <= -CAL_COEF_MAX))
+  {
+    Num /= 2;
+    Den /= 2;
+  }
+  if (Den <= 0)
+    return false;
+  q = Calibrate_Div(Num * 65536, Den);
+  if ((q > INT32_MAX) || (q < INT32_MIN))
+    return false;
+  *Result = q;
+  return true;
+}
+
+// Least squares fit of Screen = (Coef[0] * tx + Coef[1] * ty + Coef[2]) / 65536 over the dots.  The sums about the
+// mean are all CAL_POINTS squared times what they would be, which cancels out.  False if the dots were tapped in a
+// line, or as good as.
+static bool Calibrate_Fit(const uint16_t *Screen, int32_t *Coef)
+{
+  int64_t Sx = 0, Sy = 0, Sd = 0, Sxx = 0, Syy = 0, Sxy = 0, Sxd = 0, Syd = 0;
+  int64_t Det;
+  uint8_t i;
+
+  for (i = 0; i < CAL_POINTS; i++)
+  {
+    Sx += TouchX[i];
+    Sy += TouchY[i];
+    Sd += Screen[i];
+    Sxx += (int32_t)TouchX[i] * TouchX[i];
+    Syy += (int32_t)TouchY[i] * TouchY[i];
+    Sxy += (int32_t)TouchX[i] * TouchY[i];
+    Sxd += (int32_t)TouchX[i] * Screen[i];
+    Syd += (int32_t)TouchY[i] * Screen[i];
+  }
+  Sxx = (CAL_POINTS * Sxx) - (Sx * Sx);                         // About the mean
+  Syy = (CAL_POINTS * Syy) - (Sy * Sy);
+  Sxy = (CAL_POINTS * Sxy) - (Sx * Sy);
+  Sxd = (CAL_POINTS * Sxd) - (Sx * Sd);
+  Syd = (CAL_POINTS * Syd) - (Sy * Sd);
+
+  Det = (Sxx * Syy) - (Sxy * Sxy);                              // Zero when the dots are in a line
+  if (!Calibrate_Ratio((Sxd * Syy) - (Syd * Sxy), Det, &Coef[0]) ||
+      !Calibrate_Ratio((Syd * Sxx) - (Sxd * Sxy), Det, &Coef[1]))
+    return false;
+  Coef[2] = Calibrate_Div((Sd * 65536) - (Sx * Coef[0]) - (Sy * Coef[1]), CAL_POINTS);  // Through the mean
+  return true;
+}
+
+// Square root of n, rounded down
+static uint16_t Calibrate_Sqrt(uint32_t n)
+{
+  uint16_t r = 0, b;
+
+  for (b = 0x8000; b; b >>= 1)
+    if ((uint32_t)(r | b) * (r | b) <= n)
+      r |= b;
+  return r;
+}
+
+// How far, in 1/16 pixels, the transform puts raw reading i from where Screen says it should be (up to 512 pixels)
+static int16_t Calibrate_Miss(const int32_t *Coef, uint8_t i, uint16_t Screen)
+{
+  int64_t Miss = Calibrate_Div(((int64_t)Coef[0] * TouchX[i]) + ((int64_t)Coef[1] * TouchY[i]) + Coef[2], 4096) -
+                 (Screen * 16);
+
+  return (Miss > 0x1FFF) ? 0x1FFF : (Miss < -0x1FFF) ? -0x1FFF : Miss;
+}
+
+// Fit the transform to the dots tapped and write it to the Eve.  False, leaving the Eve alone, if it is no good.
+static bool Calibrate_Finish(void)
+{
+  uint16_t DisplayX[CAL_POINTS], DisplayY[CAL_POINTS];
+  int32_t TransMatrix[6];
+  EveRegOp Ops[6];
+  uint32_t Sum = 0, Worst = 0, Err;
+  int16_t dx, dy;
+  uint8_t i;
+
+  for (i = 0; i < CAL_POINTS; i++)
+    Calibrate_Point(i, &DisplayX[i], &DisplayY[i]);
+  if (!Calibrate_Fit(DisplayX, &TransMatrix[0]) || !Calibrate_Fit(DisplayY, &TransMatrix[3]))
+  {
+    Log("Calibration: dots in a line\n");
+    return false;
+  }
+
+  for (i = 0; i < CAL_POINTS; i++)
+  {
+    dx = Calibrate_Miss(&TransMatrix[0], i, DisplayX[i]);
+    dy = Calibrate_Miss(&TransMatrix[3], i, DisplayY[i]);
+    Err = ((int32_t)dx * dx) + ((int32_t)dy * dy);
+    Sum += Err;
+    if (Err > Worst)
+      Worst = Err;
+  }
+  Err = Calibrate_Sqrt(Sum / CAL_POINTS);                       // RMS, 1/16 pixels
+  Worst = Calibrate_Sqrt(Worst);
+  Log("Calibration: rms %u.%u max %u.%u px\n", (unsigned)(Err / 16), (unsigned)(((Err % 16) * 10) / 16),
+      (unsigned)(Worst / 16), (unsigned)(((Worst % 16) * 10) / 16));
+  if (Worst > (CAL_MAX_ERROR * 16))
+    return false;
+
+  for (i = 0; i < 6; i++)
+  {
+    Ops[i].Address = REG_TOUCH_TRANSFORM_A + RAM_REG + (i * 4);                 // The six Eve config registers are
+    Ops[i].Value = TransMatrix[i];                                              // neighbours, so this is one frame
+    Ops[i].Size = 4;
+    Ops[i].Write = true;
+  }
+  Eve_RunBatch(Ops, 6);
+  return true;
+}
+
+static void Calibrate_End(void)
+{
+  Active = false;
+  Cmd_SetRotate(1);                                             // Rotate the display back
+  UpdateFIFO();
+  Screen_Refresh();                                             // and have CheckScreen() draw the screen again
+}
+
+// Show the first dot.  Required when there is no calibration to go back to.
+void Calibrate_Start(bool IsRequired)
+{
+  Active = true;
+  Required = IsRequired;
+  Point = 0;
+  Samples = 0;
+  SumX = SumY = 0;
+  Deadline = MyMillis() + CAL_TIMEOUT;
+  Time2CheckCalibrate = MyMillis() + CAL_POLL;
+  Cmd_SetRotate(0);                                             // Rotate the display to normal orientation to do the calibration
+  Calibrate_Draw();
+  Log("Calibrating\n");
+}
+
+bool Calibrate_Active(void)
+{
+  return Active;
+}
+
+// Take a reading of the touch screen and move on a dot when the finger comes off
+void CheckCalibrate(void)
+{
+  uint32_t Touch;
+
+  if (!Active || (MyMillis() < Time2CheckCalibrate))
+    return;
+  Time2CheckCalibrate = MyMillis() + CAL_POLL;
+
+  if (!Required && (MyMillis() >= Deadline))
+  {
+    Log("Calibration abandoned\n");
+    Calibrate_End();
+    return;
+  }
+
+  Touch = rd32(REG_TOUCH_DIRECT_XY + RAM_REG);
+  if (!(Touch & 0x80000000))                                    // Finger on
+  {
+    if (Samples < CAL_SAMPLES)
+    {
+      SumX += (Touch >> 16) & 0x03FF;                           // Raw touchscreen X coordinate
+      SumY += Touch & 0x03FF;                                   // Raw touchscreen Y coordinate
+      Samples++;
+    }
+    return;
+  }
+  if (!Samples)                                                 // Still waiting for the finger
+    return;
+
+  TouchX[Point] = (SumX + (Samples / 2)) / Samples;             // Finger off - this dot is done
+  TouchY[Point] = (SumY + (Samples / 2)) / Samples;
+  Samples = 0;
+  SumX = SumY = 0;
+  Deadline = MyMillis() + CAL_TIMEOUT;
+
+  if (++Point < CAL_POINTS)
+  {
+    Calibrate_Draw();
+    return;
+  }
+
+  if (!Calibrate_Finish())
+  {
+    Point = 0;                                                  // Tap them all again
+    Calibrate_Draw();
+    return;
+  }
+  SaveTouchMatrix();
+  Calibrate_End();
+}
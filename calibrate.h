@@ -0,0 +1,26 @@
+#ifndef CALIBRATE_H
+#define CALIBRATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>                   // Find integer types like "uint8_t"
+#include <stdbool.h>                  // Find type "bool"
+
+#define CAL_POINTS                 5  // Dots tapped - the fit is least squares, so any number from 3 up will do
+#define CAL_SAMPLES                8  // Most raw readings averaged while the finger is on a dot
+#define CAL_POLL                  20  // in mS - between readings of the touch screen
+#define CAL_TIMEOUT            30000  // in mS - a recalibration with no tap for this long is abandoned
+#define CAL_MAX_ERROR              8  // in pixels - a fit which misses any dot by more is thrown away
+
+void Calibrate_Start(bool IsRequired);
+bool Calibrate_Active(void);
+void Calibrate_Point(uint8_t i, uint16_t *x, uint16_t *y);
+void CheckCalibrate(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,117 @@
+// Estimate of the temperature of the solution inside the bag.
+//
+// The solution probe is taped to the bag, so what it reads is the bag's skin, which trails the solution inside by
+// a minute or more while it warms.  A two node model of the bag runs alongside:
+//     dCore/dt = (Plate - Core) / EST_TAU_CORE - (Core - EST_AMBIENT) / EST_TAU_LOSS
+//     dSkin/dt = (Core - Skin) / EST_TAU_SKIN
+// driven by the plate probe, and a Kalman filter corrects it with each solution probe reading (of the skin).  The
+// core temperature and its rate of change are what the load PID, READY and the time to READY go by once the filter
+// has settled (process.c).
+//
+// It is all integer: temperatures are x10 degrees in 24.8 fixed point, the model's coefficients and the Kalman
+// gains are 16.16, and the products are taken in 64 bits.  The readings go in raw, not through the 5 sample filter
+// of CheckSensors(), which would only add lag of its own.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include "estimate.h"              // Header for this file
+
+#define Q8(x)   ((int32_t)(x) << 8)
+
+int32_t  EstCore, EstSkin;         // x10 degrees, 24.8
+int32_t  EstPlate;                 // The last plate reading, 24.8
+int32_t  EstP00, EstP01, EstP11;   // Covariance, (x10 degrees)^2 24.8
+bool     EstStarted = false;
+uint32_t EstReadings = 0;
+uint32_t EstErrorSq = 0;
+
+// Start again from the next reading
+void Estimate_Reset(void)
+{
+  EstStarted = false;
+}
+
+// a * b for a in 16.16
+static int32_t Est_Mul(int32_t a, int32_t b)
+{
+  return (int32_t)(((int64_t)a * b) >> 16);
+}
+
+// Ms / Tau seconds in 16.16
+static int32_t Est_Coef(uint32_t Ms, uint16_t Tau)
+{
+  return (int32_t)(((int64_t)Ms << 16) / (Tau * 1000L));
+}
+
+// Add a pair of readings (x2, straight from the probes) taken Ms after the last
+void Estimate_Update(int16_t PlateRaw, int16_t SolutionRaw, uint32_t Ms)
+{
+  int32_t Reading = Q8(SolutionRaw * 5);                           // x2 to x10
+  int32_t aC, aL, aS, f00, f11;
+  int32_t r00, r01, r10, r11;
+  int32_t Err, Inn, K0, K1;
+
+  EstPlate = Q8(PlateRaw * 5);
+  if (!EstStarted)
+  {
+    EstCore = EstSkin = Reading;
+    EstP00 = Q8(EST_START_VAR);
+    EstP01 = 0;
+    EstP11 = Q8(EST_NOISE_READING);
+    EstStarted = true;
+    return;
+  }
+  if (Ms > EST_MAX_STEP)
+    Ms = EST_MAX_STEP;
+
+  // Predict.  F = | 1 - aC - aL       0 |
+  //               |      aS      1 - aS |
+  aC = Est_Coef(Ms, EST_TAU_CORE);
+  aL = Est_Coef(Ms, EST_TAU_LOSS);
+  aS = Est_Coef(Ms, EST_TAU_SKIN);
+  f00 = 65536L - aC - aL;
+  f11 = 65536L - aS;
+  EstSkin += Est_Mul(aS, EstCore - EstSkin);                       // From the core as it was
+  EstCore += Est_Mul(aC, EstPlate - EstCore) - Est_Mul(aL, EstCore - Q8(EST_AMBIENT));
+
+  r00 = Est_Mul(f00, EstP00);                                      // F P
+  r01 = Est_Mul(f00, EstP01);
+  r10 = Est_Mul(aS, EstP00) + Est_Mul(f11, EstP01);
+  r11 = Est_Mul(aS, EstP01) + Est_Mul(f11, EstP11);
+  EstP00 = Est_Mul(f00, r00) + ((Q8(EST_NOISE_CORE) * (int32_t)Ms) / 60000L);   // F P F' + Q
+  EstP01 = Est_Mul(aS, r00) + Est_Mul(f11, r01);
+  EstP11 = Est_Mul(aS, r10) + Est_Mul(f11, r11) + ((Q8(EST_NOISE_SKIN) * (int32_t)Ms) / 60000L);
+
+  // Correct with the reading of the skin
+  Err = Reading - EstSkin;
+  Inn = EstP11 + Q8(EST_NOISE_READING);
+  K0 = (int32_t)(((int64_t)EstP01 << 16) / Inn);
+  K1 = (int32_t)(((int64_t)EstP11 << 16) / Inn);
+  EstCore += Est_Mul(K0, Err);
+  EstSkin += Est_Mul(K1, Err);
+  EstP00 -= Est_Mul(K0, EstP01);
+  EstP01 -= Est_Mul(K0, EstP11);
+  EstP11 -= Est_Mul(K1, EstP11);
+
+  Err = (Err + 128) >> 8;
+  EstErrorSq += Err * Err;
+  EstReadings++;
+}
+
+// The filter has settled enough for the estimate to be used
+bool Estimate_Valid(void)
+{
+  return EstStarted && (EstP00 < Q8(EST_VALID_VAR));
+}
+
+// Solution temperature in the bag, x10 degrees
+uint16_t Estimate_Core(void)
+{
+  return (EstCore > 0) ? (uint16_t)((EstCore + 128) >> 8) : 0;
+}
+
+// Its rate of change by the model, x10 degrees per minute
+int16_t Estimate_Rate(void)
+{
+  return (((EstPlate - EstCore) * 60) / EST_TAU_CORE - ((EstCore - Q8(EST_AMBIENT)) * 60) / EST_TAU_LOSS) / 256;
+}
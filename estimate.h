@@ -0,0 +1,39 @@
+#ifndef ESTIMATE_H
+#define ESTIMATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>                   // Find integer types like "uint8_t"
+#include <stdbool.h>                  // Find type "bool"
+
+// Thermal model of the bag - round figures for a litre bag on this plate, to be fitted to the unit's own logs
+#define EST_TAU_CORE            1400  // in S - time constant of the solution heading for the plate temperature
+#define EST_TAU_LOSS            4200  // in S - and for the room temperature
+#define EST_AMBIENT              220  // x10 degrees - the room
+#define EST_TAU_SKIN              68  // in S - the probe on the bag's skin behind the solution, probe lag included
+
+// Kalman filter noise, variances in (x10 degrees)^2
+#define EST_NOISE_READING          4  // Of a solution probe reading - mostly its 0.5 degree steps
+#define EST_NOISE_CORE             4  // Per minute - how far the solution may stray from the model
+#define EST_NOISE_SKIN             1  // Per minute - and the skin
+#define EST_START_VAR            400  // Of the first estimate, which starts at the first reading (2 degrees)
+#define EST_VALID_VAR             16  // The estimate is used once its variance is below this (0.4 degrees)
+#define EST_MAX_STEP           30000  // in mS - longest step the model takes at once
+
+void Estimate_Reset(void);
+void Estimate_Update(int16_t PlateRaw, int16_t SolutionRaw, uint32_t Ms);
+bool Estimate_Valid(void);
+uint16_t Estimate_Core(void);
+int16_t Estimate_Rate(void);
+
+extern int32_t  EstCore, EstSkin;     // x10 degrees in 24.8 fixed point
+extern uint32_t EstReadings;          // Readings taken in, for checking the model against logs
+extern uint32_t EstErrorSq;           // Sum of the squared errors of the predicted readings, (x10 degrees)^2
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,170 @@
+// Time to READY estimator.
+//
+// Near the goal the warm-up of the solution looks like a first order approach to some final temperature, so with
+// x the solution temperature relative to the goal and y its rise until the next reading,
+//     y = a + b * x
+// with b < 0.  a and b are estimated by recursive least squares with forgetting from every sensor reading.  The
+// solution is headed for x = -a/b and closes a fraction -b of its distance to it every reading, which gives the
+// number of readings left until READY.  The band is the same calculation with the final temperature moved by one
+// standard deviation either way (from the RLS covariance and the residual of the fit).  Early in a warm-up, while
+// the solution is still rising in a straight line, the estimate is just that line continued.
+//
+// An estimate is kept every ETA_CHECKPOINT readings and when READY comes, the error of each is logged.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include <stdio.h>                 // sprintf()
+#include <math.h>                  // log() sqrt()
+#include "Arduino_AL.h"            // Log() MyMillis()
+#include "process.h"               // CheckSensorInterval
+#include "eta.h"                   // Header for this file
+
+float    EtaA, EtaB;               // Model parameters
+float    EtaP00, EtaP01, EtaP11;   // RLS covariance
+float    EtaVar;                   // Running variance of the prediction error
+float    EtaLastX;
+uint16_t EtaGoal;
+uint16_t EtaSamples = 0;
+uint16_t EtaMin = ETA_UNKNOWN;     // Estimate and band in minutes
+uint16_t EtaLo = ETA_UNKNOWN, EtaHi = ETA_UNKNOWN;
+uint32_t EtaMade[ETA_CHECKPOINTS]; // MyMillis() when an estimate was kept
+uint32_t EtaAt[ETA_CHECKPOINTS];   // The MyMillis() it predicted for READY
+uint8_t  EtaKept = 0;
+
+void Eta_Reset(void)
+{
+  EtaA = EtaB = 0;
+  EtaP00 = EtaP11 = 1000;
+  EtaP01 = 0;
+  EtaVar = 0;
+  EtaSamples = 0;
+  EtaKept = 0;
+  EtaMin = EtaLo = EtaHi = ETA_UNKNOWN;
+}
+
+// Seconds until x reaches Target on the way to Final, -1 if it never does
+static float Eta_Seconds(float x, float Final, float Target)
+{
+  float n;
+
+  if (Final <= Target)
+    return -1;
+  n = log((Final - Target) / (Final - x)) / log(1 + EtaB);       // Readings
+  return ((n * CheckSensorInterval) / 1000.0);
+}
+
+// Seconds to minutes for the display, ETA_UNKNOWN for too far or never
+static uint16_t Eta_Minutes(float Seconds)
+{
+  if ((Seconds < 0) || (Seconds > 999 * 60.0))
+    return ETA_UNKNOWN;
+  return (uint16_t)((Seconds + 30) / 60);
+}
+
+// Log the error of the kept estimates against the actual time READY came
+static void Eta_Score(void)
+{
+  uint32_t Now = MyMillis();
+  uint8_t i;
+
+  for (i = 0; i < EtaKept; i++)
+    Log("ETA made %lu s ahead: error %ld s\n", (unsigned long)((Now - EtaMade[i]) / 1000),
+        ((long)EtaAt[i] - (long)Now) / 1000);
+}
+
+// Add a sensor reading - filtered solution temperature and goal, x10 degrees
+void Eta_Update(float Solution, uint16_t Goal)
+{
+  float x = Solution - Goal;
+  float Target = -ETA_READY_BELOW;
+  float k0, k1, Den, e, p0, p1;
+  float Final, Var, g0, g1;
+  float Seconds;
+  uint8_t i;
+
+  if (Goal != EtaGoal)                                           // The old fit means nothing for a new goal
+  {
+    Eta_Reset();
+    EtaGoal = Goal;
+  }
+
+  if (x >= Target)                                               // READY
+  {
+    if (EtaKept)
+      Eta_Score();
+    Eta_Reset();
+    EtaLastX = x;
+    return;
+  }
+
+  if (EtaSamples++)
+  {
+    // RLS step with regressor (1, EtaLastX) and the rise since then as the output
+    p0 = EtaP00 + (EtaP01 * EtaLastX);                           // P * phi
+    p1 = EtaP01 + (EtaP11 * EtaLastX);
+    Den = ETA_FORGET + p0 + (EtaLastX * p1);
+    k0 = p0 / Den;
+    k1 = p1 / Den;
+    e = (x - EtaLastX) - (EtaA + (EtaB * EtaLastX));
+    EtaA += k0 * e;
+    EtaB += k1 * e;
+    EtaP00 = (EtaP00 - (k0 * p0)) / ETA_FORGET;
+    EtaP01 = (EtaP01 - (k0 * p1)) / ETA_FORGET;
+    EtaP11 = (EtaP11 - (k1 * p1)) / ETA_FORGET;
+    EtaVar = (EtaVar * ETA_FORGET) + (e * e * (1 - ETA_FORGET));
+  }
+  EtaLastX = x;
+
+  EtaMin = EtaLo = EtaHi = ETA_UNKNOWN;
+  if (EtaSamples < ETA_MIN_SAMPLES)
+    return;
+
+  if ((EtaB < 0) && (EtaB > -1))
+  {
+    // Final temperature and its standard deviation (delta method on -a/b)
+    Final = -EtaA / EtaB;
+    g0 = -1 / EtaB;
+    g1 = EtaA / (EtaB * EtaB);
+    Var = EtaVar * ((g0 * g0 * EtaP00) + (2 * g0 * g1 * EtaP01) + (g1 * g1 * EtaP11));
+    Var = sqrt(Var);
+
+    Seconds = Eta_Seconds(x, Final, Target);
+    EtaLo = Eta_Minutes(Eta_Seconds(x, Final + Var, Target));
+    EtaHi = Eta_Minutes(Eta_Seconds(x, Final - Var, Target));
+  }
+  else if (EtaA > 0)                                              // No sign of slowing down yet - straight line
+  {
+    Seconds = ((Target - x) / EtaA) * (CheckSensorInterval / 1000.0);
+    EtaLo = EtaHi = Eta_Minutes(Seconds);
+  }
+  else
+    return;
+  EtaMin = Eta_Minutes(Seconds);
+
+  if ((EtaMin != ETA_UNKNOWN) && !((EtaSamples - ETA_MIN_SAMPLES) % ETA_CHECKPOINT))
+  {
+    if (EtaKept == ETA_CHECKPOINTS)                              // Keep the latest ones
+    {
+      for (i = 1; i < ETA_CHECKPOINTS; i++)
+      {
+        EtaMade[i - 1] = EtaMade[i];
+        EtaAt[i - 1] = EtaAt[i];
+      }
+      EtaKept--;
+    }
+    EtaMade[EtaKept] = MyMillis();
+    EtaAt[EtaKept++] = MyMillis() + (uint32_t)(Seconds * 1000);
+  }
+}
+
+// Estimate as text for the main screen, e.g. "12m 9-16".  Returns false if there is no estimate.
+bool Eta_Text(char *Buf)
+{
+  if (EtaMin == ETA_UNKNOWN)
+    return false;
+  if (EtaHi == ETA_UNKNOWN)
+    sprintf_P(Buf, PSTR("%um %u+"), EtaMin, EtaLo);
+  else
+    sprintf_P(Buf, PSTR("%um %u-%u"), EtaMin, EtaLo, EtaHi);
+  return true;
+}
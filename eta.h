@@ -0,0 +1,26 @@
+#ifndef ETA_H
+#define ETA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>                   // Find integer types like "uint8_t"
+#include <stdbool.h>                  // Find type "bool"
+
+#define ETA_FORGET             0.995  // Weight of the past per sensor reading - about 17 minutes of memory
+#define ETA_MIN_SAMPLES           24  // Readings before the first estimate (2 minutes)
+#define ETA_READY_BELOW            5  // x10 degrees - READY is declared this far below the goal (CheckSensors())
+#define ETA_CHECKPOINT            60  // Readings between the estimates kept for scoring at READY (5 minutes)
+#define ETA_CHECKPOINTS            4
+#define ETA_UNKNOWN           0xFFFF
+
+void Eta_Reset(void);
+void Eta_Update(float Solution, uint16_t Goal);
+bool Eta_Text(char *Buf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,218 @@
+// Temperature history for the History screen.
+//
+// Samples of the plate and solution temperatures are kept in a small byte ring.  Temperatures move slowly, so
+// rather than 4 bytes per sample the ring holds the change since the previous sample, zigzag folded so small
+// negative changes are small numbers too, as a varint (7 bits a byte, top bit set on all but the last byte).
+// A minute's change of under 6.4 degrees fits a byte, so a sample is normally 2 bytes.  The oldest sample is
+// kept whole in Base[] and the newest in Last[]; when the ring is full the oldest sample is folded into Base[]
+// to make room.
+//
+// The graph is a display list fragment of two LINE_STRIPs, built in RAM_G in one SPI burst whenever a sample
+// is added and put into every frame of the History screen with a 3 word CMD_APPEND.  Long histories are
+// decimated to HISTORY_POINTS vertices per trace, so the burst never gets bigger than HISTORY_DL_MAX bytes.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include "Eve2_81x.h"              // Matrix Orbital Eve2 Driver
+#include "Arduino_AL.h"            // include the hardware specific abstraction layer header for the specific hardware in use.
+#include "MatrixEve2Conf.h"        // Header for EVE2 Display configuration settings
+#include "history.h"               // Header for this file
+
+#define HISTORY_TRACES          2  // Plate and solution
+
+uint8_t  HistoryRing[HISTORY_BYTES];
+uint16_t HistoryHead = 0;          // Ring index of the first byte of the oldest delta
+uint16_t HistoryLen = 0;           // Bytes in use
+uint16_t HistoryCount = 0;         // Samples held, including the one in HistoryBase
+uint16_t HistoryBase[HISTORY_TRACES];   // Oldest sample
+uint16_t HistoryLast[HISTORY_TRACES];   // Newest sample
+bool     HistoryDirty = false;     // The graph in RAM_G is out of date
+uint8_t  HistoryCopy = 0;          // Which of the two RAM_G copies holds the current graph
+uint16_t HistoryDLSize = 0;        // Bytes of display list in that copy
+
+static const uint32_t TraceColor[HISTORY_TRACES] = { COLOR_RGB(0xFF, 0xAA, 0x55), COLOR_RGB(0x55, 0xCC, 0xFF) };
+
+// Append the zigzag varint of a delta to Buf, returning the number of bytes used (1 to 3)
+static uint8_t Varint_Put(uint8_t *Buf, int16_t Delta)
+{
+  uint16_t zz = ((uint16_t)Delta << 1) ^ (uint16_t)(Delta >> 15);   // 0,-1,1,-2,2... become 0,1,2,3,4...
+  uint8_t n = 0;
+
+  while (zz >= 0x80)
+  {
+    Buf[n++] = (zz & 0x7F) | 0x80;
+    zz >>= 7;
+  }
+  Buf[n++] = zz;
+  return (n);
+}
+
+// Read one delta from the ring at *Pos, moving *Pos past it
+static int16_t Varint_Get(uint16_t *Pos)
+{
+  uint16_t zz = 0;
+  uint8_t Shift = 0;
+  uint8_t b;
+
+  do {
+    b = HistoryRing[*Pos];
+    *Pos = (*Pos + 1) % HISTORY_BYTES;
+    zz |= (uint16_t)(b & 0x7F) << Shift;
+    Shift += 7;
+  } while (b & 0x80);
+
+  return (int16_t)((zz >> 1) ^ (0 - (zz & 1)));
+}
+
+// Fold the oldest delta into the base sample, freeing its bytes
+static void History_Drop(void)
+{
+  uint16_t Pos = HistoryHead;
+  uint8_t i;
+
+  for (i = 0; i < HISTORY_TRACES; i++)
+    HistoryBase[i] += Varint_Get(&Pos);
+
+  HistoryLen -= (Pos + HISTORY_BYTES - HistoryHead) % HISTORY_BYTES;
+  HistoryHead = Pos;
+  HistoryCount--;
+}
+
+void History_Clear(void)
+{
+  HistoryHead = 0;
+  HistoryLen = 0;
+  HistoryCount = 0;
+  HistoryDLSize = 0;
+  HistoryDirty = false;
+}
+
+// Add a sample - temperatures x10 as in MainScreen
+void History_Add(uint16_t Plate, uint16_t Solution)
+{
+  uint16_t Val[HISTORY_TRACES];
+  uint8_t Buf[3 * HISTORY_TRACES];
+  uint8_t n = 0;
+  uint8_t i;
+
+  Val[0] = Plate;
+  Val[1] = Solution;
+  HistoryDirty = true;
+
+  if (!HistoryCount)
+  {
+    for (i = 0; i < HISTORY_TRACES; i++)
+      HistoryBase[i] = HistoryLast[i] = Val[i];
+    HistoryCount = 1;
+    return;
+  }
+
+  for (i = 0; i < HISTORY_TRACES; i++)
+  {
+    n += Varint_Put(&Buf[n], (int16_t)(Val[i] - HistoryLast[i]));
+    HistoryLast[i] = Val[i];
+  }
+
+  while (HistoryLen + n > HISTORY_BYTES)
+    History_Drop();
+
+  for (i = 0; i < n; i++)
+    HistoryRing[(HistoryHead + HistoryLen++) % HISTORY_BYTES] = Buf[i];
+  HistoryCount++;
+}
+
+uint16_t History_Count(void)
+{
+  return (HistoryCount);
+}
+
+// Send one display list word as part of an ongoing RAM_G write
+static void History_Word(uint32_t Word)
+{
+  SPI_Write(Word);
+  SPI_Write(Word >> 8);
+  SPI_Write(Word >> 16);
+  SPI_Write(Word >> 24);
+}
+
+// Write the LINE_STRIP of one trace, returning the number of words written
+static uint16_t History_Trace(uint8_t Trace, uint16_t Step)
+{
+  uint16_t Pos = HistoryHead;
+  uint16_t Val[HISTORY_TRACES];
+  uint16_t Words = 0;
+  uint16_t i;
+  int32_t x, y;
+  uint8_t t;
+
+  for (t = 0; t < HISTORY_TRACES; t++)
+    Val[t] = HistoryBase[t];
+
+  History_Word(TraceColor[Trace]);
+  History_Word(BEGIN(LINE_STRIP));
+  Words += 2;
+
+  for (i = 0; i < HistoryCount; i++)
+  {
+    if (i)
+      for (t = 0; t < HISTORY_TRACES; t++)
+        Val[t] += Varint_Get(&Pos);
+
+    if ((i % Step) && (i != HistoryCount - 1))                    // Decimate, but always finish on the newest sample
+      continue;
+
+    y = Val[Trace];
+    if (y < HISTORY_VMIN) y = HISTORY_VMIN;
+    if (y > HISTORY_VMAX) y = HISTORY_VMAX;
+
+    // Coordinates in 1/16 pixel - oldest sample at the left edge, newest at the right
+    x = (HISTORY_X0 * 16L) + ((int32_t)i * (HISTORY_X1 - HISTORY_X0) * 16L) / (HistoryCount - 1);
+    y = ((HISTORY_YBOT + (VSIZE-DHEIGHT)) * 16L) - ((y - HISTORY_VMIN) * (HISTORY_YBOT - HISTORY_YTOP) * 16L) / (HISTORY_VMAX - HISTORY_VMIN);
+    History_Word(VERTEX2F(x, y));
+    Words++;
+  }
+
+  History_Word(END());
+  return (Words + 1);
+}
+
+// Rebuild the graph in the spare RAM_G copy in one burst
+static void History_Build(void)
+{
+  uint16_t Step;
+  uint16_t Words = 0;
+  uint8_t t;
+
+  HistoryDirty = false;
+  if (HistoryCount < 2)                                           // Takes two points to draw a line
+  {
+    HistoryDLSize = 0;
+    return;
+  }
+
+  Step = (HistoryCount - 1 + HISTORY_POINTS - 2) / (HISTORY_POINTS - 1);  // Every Step'th sample plus the newest fits HISTORY_POINTS
+  HistoryCopy ^= 1;
+  StartCoProTransfer(RAMG_HISTORY + (HistoryCopy * HISTORY_DL_MAX), false);
+  for (t = 0; t < HISTORY_TRACES; t++)
+    Words += History_Trace(t, Step);
+  SPI_Disable();
+  EVE_STAT(Bytes, Words * 4);
+
+  HistoryDLSize = Words * 4;
+}
+
+// Add the graph to the display list being built - part of the History screen overlay
+void History_Draw(void)
+{
+  uint32_t Append[3];
+
+  if (HistoryDirty)
+    History_Build();
+  if (!HistoryDLSize)
+    return;
+
+  Append[0] = CMD_APPEND;
+  Append[1] = RAMG_HISTORY + (HistoryCopy * HISTORY_DL_MAX);
+  Append[2] = HistoryDLSize;
+  Send_CMD_Words(Append, 3);
+}
@@ -0,0 +1,36 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>                   // Find integer types like "uint8_t"
+#include <stdbool.h>                  // Find type "bool"
+
+#define HISTORY_BYTES            320  // Size of the sample ring in bytes - about 2 bytes per sample (CheckHistoryInterval) once warmed up
+#define HISTORY_POINTS           120  // Most vertices drawn per trace, however much history there is
+
+// The graph is built in RAM_G as a display list fragment and appended to the History screen.  There are two
+// copies so that one can be rewritten while the coprocessor may still be appending the other.
+#define RAMG_HISTORY         0xF4000
+#define HISTORY_DL_MAX   (4 * (2 * (HISTORY_POINTS + 3)))    // Bytes per copy
+
+// Plot area of the History screen (also drawn in Blob_HistoryStatic) - scaled from 20 to 70 degrees
+#define HISTORY_X0                40
+#define HISTORY_X1               470
+#define HISTORY_YTOP              46  // Added to (VSIZE-DHEIGHT)
+#define HISTORY_YBOT             110
+#define HISTORY_VMIN             200  // x10 degrees
+#define HISTORY_VMAX             700
+
+void History_Clear(void);
+void History_Add(uint16_t Plate, uint16_t Solution);
+uint16_t History_Count(void);
+void History_Draw(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
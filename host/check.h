@@ -0,0 +1,42 @@
+// Assertions for the host unit tests (test_*.c).  A CHECK() which fails is reported with where it is and the test
+// carries on, so one run shows every failure; Check_Done() reports the count and gives the exit status.
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>                    // fprintf()
+
+static unsigned CheckCount, CheckFailed;
+
+#define CHECK(Cond)       Check_That((Cond), #Cond, __FILE__, __LINE__)
+#define CHECK_EQ(a, b)    Check_Eq((long)(a), (long)(b), #a " == " #b, __FILE__, __LINE__)
+
+static inline int Check_That(int Ok, const char *What, const char *File, int Line)
+{
+  CheckCount++;
+  if (!Ok)
+  {
+    CheckFailed++;
+    fprintf(stderr, "%s:%d: check failed: %s\n", File, Line, What);
+  }
+  return Ok;
+}
+
+static inline int Check_Eq(long a, long b, const char *What, const char *File, int Line)
+{
+  CheckCount++;
+  if (a != b)
+  {
+    CheckFailed++;
+    fprintf(stderr, "%s:%d: check failed: %s (%ld, %ld)\n", File, Line, What, a, b);
+  }
+  return (a == b);
+}
+
+static inline int Check_Done(const char *Name)
+{
+  fprintf(stderr, "%s: %u checks, %u failed\n", Name, CheckCount, CheckFailed);
+  return CheckFailed ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,189 @@
+// Host stand-in for the Eve - see fake_eve.h
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include <string.h>                // memset()
+#include "Eve2_81x.h"              // Memory map and register addresses
+#include "fake_eve.h"              // Header for this file
+
+uint8_t  FakeEveMem[FAKE_EVE_SIZE];
+uint32_t FakeEveTransactions = 0;
+uint32_t FakeEveBytes = 0;
+uint32_t FakeEveCmdNsPerByte = 0;
+uint32_t FakeEveCmdSum = 0;
+bool     FakeEveStandby = false;
+uint32_t FakeEveStandbyAccesses = 0;
+
+static bool     Selected = false;
+static uint8_t  Count;             // Bytes into the current transaction
+static uint32_t Address;
+static bool     Writing;
+static bool     CmdWritten;        // REG_CMD_WRITE was written in this transaction
+static uint8_t  First;             // First byte of the transaction - the host command if it is one
+static uint64_t CmdCredit;         // nS the coprocessor has had and not yet used
+
+#define TAPS           24          // Two calibrations of CAL_POINTS dots, a touch and a lift for each
+static uint32_t Taps[TAPS];        // Queued REG_TOUCH_DIRECT_XY values, each read once
+static uint8_t  TapCount;
+
+uint32_t FakeEve_rd32(uint32_t Add)
+{
+  return FakeEveMem[Add] | ((uint32_t)FakeEveMem[Add + 1] << 8) | ((uint32_t)FakeEveMem[Add + 2] << 16) |
+         ((uint32_t)FakeEveMem[Add + 3] << 24);
+}
+
+void FakeEve_wr32(uint32_t Add, uint32_t Value)
+{
+  FakeEveMem[Add] = Value;
+  FakeEveMem[Add + 1] = Value >> 8;
+  FakeEveMem[Add + 2] = Value >> 16;
+  FakeEveMem[Add + 3] = Value >> 24;
+}
+
+// FNV-1a, one byte at a time
+uint32_t FakeEve_Sum(uint32_t Sum, uint8_t Byte)
+{
+  return (Sum ^ Byte) * 16777619UL;
+}
+
+// The coprocessor takes up to Max bytes out of the FIFO, as far as REG_CMD_WRITE.  Returns how many it took.
+static uint32_t CmdTake(uint32_t Max)
+{
+  uint16_t Rd = FakeEve_rd32(REG_CMD_READ + RAM_REG) & (FT_CMD_FIFO_SIZE - 1);
+  uint16_t Wr = FakeEve_rd32(REG_CMD_WRITE + RAM_REG) & (FT_CMD_FIFO_SIZE - 1);
+  uint32_t Taken = 0;
+
+  while ((Rd != Wr) && (Taken < Max))
+  {
+    FakeEveCmdSum = FakeEve_Sum(FakeEveCmdSum, FakeEveMem[RAM_CMD + Rd]);
+    Rd = (Rd + 1) % FT_CMD_FIFO_SIZE;
+    Taken++;
+  }
+  FakeEveMem[REG_CMD_READ + RAM_REG] = Rd;
+  FakeEveMem[REG_CMD_READ + RAM_REG + 1] = Rd >> 8;
+  return Taken;
+}
+
+// Time passes for a coprocessor with a speed.  It does not save up time while it has nothing to do.
+void FakeEve_Run(uint64_t ns)
+{
+  uint32_t Taken;
+
+  if (!FakeEveCmdNsPerByte)
+    return;
+  CmdCredit += ns;
+  Taken = CmdTake(CmdCredit / FakeEveCmdNsPerByte);
+  CmdCredit = (Taken < (CmdCredit / FakeEveCmdNsPerByte)) ? 0 : (CmdCredit - ((uint64_t)Taken * FakeEveCmdNsPerByte));
+}
+
+// Power on state of the registers which are read back
+void FakeEve_Reset(void)
+{
+  memset(FakeEveMem, 0, sizeof(FakeEveMem));
+  FakeEveMem[REG_ID + RAM_REG] = 0x7C;
+  FakeEve_wr32(REG_TOUCH_RAW_XY + RAM_REG, 0xFFFFFFFF);            // Nobody touching
+  FakeEve_wr32(REG_TOUCH_SCREEN_XY + RAM_REG, 0x80008000);
+  FakeEve_wr32(REG_TOUCH_DIRECT_XY + RAM_REG, 0x80000000);        // Top bit set for no touch
+  Selected = false;
+  TapCount = 0;
+  CmdCredit = 0;
+  FakeEveCmdSum = 0;
+  FakeEveStandby = false;
+}
+
+// Put a finger down at x, y on something drawn with Tag
+void FakeEve_Touch(uint8_t Tag, uint16_t x, uint16_t y)
+{
+  FakeEve_wr32(REG_TOUCH_RAW_XY + RAM_REG, ((uint32_t)x << 16) | y);
+  FakeEve_wr32(REG_TOUCH_SCREEN_XY + RAM_REG, ((uint32_t)x << 16) | y);
+  FakeEve_wr32(REG_TOUCH_TAG_XY + RAM_REG, ((uint32_t)x << 16) | y);
+  FakeEveMem[REG_TOUCH_TAG + RAM_REG] = Tag;
+}
+
+void FakeEve_Release(void)
+{
+  FakeEve_wr32(REG_TOUCH_RAW_XY + RAM_REG, 0xFFFFFFFF);
+  FakeEve_wr32(REG_TOUCH_SCREEN_XY + RAM_REG, 0x80008000);
+  FakeEveMem[REG_TOUCH_TAG + RAM_REG] = 0;
+}
+
+// Queue a tap: the finger is on x, y for the next read of REG_TOUCH_DIRECT_XY and off for the one after.  Returns
+// false when the queue is full.
+bool FakeEve_Tap(uint16_t x, uint16_t y)
+{
+  if (TapCount > (TAPS - 2))
+    return false;
+  Taps[TapCount++] = ((uint32_t)x << 16) | y;
+  Taps[TapCount++] = 0x80000000;                                  // Top bit set for no touch
+  return true;
+}
+
+void FakeEve_Select(bool On)
+{
+  if (On && !Selected)
+  {
+    Count = 0;
+    Address = 0;
+    CmdWritten = false;
+    FakeEveTransactions++;
+  }
+  if (!On && Selected && CmdWritten && !FakeEveCmdNsPerByte)       // The coprocessor eats the whole FIFO at once
+    CmdTake(FT_CMD_FIFO_SIZE);
+  if (!On && Selected && (Count >= 3))
+  {
+    if ((Count == 3) && ((First == HCMD_STANDBY) || (First == HCMD_SLEEP) || (First == HCMD_PWRDOWN)))
+      FakeEveStandby = true;
+    else if (!Writing && !Address)                                 // HCMD_ACTIVE, or any read of address 0
+      FakeEveStandby = false;
+    else if (FakeEveStandby)
+      FakeEveStandbyAccesses++;                                    // Would have been lost on the real thing
+  }
+  Selected = On;
+}
+
+uint8_t FakeEve_Transfer(uint8_t Out)
+{
+  uint8_t In = 0;
+
+  FakeEveBytes++;
+  if (!Selected)
+    return 0;
+
+  if (Count < 3)                                                   // Address phase
+  {
+    if (Count == 0)
+    {
+      First = Out;
+      Writing = Out & 0x80;
+    }
+    Address = (Address << 8) | Out;
+    if (Count == 2)
+      Address &= 0x3FFFFF;
+    if ((Count == 2) && !Writing && (Address == (REG_TOUCH_DIRECT_XY + RAM_REG)))
+    {
+      FakeEve_wr32(Address, TapCount ? Taps[0] : 0x80000000);     // A queued tap is seen by one read
+      if (TapCount)
+        memmove(Taps, Taps + 1, --TapCount * sizeof(Taps[0]));
+    }
+  }
+  else if (Writing)
+  {
+    if (Address < FAKE_EVE_SIZE)
+      FakeEveMem[Address] = Out;
+    if ((Address & ~1UL) == (REG_CMD_WRITE + RAM_REG))
+      CmdWritten = true;
+    if (Address == (REG_PLAY + RAM_REG))                          // Sounds finish at once
+      FakeEveMem[Address] = 0;
+    Address++;
+  }
+  else if (Count > 3)                                              // The byte after the address is a dummy when reading
+  {
+    if (Address < FAKE_EVE_SIZE)
+      In = FakeEveMem[Address];
+    Address++;
+  }
+
+  if (Count < 255)
+    Count++;
+  return In;
+}
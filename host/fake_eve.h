@@ -0,0 +1,44 @@
+#ifndef FAKE_EVE_H
+#define FAKE_EVE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>                   // Find integer types like "uint8_t"
+#include <stdbool.h>                  // Find type "bool"
+
+// Host stand-in for the Eve on the far side of SPI.  It decodes the transactions the Eve2 library makes (3 byte
+// address, write flag in the top bit, a dummy byte ahead of read data) against a flat copy of the FT81x memory
+// map.  The coprocessor executes instantly - as soon as REG_CMD_WRITE is written, REG_CMD_READ catches up - unless
+// FakeEveCmdNsPerByte gives it a speed, when it works through the FIFO as FakeEve_Run() passes it time.  It does
+// nothing with the commands but fold them into FakeEveCmdSum, which shows whether they arrived whole and in order.
+// The touch panel is ideal (raw coordinates are screen coordinates) and is driven from the host side: a finger
+// is put down on a tag with FakeEve_Touch(), and taps for the calibration screen are queued with FakeEve_Tap().
+
+#define FAKE_EVE_SIZE       0x400000  // Covers RAM_G through RAM_CMD
+
+extern uint8_t FakeEveMem[FAKE_EVE_SIZE];
+extern uint32_t FakeEveTransactions;  // Chip select cycles
+extern uint32_t FakeEveBytes;         // Bytes moved over SPI
+extern uint32_t FakeEveCmdNsPerByte;  // Time the coprocessor takes over each byte of the FIFO, 0 for none
+extern uint32_t FakeEveCmdSum;        // FakeEve_Sum() of every byte the coprocessor has taken from the FIFO
+extern bool     FakeEveStandby;       // Put in standby (or sleep) by a host command, until HCMD_ACTIVE
+extern uint32_t FakeEveStandbyAccesses;  // Transactions other than HCMD_ACTIVE made while it was
+
+void FakeEve_Reset(void);
+void FakeEve_Select(bool Selected);
+void FakeEve_Run(uint64_t ns);
+uint32_t FakeEve_Sum(uint32_t Sum, uint8_t Byte);
+uint8_t FakeEve_Transfer(uint8_t Out);
+uint32_t FakeEve_rd32(uint32_t Address);
+void FakeEve_wr32(uint32_t Address, uint32_t Value);
+void FakeEve_Touch(uint8_t Tag, uint16_t x, uint16_t y);
+void FakeEve_Release(void);
+bool FakeEve_Tap(uint16_t x, uint16_t y);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,888 @@
+// Hardware abstraction layer of the host build - what SolutionWarmer.ino is on the board.
+//
+// Time is virtual: MyMillis() only moves when the simulator, MyDelay(), SPI traffic (SimSpiNsPerByte) or a pass of
+// MainLoop() (SimPassUs) advances it, and the thermal plant is stepped along with it.  The probes read the plant,
+// the heater pin drives it, SPI goes to the fake Eve and the PIDs are the FastPID stand-in.  The SD card is a
+// directory (SimSdDir); with none given there is no card and file operations fail as they do on the board.
+//
+// setup(), MainLoop() and the SD card functions follow SolutionWarmer.ino line for line where they can.
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "FastPID.h"
+#include "Eve2_81x.h"
+#include "MatrixEve2Conf.h"
+#include "process.h"
+#include "screens.h"
+#include "autotune.h"
+#include "settings.h"
+#include "calibrate.h"
+#include "power.h"
+#include "Arduino_AL.h"
+#include "fake_eve.h"
+#include "sim.h"
+
+char LogBuf[WorkBuffSz];
+
+uint32_t SimSensorInterval   = 5000;
+uint32_t SimSensorFastInterval = 800;
+uint32_t SimHeaterInterval   = 5000;
+uint32_t SimSolutionInterval = 16000;
+uint16_t SimPublishBytes     = 1024;
+
+PlantParms SimPlant;
+PlantState SimState;
+bool SimVerbose = false;
+int16_t (*SimProbeSource)(uint8_t ProbeNum) = NULL;
+const char *SimSdDir = NULL;
+uint32_t SimSpiNsPerByte = 0;
+uint32_t SimPassUs = 100;
+uint32_t SimRunUntil = 0;
+uint32_t SimPasses = 0;
+uint64_t SimSpiBusyNs = 0;
+uint64_t SimSpiBlockedNs = 0;
+uint8_t  SimNv[SIM_NV_SIZE];
+uint32_t SimNvWrites = 0;
+
+#define PRESSES          16
+
+typedef struct {
+  uint8_t  Tag;
+  uint16_t x, y;
+  uint32_t At, Hold;                            // mS
+} Press;
+
+static uint64_t Clock = 0;                      // Virtual nanoseconds
+static uint64_t PlantClock = 0;                 // What the plant has been stepped up to
+static bool Heater = false;
+static int16_t Conversion[NumProbes];          // Each probe returns the conversion started at its previous read
+static Press Presses[PRESSES];
+static uint8_t PressCount, PressNext;
+static bool Pressed;
+static bool AsyncBusy = false;                  // A SPI_WriteAsync() is going out until AsyncEnd
+static uint64_t AsyncEnd;
+static void (*AsyncDone)(void);
+static uint64_t NvBusyUntil;                    // An EEPROM byte is being written until then
+
+float HeaterGains[3] = { 10, 0.0025, 40 };
+float LoadGains[3]   = { 12.0, 0.0013, 0.0 };
+static float HeaterHz = HEATER_HZ, LoadHz = LOAD_HZ;
+static uint16_t LoadLow, LoadHigh;
+
+FastPID PID_Heater;
+FastPID PID_Load;
+
+static FILE *Files[FILE_HANDLES];   // The pool FileOpen() hands out
+
+// Start a run: the clock at 0, the plant at its start temperature and the PIDs configured as given
+void Sim_Setup(const SimConfig *c)
+{
+  Clock = PlantClock = 0;
+  AsyncBusy = false;
+  SimSpiBusyNs = SimSpiBlockedNs = 0;
+  Heater = false;
+  PressCount = PressNext = 0;
+  Pressed = false;
+  Plant_Default(&SimPlant, c->BagMl);
+  Plant_Init(&SimState, &SimPlant, c->Start);
+  Conversion[OWTP_Plate] = Plant_ProbeRaw(c->Start);
+  Conversion[OWTP_Solution] = Plant_ProbeRaw(c->Start);
+
+  SimSensorInterval = c->SensorInterval;
+  SimSensorFastInterval = c->SensorFastInterval;
+  SimHeaterInterval = c->HeaterInterval;
+  SimSolutionInterval = c->SolutionInterval;
+  HeaterHz = 1000.0 / c->HeaterInterval;
+  LoadHz = 1000.0 / c->SolutionInterval;
+  memcpy(HeaterGains, c->HeaterGains, sizeof(HeaterGains));
+  memcpy(LoadGains, c->LoadGains, sizeof(LoadGains));
+  PID_Heater.configure(HeaterGains[0], HeaterGains[1], HeaterGains[2], HeaterHz, 8, false);
+  PID_Load.configure(LoadGains[0], LoadGains[1], LoadGains[2], LoadHz, 16, false);
+  if (PID_Heater.err() || PID_Load.err())
+    fprintf(stderr, "Gains out of FastPID range at %lu/%lu ms, that PID outputs 0\n", (unsigned long)c->HeaterInterval,
+            (unsigned long)c->SolutionInterval);
+
+  FakeEve_Reset();
+  memset(SimNv, 0xFF, sizeof(SimNv));           // Erased
+  NvBusyUntil = 0;
+  SimNvWrites = 0;
+  Settings_Load();                              // Finds nothing - no settings left from the run before
+}
+
+// Put a finger on Tag at x, y from At until At + Hold mS of virtual time.  Presses are made in the order given.
+bool Sim_Press(uint8_t Tag, uint16_t x, uint16_t y, uint32_t At, uint32_t Hold)
+{
+  if (PressCount >= PRESSES)
+    return false;
+  Presses[PressCount].Tag = Tag;
+  Presses[PressCount].x = x;
+  Presses[PressCount].y = y;
+  Presses[PressCount].At = At;
+  Presses[PressCount].Hold = Hold;
+  PressCount++;
+  return true;
+}
+
+// Move virtual time on, stepping the plant every SIM_STEP and pressing the touch screen as scripted
+static void Advance(uint64_t ns)
+{
+  Clock += ns;
+  FakeEve_Run(ns);
+  while ((Clock - PlantClock) >= (SIM_STEP * 1000000ULL))
+  {
+    Plant_Step(&SimState, &SimPlant, Heater, SIM_STEP / 1000.0);
+    PlantClock += SIM_STEP * 1000000ULL;
+  }
+
+  if (PressNext < PressCount)
+  {
+    Press *p = &Presses[PressNext];
+
+    if (!Pressed && (MyMillis() >= p->At))
+    {
+      FakeEve_Touch(p->Tag, p->x, p->y);
+      Pressed = true;
+    }
+    if (Pressed && (MyMillis() >= (p->At + p->Hold)))
+    {
+      FakeEve_Release();
+      Pressed = false;
+      PressNext++;
+      if (p->Tag == TAG_CALIBRATE)                // and then taps the dots which come up
+        Sim_CalibrationTaps();
+    }
+  }
+}
+
+void Sim_Advance(uint32_t ms)
+{
+  Advance((uint64_t)ms * 1000000);
+}
+
+bool Sim_HeaterOn(void)
+{
+  return Heater;
+}
+
+void setup(void)
+{
+  bool Calibrated;
+
+  // Initializations.  Order is important
+  Mem_Paint();         // Before the stack has been anywhere, so how deep it goes can be found later
+  GlobalInit();
+  FT81x_Init();
+  Settings_Load();     // Out of EEPROM - calibration, goal and gains without waiting for the SD card
+  if (Settings.Have & SET_TOUCH)
+    LoadTouchMatrix();
+  SD_Init();
+
+  // One wire initialization of probes
+  if (!searchTempProbe(OWTP_Solution) || !searchTempProbe(OWTP_Plate))
+    return;                                               // We can not operate without successful probe interaction
+
+  // Calibration out of EEPROM, or failing that from the SD card.  With neither, the dots are tapped in MainLoop().
+  Calibrated = (Settings.Have & SET_TOUCH) || LoadTouchMatrix();
+  LoadPIDGains();      // Autotuned gains, if there are any
+
+  Cmd_SetRotate(1);  // Rotate the display
+  wr8(REG_PWM_DUTY + RAM_REG, POWER_BRIGHT);  // set backlight
+
+  FileRemove("pidlog.txt");
+
+  SetupMainScreen();
+  Screens_Init();      // Build the static parts of all screens into RAM_G
+  if (!Calibrated)
+  {
+    Sim_CalibrationTaps();                                // Queued for MainLoop() to find
+    Calibrate_Start(true);
+  }
+  MainLoop();
+}
+
+// The ideal touch panel is tapped right on each of the dots calibrate.c draws
+void Sim_CalibrationTaps(void)
+{
+  uint16_t x, y;
+  uint8_t i;
+
+  for (i = 0; i < CAL_POINTS; i++)
+  {
+    Calibrate_Point(i, &x, &y);
+    FakeEve_Tap(x, y);
+  }
+}
+
+// Unlike on the board, MainLoop() returns once virtual time reaches SimRunUntil
+void MainLoop(void)
+{
+  while (MyMillis() < SimRunUntil)
+  {
+    CheckScreen();          // Update the screen at an effective rate
+    CheckSensors();         // Read the sensors at the correct rate (and update the time to READY estimate)
+    CheckAutotune();        // Run the PID autotuner when it has been started
+    CheckSolution();        // Run the load PID loop to set the plate goal
+    CheckHeater();          // Run PID loop for heater
+    CheckHistory();         // Record the temperatures for the History screen
+    CheckTouch();           // Check for user touching and update values (blocks on touch)
+    CheckCalibrate();       // Take the calibration taps while the calibration dots are showing
+    SPI_AsyncPoll();        // Finish off a frame still going out to Eve
+    CheckSettings();        // Write saved settings into EEPROM a byte at a time
+    CheckMemory();          // Log the stack high-water mark as it rises
+    CheckPower();           // Dim the display when idle, and sleep until the next thing to do
+    Advance((uint64_t)SimPassUs * 1000);
+    SimPasses++;
+  }
+}
+
+void GlobalInit(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < EVE_DEVICES; i++)
+  {
+    SetPin(EveDevices[i].PDNPin, 0);      // Apply a resetish condition on Eve
+    SetPin(EveDevices[i].CSPin, 1);       // Deselect Eve
+  }
+  SetPin(EveAudioEnable_PIN, 0);          // Disable Audio
+  SetPin(ControlOutput_PIN, 0);           // Turn that heater OFF!
+}
+
+//================================== Pins and SPI ====================================
+void SetPin(uint8_t pin, bool state)
+{
+  if (pin == ControlOutput_PIN)
+    Heater = state;
+}
+
+uint8_t ReadPin(uint8_t pin)
+{
+  return 0;
+}
+
+// A blocking transfer - the CPU waits it out
+static void SPI_Time(uint32_t Bytes)
+{
+  uint64_t ns = (uint64_t)Bytes * SimSpiNsPerByte;
+
+  SimSpiBusyNs += ns;
+  SimSpiBlockedNs += ns;
+  if (ns)
+    Advance(ns);
+}
+
+void SPI_WriteByte(uint8_t data)
+{
+  SPI_AsyncWait();
+  FakeEve_Select(true);
+  FakeEve_Transfer(data);
+  FakeEve_Select(false);
+  SPI_Time(1);
+}
+
+// Like the Arduino SPI.transfer(buffer, size) the buffer is overwritten with what was read
+void SPI_WriteBuffer(uint8_t *Buffer, uint32_t Length)
+{
+  SPI_AsyncWait();
+  SPI_Time(Length);
+  FakeEve_Select(true);
+  while (Length--)
+  {
+    *Buffer = FakeEve_Transfer(*Buffer);
+    Buffer++;
+  }
+  FakeEve_Select(false);
+}
+
+void SPI_Write(uint8_t data)
+{
+  FakeEve_Transfer(data);
+  SPI_Time(1);
+}
+
+void SPI_ReadBuffer(uint8_t *Buffer, uint32_t Length)
+{
+  SPI_Time(Length + 1);
+  FakeEve_Transfer(0x00);                       // dummy read
+
+  while (Length--)
+    *(Buffer++) = FakeEve_Transfer(0x00);
+}
+
+void SPI_WriteFlash(const uint8_t *Buffer, uint32_t Length)
+{
+  SPI_Time(Length);
+  while (Length--)
+    FakeEve_Transfer(*Buffer++);
+}
+
+// The bytes reach the fake Eve at once, but the transfer only ends SimSpiNsPerByte per byte later in virtual time,
+// and until then the CPU is free.  Whoever needs the bus before that waits for the rest of it.
+void SPI_WriteAsync(const uint8_t *Buffer, uint32_t Length, void (*Done)(void))
+{
+  SPI_AsyncWait();
+  AsyncBusy = true;
+  AsyncDone = Done;
+  AsyncEnd = Clock + (uint64_t)Length * SimSpiNsPerByte;
+  SimSpiBusyNs += (uint64_t)Length * SimSpiNsPerByte;
+  while (Length--)
+    FakeEve_Transfer(*Buffer++);
+  SPI_AsyncPoll();
+}
+
+bool SPI_AsyncPoll(void)
+{
+  if (!AsyncBusy || (Clock < AsyncEnd))
+    return AsyncBusy;
+  AsyncBusy = false;
+  if (AsyncDone)
+    AsyncDone();
+  return AsyncBusy;
+}
+
+void SPI_AsyncWait(void)
+{
+  while (AsyncBusy)
+  {
+    if (Clock < AsyncEnd)
+    {
+      SimSpiBlockedNs += AsyncEnd - Clock;
+      Advance(AsyncEnd - Clock);
+    }
+    SPI_AsyncPoll();
+  }
+}
+
+void SPI_Enable(void)
+{
+  SPI_AsyncWait();
+  FakeEve_Select(true);
+}
+
+void SPI_Disable(void)
+{
+  FakeEve_Select(false);
+}
+
+void SPI_Release(void)
+{
+  SPI_AsyncWait();
+}
+
+void Eve_Reset_HW(void)
+{
+  FakeEve_Reset();
+  MyDelay(150);
+}
+
+//================================== Time and logging ====================================
+void DebugPrint(char *str)
+{
+  if (SimVerbose)
+    fprintf(stderr, "[%8.1f] %s", Clock / 1e9, str);
+}
+
+// Log() - lines are cut short at the size of LogBuf, as on the board
+void Log_P(const char *Fmt, ...)
+{
+  va_list Args;
+
+  va_start(Args, Fmt);
+  vsnprintf_P(LogBuf, WorkBuffSz, Fmt, Args);
+  va_end(Args);
+  DebugPrint(LogBuf);
+}
+
+void MyDelay(uint32_t DLY)
+{
+  Sim_Advance(DLY);
+}
+
+uint32_t MyMillis(void)
+{
+  return (uint32_t)(Clock / 1000000);
+}
+
+uint32_t MyMicros(void)
+{
+  return (uint32_t)(Clock / 1000);
+}
+
+// Virtual time jumps to Until, so the idle firmware runs faster than real time instead of spinning
+void MCU_Sleep(uint32_t Until)
+{
+  if (Until > MyMillis())
+    Advance(((uint64_t)Until * 1000000) - Clock);
+}
+
+void FlashRead(void *Dest, const void *Src, uint16_t Length)
+{
+  memcpy(Dest, Src, Length);
+}
+
+// RAM use.  There is no heap here to meet the stack, so SIM_STACK_PAINT bytes below the frame of Mem_Paint(), called
+// first thing in setup(), are painted instead and "free" is what is left of them.  The figures are for this machine's
+// code, not the board's, but they go up and down with it.  The bounds are kept as addresses, worked out from the
+// frame, and the painted bytes are read after Mem_Paint() has returned, which the address sanitizer is told to allow.
+#define MEM_PAINT               0xA5
+#define MEM_PAINT_GAP            256   // Bytes under the frame left out for Mem_Paint()'s own saved registers and locals
+
+static uintptr_t PaintLow, PaintHigh;
+
+__attribute__((noinline, no_sanitize_address)) void Mem_Paint(void)
+{
+  volatile uint8_t Area[SIM_STACK_PAINT + 2 * MEM_PAINT_GAP];     // Holds the stack down while it is painted
+  uintptr_t High = (uintptr_t)__builtin_frame_address(0) - MEM_PAINT_GAP;
+  uintptr_t Low = High - SIM_STACK_PAINT;
+  uintptr_t a;
+
+  if ((Low < (uintptr_t)Area) || (High > (uintptr_t)Area + sizeof(Area)))
+    return;                                                     // Laid out otherwise - no figures
+  for (a = Low; a < High; a++)
+    Area[a - (uintptr_t)Area] = MEM_PAINT;
+  PaintLow = Low;
+  PaintHigh = High;
+}
+
+__attribute__((no_sanitize_address)) uint16_t Mem_StackUsed(void)
+{
+  uintptr_t a = PaintLow;
+
+  if (!a)
+    return 0;
+  while ((a < PaintHigh) && (*(const volatile uint8_t *)a == MEM_PAINT))
+    a++;
+  return (PaintHigh - a);
+}
+
+uint16_t Mem_HeapPeak(void)
+{
+  return 0;
+}
+
+uint16_t Mem_Free(void)
+{
+  return (PaintLow ? (SIM_STACK_PAINT - Mem_StackUsed()) : 0);
+}
+
+void CheckMemory(void)
+{
+  static uint32_t Time2CheckMemory = MEM_CHECK_INTERVAL;
+  static uint16_t Reported = 0;            // Stack use last logged
+  uint16_t Used;
+
+  if (MyMillis() < Time2CheckMemory)
+    return;
+  Time2CheckMemory = MyMillis() + MEM_CHECK_INTERVAL;
+
+  Used = Mem_StackUsed();
+  if (!Used)
+    return;
+  if (Used > Reported)
+  {
+    Reported = Used;
+    Log("RAM: stack %u heap %u free %u\n", Used, Mem_HeapPeak(), Mem_Free());
+  }
+  if (Mem_Free() < MEM_MIN_FREE)
+    Log("Low RAM: %u free\n", Mem_Free());
+}
+
+//================================== Fast-PID Functions ====================================
+uint8_t PID_Heater_Step(uint16_t SetPoint, uint16_t CurrentVal)
+{
+  return (PID_Heater.step(SetPoint, CurrentVal));
+}
+
+uint16_t PID_Load_Step(uint16_t SetPoint, uint16_t CurrentVal)
+{
+  return (PID_Load.step(SetPoint, CurrentVal));
+}
+
+void PID_ClearAll(void)
+{
+  PID_Heater.clear();
+  PID_Load.clear();
+}
+
+void PID_Load_SetRange(uint16_t Lowend, uint16_t Highend)
+{
+  LoadLow = Lowend;
+  LoadHigh = Highend;
+  PID_Load.setOutputRange(Lowend, Highend);
+}
+
+// As on the board, gains FastPID can not represent leave the PID configured with the gains it had
+static bool PID_SetGains(FastPID &Pid, float *Gains, float Hz, int Bits, float Kp, float Ki, float Kd)
+{
+  if (Pid.setCoefficients(Kp, Ki, Kd, Hz))
+  {
+    Gains[0] = Kp;
+    Gains[1] = Ki;
+    Gains[2] = Kd;
+    return true;
+  }
+  Pid.configure(Gains[0], Gains[1], Gains[2], Hz, Bits, false);
+  return false;
+}
+
+bool PID_Heater_SetGains(float Kp, float Ki, float Kd)
+{
+  return (PID_SetGains(PID_Heater, HeaterGains, HeaterHz, 8, Kp, Ki, Kd));
+}
+
+bool PID_Load_SetGains(float Kp, float Ki, float Kd)
+{
+  if (PID_SetGains(PID_Load, LoadGains, LoadHz, 16, Kp, Ki, Kd))
+    return true;
+  PID_Load.setOutputRange(LoadLow, LoadHigh); // configure() forgot it
+  return false;
+}
+
+//================================== One-Wire Functions ====================================
+int8_t searchTempProbe(uint8_t ProbeNum)
+{
+  return 1;
+}
+
+// Like the DS18S20, each read returns the conversion started by the read before it
+int16_t readTempProbe(uint8_t ProbeNum)
+{
+  int16_t Raw = Conversion[ProbeNum];
+
+  if (SimProbeSource)
+    return SimProbeSource(ProbeNum);
+  Conversion[ProbeNum] = Plant_ProbeRaw((ProbeNum == OWTP_Plate) ? SimState.PlateProbe : SimState.BagProbe);
+  return Raw;
+}
+
+//================================== SD Card Functions ====================================
+// The card is the directory SimSdDir, flat like the card is used
+static bool SD_Path(char *Path, size_t Size, const char *filename)
+{
+  if (!SimSdDir)
+    return false;
+  snprintf(Path, Size, "%s/%s", SimSdDir, filename);
+  return true;
+}
+
+void SD_Init(void)
+{
+  if (!SimSdDir || access(SimSdDir, W_OK))
+  {
+    Log("SD initialization failed!\n");
+    SimSdDir = NULL;
+  }
+}
+
+// Read the touch digitizer calibration matrix values from the Eve into the settings, to be saved in EEPROM, and
+// write them to a file as well
+void SaveTouchMatrix(void)
+{
+  uint8_t Buf[sizeof(Settings.TouchMatrix)];
+  uint8_t count = 0;
+  uint32_t data;
+  FileHandle h;
+  uint32_t address = REG_TOUCH_TRANSFORM_A + RAM_REG;
+
+  for (count = 0; count < 6; count++)
+    Settings.TouchMatrix[count] = rd32(address + (count * 4));
+  Settings.Have |= SET_TOUCH;
+  Settings_Save();
+
+  for (count = 0; count < 6; count++)
+  {
+    data = Settings.TouchMatrix[count];
+    Log("TM%dw: 0x%08lx\n", count, (unsigned long)data);
+    Buf[(count * 4)]     = data & 0xff;      // Little endian file storage to match Eve
+    Buf[(count * 4) + 1] = (data >> 8) & 0xff;
+    Buf[(count * 4) + 2] = (data >> 16) & 0xff;
+    Buf[(count * 4) + 3] = (data >> 24) & 0xff;
+  }
+
+  h = FileOpen("tmatrix.txt", FILEWRITE);  // Replaces the file of a previous run
+  if(h == FILE_NONE)
+  {
+    Log("No create file\n");
+    return;
+  }
+  FileWriteBuf(h, Buf, sizeof(Buf));
+  FileClose(h);
+  Log("Matrix Saved\n\n");
+}
+
+// Write the touch digitizer calibration matrix values to the Eve.  They come from the settings, or if there are
+// none there, from a file - and then go into the settings to be found there next time.
+bool LoadTouchMatrix(void)
+{
+  uint8_t Buf[sizeof(Settings.TouchMatrix)];
+  uint8_t count = 0;
+  uint32_t data;
+  FileHandle h;
+  uint32_t address = REG_TOUCH_TRANSFORM_A + RAM_REG;
+
+  if (!(Settings.Have & SET_TOUCH))
+  {
+    h = FileOpen("tmatrix.txt", FILEREAD);
+    if((FileSize(h) != sizeof(Buf)) || (FileReadBuf(h, Buf, sizeof(Buf)) != sizeof(Buf)))
+    {
+      Log("tmatrix.txt not open\n");
+      FileClose(h);
+      return false;
+    }
+    FileClose(h);
+
+    for (count = 0; count < 6; count++)
+    {
+      data = Buf[(count * 4)] + ((uint32_t)Buf[(count * 4) + 1] << 8) + ((uint32_t)Buf[(count * 4) + 2] << 16) +
+             ((uint32_t)Buf[(count * 4) + 3] << 24);
+      Log("TM%dr: 0x%08lx\n", count, (unsigned long)data);
+      Settings.TouchMatrix[count] = data;
+    }
+    Settings.Have |= SET_TOUCH;
+    Settings_Save();
+  }
+
+  for (count = 0; count < 6; count++)
+    wr32(address + (count * 4), Settings.TouchMatrix[count]);
+  Log("Matrix Loaded \n\n");
+  return true;
+}
+
+// Put the PID gains (heater then load, Kp Ki Kd each) into the settings, to be saved in EEPROM, and write them to
+// a file as little endian floats as well
+void SavePIDGains(void)
+{
+  float *Gains[2] = { HeaterGains, LoadGains };
+  uint8_t Buf[sizeof(Settings.HeaterGains) + sizeof(Settings.LoadGains)];
+  uint8_t *p = Buf;
+  uint32_t data;
+  uint8_t i, j;
+  FileHandle h;
+
+  memcpy(Settings.HeaterGains, HeaterGains, sizeof(Settings.HeaterGains));
+  memcpy(Settings.LoadGains, LoadGains, sizeof(Settings.LoadGains));
+  Settings.Have |= SET_GAINS;
+  Settings_Save();
+
+  for (i = 0; i < 2; i++)
+  {
+    for (j = 0; j < 3; j++)
+    {
+      memcpy(&data, &Gains[i][j], 4);
+      p[0] = data & 0xff;
+      p[1] = (data >> 8) & 0xff;
+      p[2] = (data >> 16) & 0xff;
+      p[3] = (data >> 24) & 0xff;
+      p += 4;
+    }
+  }
+
+  h = FileOpen("pidgains.txt", FILEWRITE);
+  if(h == FILE_NONE)
+  {
+    Log("No create file\n");
+    return;
+  }
+  FileWriteBuf(h, Buf, sizeof(Buf));
+  FileClose(h);
+  Log("Gains Saved\n");
+}
+
+// Put the PID gains saved by SavePIDGains() to use - from the settings, or if there are none there, from the file
+bool LoadPIDGains(void)
+{
+  float Gains[6];
+  uint8_t Buf[sizeof(Gains)];
+  uint32_t data;
+  uint8_t i;
+  FileHandle h;
+
+  if (Settings.Have & SET_GAINS)
+  {
+    memcpy(&Gains[0], Settings.HeaterGains, sizeof(Settings.HeaterGains));
+    memcpy(&Gains[3], Settings.LoadGains, sizeof(Settings.LoadGains));
+  }
+  else
+  {
+    h = FileOpen("pidgains.txt", FILEREAD);
+    if((FileSize(h) != sizeof(Buf)) || (FileReadBuf(h, Buf, sizeof(Buf)) != sizeof(Buf)))
+    {
+      FileClose(h);
+      return false;
+    }
+    FileClose(h);
+
+    for (i = 0; i < 6; i++)
+    {
+      data = Buf[(i * 4)] + ((uint32_t)Buf[(i * 4) + 1] << 8) + ((uint32_t)Buf[(i * 4) + 2] << 16) +
+             ((uint32_t)Buf[(i * 4) + 3] << 24);
+      memcpy(&Gains[i], &data, 4);
+    }
+  }
+
+  if (!PID_Heater_SetGains(Gains[0], Gains[1], Gains[2]) || !PID_Load_SetGains(Gains[3], Gains[4], Gains[5]))
+  {
+    Log("Bad gains\n");
+    return false;
+  }
+  if (!(Settings.Have & SET_GAINS))        // Into the settings for next time
+  {
+    memcpy(Settings.HeaterGains, HeaterGains, sizeof(Settings.HeaterGains));
+    memcpy(Settings.LoadGains, LoadGains, sizeof(Settings.LoadGains));
+    Settings.Have |= SET_GAINS;
+    Settings_Save();
+  }
+  Log("Gains Loaded\n");
+  return true;
+}
+
+//================================== EEPROM ====================================
+// SimNv stands in for the 1 KB of the ATmega328P, which takes 3.3 mS of virtual time to write a byte
+uint16_t NV_Size(void)
+{
+  return sizeof(SimNv);
+}
+
+uint8_t NV_Read(uint16_t Address)
+{
+  return SimNv[Address];
+}
+
+void NV_Write(uint16_t Address, uint8_t Data)
+{
+  if (SimNv[Address] == Data)                   // As EEPROM.update()
+    return;
+  SimNv[Address] = Data;
+  SimNvWrites++;
+  NvBusyUntil = Clock + SIM_NV_WRITE_NS;
+}
+
+bool NV_Busy(void)
+{
+  return (Clock < NvBusyUntil);
+}
+
+void NV_Commit(void)
+{
+}
+
+// Files from a pool of FILE_HANDLES, as on the board.  FILEWRITE starts the file afresh and FILEAPPEND writes on at
+// its end, like the SD library's FILE_WRITE.
+FileHandle FileOpen(const char *filename, uint8_t mode)
+{
+  char Path[256];
+  FileHandle h;
+
+  for (h = 0; (h < FILE_HANDLES) && Files[h]; h++)
+    ;
+  if (h == FILE_HANDLES)
+  {
+    Log("No file handle\n");
+    return FILE_NONE;
+  }
+  if (!SD_Path(Path, sizeof(Path), filename))
+    return FILE_NONE;
+
+  switch(mode)
+  {
+  case FILEREAD:
+    Files[h] = fopen(Path, "rb");
+    break;
+  case FILEWRITE:
+    Files[h] = fopen(Path, "w+b");
+    break;
+  case FILEAPPEND:
+    Files[h] = fopen(Path, "a+b");
+    break;
+  default:;
+  }
+  return (Files[h] ? h : FILE_NONE);
+}
+
+// The open file of a handle, or NULL
+static FILE *File_Of(FileHandle h)
+{
+  return ((h < FILE_HANDLES) ? Files[h] : NULL);
+}
+
+void FileClose(FileHandle h)
+{
+  if (File_Of(h))
+  {
+    fclose(Files[h]);
+    Files[h] = NULL;
+  }
+}
+
+void FileFlush(FileHandle h)
+{
+  if (File_Of(h))
+    fflush(Files[h]);
+}
+
+// Read a single byte from a file - 0xFF past the end, as the -1 of File.read() comes out
+uint8_t FileReadByte(FileHandle h)
+{
+  return (File_Of(h) ? (uint8_t)fgetc(Files[h]) : 0xFF);
+}
+
+uint32_t FileReadBuf(FileHandle h, uint8_t *data, uint32_t NumBytes)
+{
+  return (File_Of(h) ? fread(data, 1, NumBytes, Files[h]) : 0);
+}
+
+void FileWrite(FileHandle h, uint8_t data)
+{
+  if (File_Of(h))
+    fputc(data, Files[h]);
+}
+
+uint32_t FileWriteBuf(FileHandle h, const uint8_t *data, uint32_t NumBytes)
+{
+  return (File_Of(h) ? fwrite(data, 1, NumBytes, Files[h]) : 0);
+}
+
+// Write a string of characters to a file, truncated at MaxChars
+uint16_t FileWriteStr(FileHandle h, const char *str, uint16_t MaxChars)
+{
+  uint16_t count = 0;
+
+  while( (count < MaxChars) && str[count] )
+    count++;
+  return FileWriteBuf(h, (const uint8_t *)str, count);
+}
+
+uint32_t FileSize(FileHandle h)
+{
+  long Here, Size;
+
+  if (!File_Of(h))
+    return 0;
+  Here = ftell(Files[h]);
+  fseek(Files[h], 0, SEEK_END);
+  Size = ftell(Files[h]);
+  fseek(Files[h], Here, SEEK_SET);
+  return Size;
+}
+
+uint32_t FilePosition(FileHandle h)
+{
+  return (File_Of(h) ? ftell(Files[h]) : 0);
+}
+
+bool FileSeek(FileHandle h, uint32_t offset)
+{
+  return (File_Of(h) && !fseek(Files[h], offset, SEEK_SET));
+}
+
+// SD.exists() and SD.remove() in one
+void FileRemove(const char *filename)
+{
+  char Path[256];
+
+  if (SD_Path(Path, sizeof(Path), filename))
+    unlink(Path);
+}
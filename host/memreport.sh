@@ -0,0 +1,79 @@
+#!/bin/sh
+# memreport.sh - the static RAM each module of the sketch takes, against a budget.
+#
+#   memreport.sh [-s size_program] [-r] [-b budget_file] object_or_archive ...
+#
+# For each object (or each member of an archive) the bytes of its .data and .bss sections are added up with
+# "size -A".  -r counts read-only data as well, as the AVR copies .rodata into RAM - which is why its constant text
+# is kept in flash with PROGMEM, in .progmem sections which are not counted.  For the board, give the objects of an
+# Arduino build (arduino-cli compile --build-path) with -s avr-size -r.
+#
+# The budget file has a line for each module to check, "process.c 200", and may have a "total" line.  Anything
+# after a # is a comment.  Modules without a line are reported but not checked, nor counted in the total (which is
+# of every module when no module has a line).  Every module is printed with its headroom, and the exit status is 1
+# if any is over budget.
+
+Size=size
+RoData=0
+Budget=/dev/null
+
+while getopts s:rb: Opt
+do
+  case $Opt in
+  s) Size=$OPTARG ;;
+  r) RoData=1 ;;
+  b) Budget=$OPTARG ;;
+  *) echo "usage: memreport.sh [-s size_program] [-r] [-b budget_file] object_or_archive ..." >&2; exit 2 ;;
+  esac
+done
+shift $((OPTIND - 1))
+[ $# -gt 0 ] || { echo "memreport.sh: no objects" >&2; exit 2; }
+
+"$Size" -A "$@" | awk -v RoData=$RoData -v Budget="$Budget" '
+  BEGIN {
+    while ((getline Line < Budget) > 0)
+    {
+      sub(/#.*/, "", Line)
+      if (split(Line, f) == 2)
+      {
+        Limit[f[1]] = f[2]
+        if (f[1] != "total")
+          Listed = 1
+      }
+    }
+  }
+  / \(ex / || /^[^ ]+ *:$/ {                                  # "process.c.o   (ex libwarmer.a):" or "process.c.o  :"
+    Module = $1
+    sub(/:$/, "", Module)
+    sub(/.*\//, "", Module)
+    sub(/\.o$/, "", Module)
+    Order[++Count] = Module
+    next
+  }
+  Module != "" && $1 ~ /^\./ {
+    if ($1 ~ /^\.(data|bss)/ || (RoData && $1 ~ /^\.rodata/))
+      Ram[Module] += $2
+  }
+  function Row(Name, Bytes,    Room)
+  {
+    if (Name in Limit)
+    {
+      Room = Limit[Name] - Bytes
+      printf("%-20s %7d %7d %7d%s\n", Name, Bytes, Limit[Name], Room, (Room < 0) ? "  OVER BUDGET" : "")
+      if (Room < 0)
+        Over = 1
+    }
+    else
+      printf("%-20s %7d %7s %7s\n", Name, Bytes, "-", "-")
+  }
+  END {
+    printf("%-20s %7s %7s %7s\n", "module", "RAM", "budget", "room")
+    for (i = 1; i <= Count; i++)
+    {
+      Row(Order[i], Ram[Order[i]])
+      if (!Listed || (Order[i] in Limit))
+        Total += Ram[Order[i]]
+    }
+    Row("total", Total)
+    exit Over
+  }'
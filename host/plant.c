@@ -0,0 +1,47 @@
+// Thermal plant for the host simulator - see plant.h
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include <math.h>                  // lroundf()
+#include "plant.h"                 // Header for this file
+
+// A 100 W heater under an aluminium plate and a bag of the given volume.  The numbers are round figures which
+// give warm-ups of the length seen on the real unit, not measurements.
+void Plant_Default(PlantParms *p, float BagMl)
+{
+  p->Ambient = 22;
+  p->HeaterWatts = 100;
+  p->PlateCap = 400;
+  p->PlateLoss = 1.0;
+  p->Contact = 3.0;
+  p->BagCap = 4.19 * BagMl;
+  p->BagLoss = 0.6 + (BagMl / 2500);                               // Bigger bag, more surface
+  p->ProbeLag = 8;
+  p->SkinLag = 60;
+}
+
+void Plant_Init(PlantState *s, const PlantParms *p, float Start)
+{
+  s->Plate = s->Bag = s->Skin = s->PlateProbe = s->BagProbe = Start;
+  s->Energy = 0;
+}
+
+// Advance by dt seconds (explicit Euler - dt is far below every time constant)
+void Plant_Step(PlantState *s, const PlantParms *p, bool HeaterOn, float dt)
+{
+  float In = HeaterOn ? p->HeaterWatts : 0;
+  float ToBag = p->Contact * (s->Plate - s->Bag);
+
+  s->Plate += ((In - ToBag - (p->PlateLoss * (s->Plate - p->Ambient))) * dt) / p->PlateCap;
+  s->Bag += ((ToBag - (p->BagLoss * (s->Bag - p->Ambient))) * dt) / p->BagCap;
+  s->PlateProbe += ((s->Plate - s->PlateProbe) * dt) / p->ProbeLag;
+  s->Skin += ((s->Bag - s->Skin) * dt) / p->SkinLag;
+  s->BagProbe += ((s->Skin - s->BagProbe) * dt) / p->ProbeLag;
+  s->Energy += In * dt;
+}
+
+// A temperature as the DS18S20 reports it - counts of half a degree
+int16_t Plant_ProbeRaw(float Temp)
+{
+  return (int16_t)lroundf(Temp / PLANT_PROBE_LSB);
+}
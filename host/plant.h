@@ -0,0 +1,44 @@
+#ifndef PLANT_H
+#define PLANT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>                   // Find integer types like "uint8_t"
+#include <stdbool.h>                  // Find type "bool"
+
+// Lumped thermal model of the warmer: heater plate and bag of solution, each a heat capacity, coupled to each
+// other and losing heat to the room.  Each probe is a first order lag on its body, quantised like a DS18S20.  The
+// solution probe is taped to the bag, so its body is the bag's skin, which trails the solution inside.
+typedef struct {
+  float Ambient;                      // Degrees C
+  float HeaterWatts;                  // Heater power when on
+  float PlateCap;                     // J/K
+  float PlateLoss;                    // W/K plate to room
+  float Contact;                      // W/K plate to bag
+  float BagCap;                       // J/K - 4.19 per ml of water
+  float BagLoss;                      // W/K bag to room
+  float ProbeLag;                     // Seconds, time constant of each probe
+  float SkinLag;                      // Seconds, time constant of the bag's skin behind the solution in it
+} PlantParms;
+
+typedef struct {
+  float Plate, Bag;                   // Degrees C
+  float Skin;                         // Where the solution probe sits
+  float PlateProbe, BagProbe;         // What the probes' sensing elements are at
+  float Energy;                       // Joules put in by the heater
+} PlantState;
+
+#define PLANT_PROBE_LSB          0.5  // DS18S20 resolution in degrees C
+
+void Plant_Default(PlantParms *Parms, float BagMl);
+void Plant_Init(PlantState *s, const PlantParms *Parms, float Start);
+void Plant_Step(PlantState *s, const PlantParms *Parms, bool HeaterOn, float dt);
+int16_t Plant_ProbeRaw(float Temp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,382 @@
+// warmerreplay - regression test of the control loop against recorded pidlog.txt files.
+//
+//   warmerreplay [-w out_dir] [-c baseline_dir] [-g goal_x10] [-f] [-v] log_or_dir ...
+//
+// Every *.txt file found (directories are walked) is replayed through CheckSensors(), CheckSolution() and
+// CheckHeater() of the current code.  Each line of the log gives one sensor reading; what the loop made of it is
+// written as one line "plate,solution,plate_goal,pwm".  -w saves those lines under out_dir, mirroring the tree of
+// the logs, and -c compares them line by line with a tree saved before.  Files are streamed a line at a time so
+// any number of logs of any size can be replayed.  The exit status is 1 if anything differed from the baseline.
+//
+// A log holds the temperatures (x10) which CheckHeater() wrote every CheckHeaterInterval.  After a line "raw" they
+// are the probe readings themselves.  Before one, as logs were written before the probes were read faster than
+// that, they are filtered (and truncated), and the raw probe readings are recovered by running the filter of the
+// firmware which recorded the logs backwards: F = trunc(V * 4 / 5 + raw) leaves exactly one integer raw for each
+// line.  That filter is mirrored here rather than taken from process.c, so a change to the filtering there shows up
+// as a difference instead of being undone.
+// The estimate of the solution inside the bag (estimate.c) is checked on the way.  How well it predicted each
+// solution reading is reported, which the probe's 0.5 degree steps alone keep to 0.14 degrees rms at best.  So is
+// how well its model, run on from the estimate of AHEAD lines before with only the plate readings since, predicted
+// the reading - against just taking the reading from then, which is what the lag of the probe amounts to.
+//
+// The log does not say what the goal was, hence -g.  Nor does it have the readings CheckSensors() takes faster while
+// the solution warms, so the sensors are read at CheckSensorInterval throughout.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include <stdio.h>                 // fopen()
+#include <stdlib.h>                // atoi()
+#include <string.h>                // strcmp()
+#include <math.h>                  // ceilf()
+#include <errno.h>                 // EEXIST
+#include <limits.h>                // PATH_MAX
+#include <dirent.h>                // opendir()
+#include <unistd.h>                // fork()
+#include <time.h>                  // clock_gettime()
+#include <sys/stat.h>              // stat()
+#include <sys/mman.h>              // mmap()
+#include <sys/wait.h>              // waitpid()
+#include "Arduino_AL.h"            // NumProbes
+#include "process.h"               // MainScreen and PWM_Val
+#include "estimate.h"              // EstErrorSq
+#include "sim.h"                   // Host build of the sketch
+
+#define LINE_MAX_CHARS  64
+#define AHEAD           12         // Lines the model predicts ahead, a minute at CheckHeaterInterval
+
+typedef struct {                   // Totals kept in memory shared with the child doing each file
+  uint32_t Files, Lines, Skipped, Differ, DiffLines, Failed;
+  uint32_t EstReadings, EstErrorSq;  // Readings predicted by the estimate
+  uint32_t Ahead, AheadSq, HoldSq;    // Readings predicted AHEAD lines before, by the model and as the reading then
+} Totals;
+
+static Totals *Sum;
+static SimConfig Config;
+static const char *OutDir = NULL, *BaseDir = NULL;
+
+static int16_t Raw[NumProbes];     // What the probes read next
+static uint32_t Reads;             // Number of plate probe reads so far
+
+typedef struct {                   // What the estimate had after a line
+  float Core, Skin;                // x10 degrees
+  float Plate, Solution;           // The readings, x10
+  uint32_t At;                     // MyMillis()
+} Past;
+
+static int16_t Replay_Probe(uint8_t ProbeNum)
+{
+  if (ProbeNum == OWTP_Plate)
+    Reads++;
+  return Raw[ProbeNum];
+}
+
+// The probe reading which takes the recorded filter from state *V to Filtered
+static int16_t Unfilter(float *V, uint16_t Filtered)
+{
+  float Keep = ((*V * 4) / 5);                                     // As in CheckSensors() when the log was made
+  int16_t r = (int16_t)ceilf(Filtered - Keep);
+
+  *V = Keep + r;
+  return r;
+}
+
+static bool Parse(const char *Line, uint16_t *Plate, uint16_t *Solution)
+{
+  unsigned p, s;
+
+  if (sscanf(Line, "%u,%u", &p, &s) != 2)
+    return false;
+  *Plate = p;
+  *Solution = s;
+  return true;
+}
+
+// Run the model of estimate.c from Ring[i], AHEAD lines back, with the plate readings since up to Now, and score
+// its solution reading against the one Now has and the one from then
+static void Predict(const Past *Ring, uint8_t i, const Past *Now)
+{
+  const Past *p, *Last = &Ring[i];
+  float Core = Last->Core, Skin = Last->Skin;
+  float e, dt;
+  uint8_t j;
+
+  for (j = 1; j <= AHEAD; j++)
+  {
+    p = (j < AHEAD) ? &Ring[(i + j) % AHEAD] : Now;
+    dt = (p->At - Last->At) / 1000.0;
+    Skin += ((Core - Skin) * dt) / EST_TAU_SKIN;
+    Core += (((p->Plate - Core) * dt) / EST_TAU_CORE) - (((Core - EST_AMBIENT) * dt) / EST_TAU_LOSS);
+    Last = p;
+  }
+  e = Skin - Now->Solution;
+  __atomic_fetch_add(&Sum->AheadSq, (uint32_t)((e * e) + 0.5), __ATOMIC_RELAXED);
+  e = Ring[i].Solution - Now->Solution;
+  __atomic_fetch_add(&Sum->HoldSq, (uint32_t)((e * e) + 0.5), __ATOMIC_RELAXED);
+  __atomic_fetch_add(&Sum->Ahead, 1, __ATOMIC_RELAXED);
+}
+
+// Make the directories of Path, leaving its last part
+static bool MakeParents(char *Path)
+{
+  char *Slash;
+
+  for (Slash = strchr(Path + 1, '/'); Slash; Slash = strchr(Slash + 1, '/'))
+  {
+    *Slash = 0;
+    if (mkdir(Path, 0777) && (errno != EEXIST))
+    {
+      perror(Path);
+      return false;
+    }
+    *Slash = '/';
+  }
+  return true;
+}
+
+static FILE *OpenUnder(const char *Dir, const char *Rel, const char *Mode)
+{
+  char Path[PATH_MAX];
+  FILE *f;
+
+  snprintf(Path, sizeof(Path), "%s/%s", Dir, Rel);
+  if ((*Mode == 'w') && !MakeParents(Path))
+    return NULL;
+  if (!(f = fopen(Path, Mode)))
+    perror(Path);
+  return f;
+}
+
+// Replay one log.  Runs in a child of its own so every log starts from the power up state of process.c.
+static int Replay_Log(const char *Path, const char *Rel)
+{
+  FILE *Log, *Out = NULL, *Base = NULL;
+  char Line[LINE_MAX_CHARS], Now[LINE_MAX_CHARS], Then[LINE_MAX_CHARS];
+  uint16_t Plate, Solution;
+  float PlateV, SolutionV;
+  uint32_t Before, LineNum = 0;
+  Past Ring[AHEAD], Latest;
+  uint32_t Count = 0;
+  bool First = true, Differ = false, IsRaw = false;
+
+  if (!(Log = fopen(Path, "r")))
+  {
+    perror(Path);
+    return 2;
+  }
+  if ((OutDir && !(Out = OpenUnder(OutDir, Rel, "w"))) || (BaseDir && !(Base = OpenUnder(BaseDir, Rel, "r"))))
+    return 2;
+
+  SimProbeSource = Replay_Probe;
+  while (fgets(Line, sizeof(Line), Log))
+  {
+    LineNum++;
+    if (!strcmp(Line, "raw\n"))
+    {
+      IsRaw = true;
+      continue;
+    }
+    if (!Parse(Line, &Plate, &Solution))
+    {
+      __atomic_fetch_add(&Sum->Skipped, 1, __ATOMIC_RELAXED);
+      continue;
+    }
+
+    if (First)                                                     // Power up settled at the first reading
+    {
+      First = false;
+      Raw[OWTP_Plate] = Plate / 5;
+      Raw[OWTP_Solution] = Solution / 5;
+      PlateV = Raw[OWTP_Plate] * 5;
+      SolutionV = Raw[OWTP_Solution] * 5;
+      Sim_Start(&Config);
+    }
+    if (IsRaw)
+    {
+      Raw[OWTP_Plate] = Plate / 5;
+      Raw[OWTP_Solution] = Solution / 5;
+    }
+    else
+    {
+      Raw[OWTP_Plate] = Unfilter(&PlateV, Plate);
+      Raw[OWTP_Solution] = Unfilter(&SolutionV, Solution);
+    }
+
+    Before = Reads;
+    while (Reads == Before)                                        // Up to and including the pass which reads them
+      Sim_Pass();
+
+    Latest.Core = EstCore / 256.0;
+    Latest.Skin = EstSkin / 256.0;
+    Latest.Plate = Raw[OWTP_Plate] * 5;
+    Latest.Solution = Raw[OWTP_Solution] * 5;
+    Latest.At = MyMillis();
+    if (Count >= AHEAD)
+      Predict(Ring, Count % AHEAD, &Latest);
+    Ring[Count++ % AHEAD] = Latest;
+
+    snprintf(Now, sizeof(Now), "%u,%u,%u,%u\n", MainScreen.PlateTemp, MainScreen.SolutionTemp, MainScreen.PlateGoal,
+             PWM_Val);
+    __atomic_fetch_add(&Sum->Lines, 1, __ATOMIC_RELAXED);
+    if (Out)
+      fputs(Now, Out);
+    if (Base)
+    {
+      if (!fgets(Then, sizeof(Then), Base))
+        strcpy(Then, "(end)\n");
+      if (strcmp(Now, Then))
+      {
+        if (!Differ)                                               // The first difference is enough to go on
+          printf("%s:%lu: %.*s, baseline %s", Path, (unsigned long)LineNum, (int)strlen(Now) - 1, Now, Then);
+        Differ = true;
+        __atomic_fetch_add(&Sum->DiffLines, 1, __ATOMIC_RELAXED);
+      }
+    }
+  }
+  if (Base && fgets(Then, sizeof(Then), Base))
+  {
+    if (!Differ)
+      printf("%s: ends before the baseline\n", Path);
+    Differ = true;
+  }
+
+  __atomic_fetch_add(&Sum->EstReadings, EstReadings, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&Sum->EstErrorSq, EstErrorSq, __ATOMIC_RELAXED);
+
+  fclose(Log);
+  if (Out)
+    fclose(Out);
+  if (Base)
+    fclose(Base);
+  return Differ;
+}
+
+static void Replay_File(const char *Path, const char *Rel)
+{
+  pid_t Pid;
+  int Status;
+
+  fflush(stdout);
+  Pid = fork();
+  if (Pid == 0)
+  {
+    Status = Replay_Log(Path, Rel);
+    fflush(stdout);
+    _exit(Status);
+  }
+  if ((Pid < 0) || (waitpid(Pid, &Status, 0) < 0) || !WIFEXITED(Status) || (WEXITSTATUS(Status) > 1))
+  {
+    fprintf(stderr, "%s: replay failed\n", Path);
+    Sum->Failed++;
+    return;
+  }
+  Sum->Files++;
+  if (WEXITSTATUS(Status))
+    Sum->Differ++;
+}
+
+static bool IsLog(const char *Name)
+{
+  size_t Len = strlen(Name);
+
+  return (Name[0] != '.') && (Len > 4) && !strcmp(Name + Len - 4, ".txt");
+}
+
+// Replay Path, walking it if it is a directory.  Path from RelAt on is kept under the output directories.
+static void Replay_Path(char *Path, size_t RelAt, bool Named)
+{
+  struct stat st;
+  struct dirent *e;
+  DIR *d;
+  size_t Len = strlen(Path);
+
+  if (stat(Path, &st))
+  {
+    perror(Path);
+    Sum->Failed++;
+    return;
+  }
+  if (S_ISREG(st.st_mode) && (Named || IsLog(strrchr(Path, '/') ? strrchr(Path, '/') + 1 : Path)))
+    Replay_File(Path, Path + RelAt);
+  if (!S_ISDIR(st.st_mode) || !(d = opendir(Path)))
+    return;
+
+  while ((e = readdir(d)))
+  {
+    if (e->d_name[0] == '.')
+      continue;
+    if (Len + 1 + strlen(e->d_name) >= PATH_MAX)
+      continue;
+    Path[Len] = '/';
+    strcpy(Path + Len + 1, e->d_name);
+    Replay_Path(Path, RelAt, false);
+    Path[Len] = 0;
+  }
+  closedir(d);
+}
+
+static void Usage(void)
+{
+  fprintf(stderr, "usage: warmerreplay [-w out_dir] [-c baseline_dir] [-g goal_x10] [-f] [-v] log_or_dir ...\n");
+  exit(2);
+}
+
+int main(int argc, char **argv)
+{
+  char Path[PATH_MAX];
+  struct timespec Start, End;
+  const char *Name;
+  int opt, i;
+
+  Sim_Default(&Config);
+  Config.SensorFastInterval = Config.SensorInterval;               // One reading per line of the log
+  while ((opt = getopt(argc, argv, "w:c:g:fv")) != -1)
+  {
+    switch (opt)
+    {
+    case 'w': OutDir = optarg; break;
+    case 'c': BaseDir = optarg; break;
+    case 'g': Config.Goal = atoi(optarg); break;
+    case 'f': Config.Feedforward = true; break;
+    case 'v': SimVerbose = true; break;
+    default: Usage();
+    }
+  }
+  if (optind >= argc)
+    Usage();
+
+  Sum = mmap(NULL, sizeof(Totals), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (Sum == MAP_FAILED)
+  {
+    perror("mmap");
+    return 2;
+  }
+  memset(Sum, 0, sizeof(Totals));
+
+  clock_gettime(CLOCK_MONOTONIC, &Start);
+  for (i = optind; i < argc; i++)
+  {
+    snprintf(Path, sizeof(Path), "%s", argv[i]);
+    while ((strlen(Path) > 1) && (Path[strlen(Path) - 1] == '/'))
+      Path[strlen(Path) - 1] = 0;
+    Name = strrchr(Path, '/') ? strrchr(Path, '/') + 1 : Path;
+    Replay_Path(Path, Name - Path, true);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &End);
+
+  fprintf(stderr, "%u logs, %u lines (%u skipped) in %.2f s", Sum->Files, Sum->Lines, Sum->Skipped,
+          (End.tv_sec - Start.tv_sec) + ((End.tv_nsec - Start.tv_nsec) / 1e9));
+  if (BaseDir)
+    fprintf(stderr, ", %u differ from the baseline in %u lines", Sum->Differ, Sum->DiffLines);
+  if (Sum->Failed)
+    fprintf(stderr, ", %u failed", Sum->Failed);
+  fprintf(stderr, "\n");
+  if (Sum->EstReadings)
+    fprintf(stderr, "Solution readings predicted to %.2f C rms by the estimate", sqrt((double)Sum->EstErrorSq /
+            Sum->EstReadings) / 10);
+  if (Sum->Ahead)
+    fprintf(stderr, ", %d lines ahead to %.2f C by its model (%.2f C as the reading then)", AHEAD,
+            sqrt((double)Sum->AheadSq / Sum->Ahead) / 10, sqrt((double)Sum->HoldSq / Sum->Ahead) / 10);
+  if (Sum->EstReadings)
+    fprintf(stderr, "\n");
+  return (Sum->Differ || Sum->Failed) ? 1 : 0;
+}
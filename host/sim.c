@@ -0,0 +1,120 @@
+// One closed loop run of the unmodified control code in process.c against the thermal plant.
+//
+// The loop is the control half of MainLoop(): CheckSensors(), CheckSolution() and CheckHeater() (which also does
+// the software PWM), with virtual time moved on by SIM_STEP after each pass.  The screen and touch are left out.
+// How far the solution reading and the estimate of the solution inside the bag (estimate.c) are from the bag in the
+// plant is measured on the way.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include <stdio.h>                 // fprintf()
+#include <math.h>                  // fabsf()
+#include "Arduino_AL.h"            // MyMillis()
+#include "process.h"               // MainScreen and the Check functions
+#include "estimate.h"              // Estimate_Core()
+#include "sim.h"                   // Header for this file
+
+// The gains and intervals built into SolutionWarmer.ino and process.h, a litre bag from room temperature
+void Sim_Default(SimConfig *c)
+{
+  c->HeaterGains[0] = 10;
+  c->HeaterGains[1] = 0.0025;
+  c->HeaterGains[2] = 40;
+  c->LoadGains[0] = 12.0;
+  c->LoadGains[1] = 0.0013;
+  c->LoadGains[2] = 0.0;
+  c->SensorInterval = 5000;
+  c->SensorFastInterval = 800;
+  c->HeaterInterval = 5000;
+  c->SolutionInterval = 16000;
+  c->Goal = 375;
+  c->Feedforward = false;
+  c->BagMl = 1000;
+  c->Start = 20;
+  c->Duration = 3 * 3600000UL;
+}
+
+// Power up as configured and press Activate
+void Sim_Start(const SimConfig *c)
+{
+  Sim_Setup(c);
+  SetupMainScreen();
+  MainScreen.SolutionGoal = c->Goal;
+  MainScreen.Feedforward = c->Feedforward;
+  PID_Load_SetRange(MainScreen.SolutionGoal, 600);
+  PID_ClearAll();
+  MainScreen.Activated = true;
+}
+
+// One pass of the control half of MainLoop()
+void Sim_Pass(void)
+{
+  CheckSensors();
+  CheckSolution();
+  CheckHeater();
+  Sim_Advance(SIM_STEP);
+}
+
+void Sim_Run(const SimConfig *c, SimResult *r, FILE *Trace)
+{
+  float Goal = c->Goal / 10.0;
+  uint32_t NextTrace = 0;
+  uint32_t LastOut = 0;                                            // Last time the bag was outside the settling band
+  bool Outside = true;
+  double ReadSq = 0, EstSq = 0;
+  uint32_t Passes = 0, EstPasses = 0;
+  float e;
+
+  Sim_Start(c);
+
+  r->ReadySecs = -1;
+  r->ReadyBag = 0;
+  r->Overshoot = 0;
+  r->OverTemp = false;
+  r->ReadError = r->EstError = r->EstMax = 0;
+
+  if (Trace)
+    fprintf(Trace, "s,plate,bag,plate_read,bag_read,bag_est,plate_goal,pwm\n");
+
+  while (MyMillis() < c->Duration)
+  {
+    Sim_Pass();
+
+    if ((r->ReadySecs < 0) && MainScreen.Ready)
+    {
+      r->ReadySecs = MyMillis() / 1000.0;
+      r->ReadyBag = SimState.Bag;
+    }
+    if (MainScreen.SolutionTemp > MainScreen.SolutionGoal + 10)
+      r->OverTemp = true;
+    if (SimState.Bag - Goal > r->Overshoot)
+      r->Overshoot = SimState.Bag - Goal;
+    Outside = fabsf(SimState.Bag - Goal) > 0.5;
+    if (Outside)
+      LastOut = MyMillis();
+
+    e = (MainScreen.SolutionTemp / 10.0) - SimState.Bag;
+    ReadSq += e * e;
+    Passes++;
+    if (Estimate_Valid())
+    {
+      e = (Estimate_Core() / 10.0) - SimState.Bag;
+      EstSq += e * e;
+      EstPasses++;
+      if (fabsf(e) > r->EstMax)
+        r->EstMax = fabsf(e);
+    }
+
+    if (Trace && (MyMillis() >= NextTrace))
+    {
+      NextTrace += SIM_TRACE_EVERY;
+      fprintf(Trace, "%lu,%.2f,%.2f,%u,%u,%u,%u,%u\n", (unsigned long)(MyMillis() / 1000), SimState.Plate, SimState.Bag,
+              MainScreen.PlateTemp, MainScreen.SolutionTemp, Estimate_Core(), MainScreen.PlateGoal, PWM_Val);
+    }
+  }
+
+  r->SettleSecs = Outside ? -1 : LastOut / 1000.0;
+  r->EnergyWh = SimState.Energy / 3600;
+  r->ReadError = Passes ? sqrt(ReadSq / Passes) : 0;
+  r->EstError = EstPasses ? sqrt(EstSq / EstPasses) : -1;
+}
@@ -0,0 +1,77 @@
+#ifndef SIM_H
+#define SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>                   // Find integer types like "uint8_t"
+#include <stdbool.h>                  // Find type "bool"
+#include <stdio.h>                    // FILE
+#include "plant.h"
+
+#define SIM_STEP                  16  // mS of virtual time per pass of the loop - CheckPWMInterval
+#define SIM_TRACE_EVERY        60000  // mS between lines of a trace
+#define SIM_NV_SIZE             1024  // Bytes of EEPROM
+#define SIM_NV_WRITE_NS      3300000  // To write one of them
+#define SIM_STACK_PAINT        32768  // Bytes of stack painted by Mem_Paint() - up to 65535
+
+typedef struct {
+  float    HeaterGains[3];            // Kp, Ki, Kd
+  float    LoadGains[3];
+  uint32_t SensorInterval;            // mS - CheckSensorInterval and friends
+  uint32_t SensorFastInterval;
+  uint32_t HeaterInterval;
+  uint32_t SolutionInterval;
+  uint16_t Goal;                      // x10 degrees
+  bool     Feedforward;               // MainScreen.Feedforward
+  float    BagMl;
+  float    Start;                     // Degrees C of plate and bag at the start
+  uint32_t Duration;                  // mS of virtual time to run
+} SimConfig;
+
+typedef struct {
+  float    ReadySecs;                 // First READY, -1 for never
+  float    ReadyBag;                  // Degrees C the bag was at then
+  float    SettleSecs;                // Bag within 0.5 C of the goal from then on, -1 for never
+  float    Overshoot;                 // Degrees C the bag went over the goal
+  float    EnergyWh;                  // Heater energy
+  bool     OverTemp;                  // The app reported OVER TEMP
+  float    ReadError;                 // Degrees C rms the filtered solution reading was off the bag
+  float    EstError;                  // And the estimate of it (estimate.c) once valid, -1 for never valid
+  float    EstMax;                    // Degrees C the estimate was off at most
+} SimResult;
+
+extern PlantParms SimPlant;
+extern PlantState SimState;
+extern bool SimVerbose;               // Pass Log() output to stderr
+extern int16_t (*SimProbeSource)(uint8_t ProbeNum);  // Reads the probes instead of the plant when set
+extern const char *SimSdDir;          // Directory standing in for the SD card, NULL for no card
+extern uint32_t SimSpiNsPerByte;      // Virtual time each SPI byte takes, 0 for none
+extern uint32_t SimPassUs;            // Virtual time each pass of MainLoop() takes
+extern uint32_t SimRunUntil;          // mS of virtual time at which MainLoop() returns
+extern uint32_t SimPasses;            // Passes of MainLoop() made
+extern uint64_t SimSpiBusyNs;         // Virtual time the SPI bus was busy
+extern uint64_t SimSpiBlockedNs;      // Of that, time the CPU waited for it - the rest overlapped with other work
+extern uint8_t  SimNv[SIM_NV_SIZE];   // The EEPROM, erased by Sim_Setup()
+extern uint32_t SimNvWrites;          // Bytes written to it
+
+// host_al.cpp - the hardware abstraction layer of the host build
+void Sim_Setup(const SimConfig *c);
+void Sim_Advance(uint32_t ms);
+bool Sim_HeaterOn(void);
+bool Sim_Press(uint8_t Tag, uint16_t x, uint16_t y, uint32_t At, uint32_t Hold);
+void Sim_CalibrationTaps(void);       // Queue a tap on each calibration dot
+void setup(void);                     // As in SolutionWarmer.ino, ending in MainLoop()
+
+// sim.c
+void Sim_Default(SimConfig *c);
+void Sim_Start(const SimConfig *c);
+void Sim_Pass(void);
+void Sim_Run(const SimConfig *c, SimResult *r, FILE *Trace);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,34 @@
+// Forced into every file of the sketch built for the host (see CMakeLists.txt).
+//
+// The loop intervals of process.h and EVE_PUBLISH_BYTES of Eve2_81x.h become variables here, so the simulator can
+// sweep them without rebuilding.
+// The SPI counters of Eve2_81x.c are always on (warmerhost reports them).
+
+#ifndef SIM_CONFIG_H
+#define SIM_CONFIG_H
+
+#include <stdint.h>                   // Find integer types like "uint8_t"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern uint32_t SimSensorInterval;
+extern uint32_t SimSensorFastInterval;
+extern uint32_t SimHeaterInterval;
+extern uint32_t SimSolutionInterval;
+extern uint16_t SimPublishBytes;
+
+#define CheckSensorInterval   SimSensorInterval
+#define CheckSensorFastInterval SimSensorFastInterval
+#define CheckHeaterInterval   SimHeaterInterval
+#define CheckSolutionInterval SimSolutionInterval
+#define EVE_PUBLISH_BYTES     SimPublishBytes
+
+#define EVE_STATS
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
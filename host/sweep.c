@@ -0,0 +1,148 @@
+// Parallel sweep of simulator runs with a work stealing pool.
+//
+// process.c keeps its state in globals, so runs can not share an address space.  Each worker is a process and
+// each run is a child forked from its worker, which gives every run the pristine globals of the parent and lets
+// it drop its result straight into shared memory.
+//
+// The configurations are split evenly between the workers up front.  Each worker owns a range [Lo, Hi) of
+// configuration indices packed into one 64 bit word in shared memory, so both ends change with a single
+// compare and swap.  The owner takes from the bottom (Lo); once its range is empty it steals the top half of
+// another worker's range.  Runs differ a lot in cost (a settled run is cheap, a badly tuned one is not), so the
+// even split alone leaves cores idle at the end.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdio.h>                 // perror()
+#include <string.h>                // memcpy()
+#include <unistd.h>                // fork()
+#include <sys/mman.h>              // mmap()
+#include <sys/wait.h>              // waitpid()
+#include "sweep.h"                 // Header for this file
+
+#define RANGE(Lo, Hi)   (((uint64_t)(Hi) << 32) | (uint32_t)(Lo))
+#define RANGE_LO(r)     ((uint32_t)(r))
+#define RANGE_HI(r)     ((uint32_t)((r) >> 32))
+
+typedef struct {
+  uint64_t Range[SWEEP_MAX_WORKERS];
+  uint32_t Steals;
+} Pool;
+
+// Take the next configuration of our own range
+static int64_t Pool_Pop(Pool *p, uint8_t Me)
+{
+  uint64_t Old = __atomic_load_n(&p->Range[Me], __ATOMIC_ACQUIRE);
+
+  while (RANGE_LO(Old) < RANGE_HI(Old))
+  {
+    if (__atomic_compare_exchange_n(&p->Range[Me], &Old, RANGE(RANGE_LO(Old) + 1, RANGE_HI(Old)), false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+      return RANGE_LO(Old);
+  }
+  return -1;
+}
+
+// Move the top half of some other worker's range into ours.  Returns false when nobody has any work left.
+static bool Pool_Steal(Pool *p, uint8_t Me, uint8_t Workers)
+{
+  uint8_t i, Victim;
+  uint64_t Old, Empty;
+  uint32_t Lo, Hi, Mid;
+
+  for (i = 1; i < Workers; i++)
+  {
+    Victim = (Me + i) % Workers;
+    Old = __atomic_load_n(&p->Range[Victim], __ATOMIC_ACQUIRE);
+    while (RANGE_LO(Old) < RANGE_HI(Old))
+    {
+      Lo = RANGE_LO(Old);
+      Hi = RANGE_HI(Old);
+      Mid = Lo + ((Hi - Lo) / 2);                                    // A single configuration is taken whole
+      if (__atomic_compare_exchange_n(&p->Range[Victim], &Old, RANGE(Lo, Mid), false, __ATOMIC_ACQ_REL,
+                                      __ATOMIC_ACQUIRE))
+      {
+        // Our range is empty, and thieves leave empty ranges alone, so this can not race
+        Empty = __atomic_load_n(&p->Range[Me], __ATOMIC_ACQUIRE);
+        __atomic_compare_exchange_n(&p->Range[Me], &Empty, RANGE(Mid, Hi), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+        __atomic_fetch_add(&p->Steals, 1, __ATOMIC_RELAXED);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Do one configuration in a child of this worker
+static void Sweep_One(const SimConfig *c, SimResult *r)
+{
+  pid_t Pid = fork();
+
+  if (Pid == 0)
+  {
+    Sim_Run(c, r, NULL);
+    _exit(0);
+  }
+  if (Pid < 0)
+  {
+    perror("fork");
+    r->SettleSecs = r->ReadySecs = -1;
+    return;
+  }
+  waitpid(Pid, NULL, 0);
+}
+
+static void Sweep_Worker(Pool *p, uint8_t Me, uint8_t Workers, const SimConfig *Configs, SimResult *Results)
+{
+  int64_t Next;
+
+  do {
+    while ((Next = Pool_Pop(p, Me)) >= 0)
+      Sweep_One(&Configs[Next], &Results[Next]);
+  } while (Pool_Steal(p, Me, Workers));
+}
+
+int Sweep_Run(const SimConfig *Configs, SimResult *Results, uint32_t Count, uint8_t Workers)
+{
+  Pool *p;
+  SimResult *Shared;
+  uint32_t w;
+  pid_t Pids[SWEEP_MAX_WORKERS];
+
+  if (Workers < 1)
+    Workers = 1;
+  if (Workers > SWEEP_MAX_WORKERS)
+    Workers = SWEEP_MAX_WORKERS;
+
+  p = mmap(NULL, sizeof(Pool) + (Count * sizeof(SimResult)), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED)
+  {
+    perror("mmap");
+    return -1;
+  }
+  Shared = (SimResult *)(p + 1);
+  memset(p, 0, sizeof(Pool));
+  for (w = 0; w < Count; w++)
+    Shared[w].ReadySecs = Shared[w].SettleSecs = -1;               // What a run which died leaves
+
+  for (w = 0; w < Workers; w++)
+    p->Range[w] = RANGE(((uint64_t)Count * w) / Workers, ((uint64_t)Count * (w + 1)) / Workers);
+
+  for (w = 0; w < Workers; w++)
+  {
+    Pids[w] = fork();
+    if (Pids[w] == 0)
+    {
+      Sweep_Worker(p, w, Workers, Configs, Shared);
+      _exit(0);
+    }
+    if (Pids[w] < 0)                                                 // Its range gets stolen by the others
+      perror("fork");
+  }
+  for (w = 0; w < Workers; w++)
+    if (Pids[w] > 0)
+      waitpid(Pids[w], NULL, 0);
+
+  memcpy(Results, Shared, Count * sizeof(SimResult));
+  fprintf(stderr, "%u runs on %u workers, %u steals\n", Count, Workers, p->Steals);
+  munmap(p, sizeof(Pool) + (Count * sizeof(SimResult)));
+  return 0;
+}
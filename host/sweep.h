@@ -0,0 +1,21 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>                   // Find integer types like "uint8_t"
+#include "sim.h"
+
+#define SWEEP_MAX_WORKERS         64
+
+// Run every configuration on Workers processes.  Results land in the array of the same index.
+// Returns 0, or -1 if the pool could not be set up.
+int Sweep_Run(const SimConfig *Configs, SimResult *Results, uint32_t Count, uint8_t Workers);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
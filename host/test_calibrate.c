@@ -0,0 +1,118 @@
+// test_calibrate - the touch transform calibrate.c fits to the dots, and the fits it throws away.
+//
+// The panel here is not ideal: its raw readings are a skewed, flipped and offset affine map of the screen, which the
+// least squares fit should undo anywhere on the screen to within a raw step (4/3 px across).  A dot tapped well off, dots tapped in one
+// place and a recalibration nobody taps must all leave the matrix in the Eve as it was.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include <math.h>                  // fabs()
+#include "Arduino_AL.h"            // MyMillis()
+#include "Eve2_81x.h"              // REG_TOUCH_TRANSFORM_A
+#include "MatrixEve2Conf.h"        // DWIDTH
+#include "calibrate.h"             // Code under test
+#include "fake_eve.h"              // FakeEve_Tap()
+#include "sim.h"                   // Sim_Setup()
+#include "check.h"                 // CHECK()
+
+#define OLD       0x12345678       // In the transform registers until a calibration is accepted
+
+// Raw reading of the panel for screen position x, y
+static uint16_t RawX(int32_t x, int32_t y) { return 100 + ((x * 3) / 4) + (y / 10); }
+static uint16_t RawY(int32_t x, int32_t y) { return 900 - ((y * 3) / 2) + (x / 20); }
+
+static int32_t Matrix(uint8_t i)
+{
+  return (int32_t)FakeEve_rd32(REG_TOUCH_TRANSFORM_A + RAM_REG + (i * 4));
+}
+
+// Tap the dots from First on, Off pixels to the right of where dot Bad is
+static void Tap_Dots(uint8_t First, uint8_t Bad, int16_t Off)
+{
+  uint16_t x, y;
+  uint8_t i;
+
+  for (i = First; i < CAL_POINTS; i++)
+  {
+    Calibrate_Point(i, &x, &y);
+    if (i == Bad)
+      x += Off;
+    FakeEve_Tap(RawX(x, y), RawY(x, y));
+  }
+}
+
+// Let CheckCalibrate() take the queued taps, and some polls more
+static void Run(uint32_t Ms)
+{
+  uint32_t Until = MyMillis() + Ms;
+
+  while (MyMillis() < Until)
+  {
+    CheckCalibrate();
+    Sim_Advance(1);
+  }
+}
+
+static void Unchanged(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < 6; i++)
+    CHECK_EQ(Matrix(i), OLD);
+}
+
+int main(void)
+{
+  SimConfig Config;
+  double Worst = 0, Miss;
+  int32_t x, y;
+  uint16_t tx, ty;
+  uint8_t i;
+
+  Sim_Default(&Config);
+  Sim_Setup(&Config);
+  Eve_Reset();
+  FifoWriteLocation = 0;
+  for (i = 0; i < 6; i++)
+    FakeEve_wr32(REG_TOUCH_TRANSFORM_A + RAM_REG + (i * 4), OLD);
+
+  Calibrate_Start(true);
+  CHECK(Calibrate_Active());
+  Tap_Dots(0, 1, 40);                                              // Dot 2 tapped 40 px off - thrown away
+  Run(CAL_POINTS * 3 * CAL_POLL);
+  CHECK(Calibrate_Active());
+  Unchanged();
+
+  for (i = 0; i < CAL_POINTS; i++)                                 // All in one place - thrown away
+    FakeEve_Tap(RawX(200, 200), RawY(200, 200));
+  Run(CAL_POINTS * 3 * CAL_POLL);
+  CHECK(Calibrate_Active());
+  Unchanged();
+
+  Tap_Dots(0, 0, 2);                                               // 2 px off is within CAL_MAX_ERROR
+  Run(CAL_POINTS * 3 * CAL_POLL);
+  CHECK(!Calibrate_Active());
+
+  for (y = 0; y < DHEIGHT; y += 16)                                // Anywhere on the screen, not only on the dots
+    for (x = 0; x < DWIDTH; x += 16)
+    {
+      tx = RawX(x, y);
+      ty = RawY(x, y);
+      Miss = fabs(((((double)Matrix(0) * tx) + ((double)Matrix(1) * ty) + Matrix(2)) / 65536) - x);
+      if (Miss > Worst) Worst = Miss;
+      Miss = fabs(((((double)Matrix(3) * tx) + ((double)Matrix(4) * ty) + Matrix(5)) / 65536) - y);
+      if (Miss > Worst) Worst = Miss;
+    }
+  CHECK(Worst < 1.5);                                              // The raw x steps are 4/3 px
+  fprintf(stderr, "test_calibrate: fit within %.2f px\n", Worst);
+
+  for (i = 0; i < 6; i++)
+    FakeEve_wr32(REG_TOUCH_TRANSFORM_A + RAM_REG + (i * 4), OLD);
+  Calibrate_Start(false);                                          // Nobody taps - abandoned, matrix kept
+  Tap_Dots(3, CAL_POINTS, 0);                                      // Not even all the dots
+  Run(CAL_TIMEOUT + 100);
+  CHECK(!Calibrate_Active());
+  Unchanged();
+
+  return Check_Done("test_calibrate");
+}
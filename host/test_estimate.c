@@ -0,0 +1,146 @@
+// test_estimate - the arithmetic of the solution estimate (estimate.c) and the time to READY (eta.c), against
+// readings made from the very models they assume, where the right answers are known.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include <stdio.h>                 // sscanf()
+#include <stdlib.h>                // abs()
+#include <math.h>                  // fabs()
+#include "Arduino_AL.h"            // MyMillis()
+#include "process.h"               // CheckSensorInterval
+#include "estimate.h"              // Code under test
+#include "eta.h"
+#include "sim.h"                   // Sim_Setup()
+#include "check.h"                 // CHECK()
+
+extern int32_t EstP00, EstP01, EstP11;
+
+#define STEP      5000             // mS between readings
+
+static int16_t Raw(double Temp)    // x10 degrees to what the probe says, x2
+{
+  return (int16_t)lround(Temp / 5);
+}
+
+// A litre bag warming on a plate held at Plate, as estimate.h describes it, read every STEP from Start
+static void Estimate_Check(double Plate, double Start)
+{
+  double Core = Start, Skin = Start, Rate, dt = STEP / 1000.0;
+  double Worst = 0;
+  uint16_t i;
+
+  Estimate_Reset();
+  for (i = 0; i < 720; i++)                                        // An hour
+  {
+    Estimate_Update(Raw(Plate), Raw(Skin), i ? STEP : 0);
+    if (i >= 120 && fabs(Estimate_Core() - Core) > Worst)         // Settled after ten minutes
+      Worst = fabs(Estimate_Core() - Core);
+    Rate = (((Plate - Core) / EST_TAU_CORE) - ((Core - EST_AMBIENT) / EST_TAU_LOSS)) * 60;
+    Skin += ((Core - Skin) * dt) / EST_TAU_SKIN;
+    Core += (((Plate - Core) / EST_TAU_CORE) - ((Core - EST_AMBIENT) / EST_TAU_LOSS)) * dt;
+  }
+  CHECK(Estimate_Valid());
+  CHECK(Worst <= 4);                                               // 0.4 degrees, with 0.5 degree probe steps
+  CHECK(fabs(Estimate_Rate() - Rate) <= 1);                        // x10 degrees a minute
+  fprintf(stderr, "test_estimate: plate %.0f from %.0f - core within %.1f, rate %d for %.2f\n", Plate, Start, Worst,
+          Estimate_Rate(), Rate);
+}
+
+// Parse "12m 9-16" or "12m 9+" from Eta_Text().  Hi is ETA_UNKNOWN for the second.
+static bool Eta_Read(uint16_t *Min, uint16_t *Lo, uint16_t *Hi)
+{
+  char Buf[16];
+  unsigned m, l, h;
+
+  if (!Eta_Text(Buf))
+    return false;
+  *Hi = ETA_UNKNOWN;
+  if (sscanf(Buf, "%um %u-%u", &m, &l, &h) == 3)
+    *Hi = h;
+  else if (sscanf(Buf, "%um %u+", &m, &l) != 2)
+    return false;
+  *Min = m;
+  *Lo = l;
+  return true;
+}
+
+// A first order approach from x0 to Final (relative to the goal) closing Close of the distance each reading.
+// Returns the worst error in minutes of the estimates against the time READY actually comes.
+static double Eta_Approach(double x0, double Final, double Close, uint16_t *Made)
+{
+  uint16_t Goal = 375, Min, Lo, Hi, n, Ready;
+  double x, Worst = 0, Left;
+
+  Eta_Reset();
+  *Made = 0;
+  for (Ready = 0, x = x0; (x < -ETA_READY_BELOW) && (Ready < 2000); Ready++)   // The reading READY comes at, or
+    x = Final + ((x - Final) * (1 - Close));                                   // a few hours of never
+  for (n = 0, x = x0; n <= Ready; n++)
+  {
+    Eta_Update(Goal + x, Goal);
+    Sim_Advance(STEP);
+    if (Eta_Read(&Min, &Lo, &Hi))
+    {
+      CHECK(n + 1 >= ETA_MIN_SAMPLES);
+      CHECK((Lo <= Min) && ((Hi == ETA_UNKNOWN) || (Min <= Hi)));
+      Left = ((Ready - n) * (CheckSensorInterval / 1000.0)) / 60;
+      if (fabs(Min - Left) > Worst)
+        Worst = fabs(Min - Left);
+      (*Made)++;
+    }
+    x = Final + ((x - Final) * (1 - Close));
+  }
+  if (Ready < 2000)
+    CHECK(!Eta_Read(&Min, &Lo, &Hi));                              // Gone at READY
+  return Worst;
+}
+
+int main(void)
+{
+  SimConfig Config;
+  uint16_t Min, Lo, Hi, Made, i;
+  int32_t Core, Skin, P[3];
+
+  Sim_Default(&Config);
+  Sim_Setup(&Config);                                              // CheckSensorInterval of 5000
+
+  Estimate_Reset();
+  CHECK(!Estimate_Valid());
+  Estimate_Update(Raw(500), Raw(300), 0);                          // Starts at the first reading
+  CHECK_EQ(Estimate_Core(), 300);
+  CHECK(!Estimate_Valid());
+
+  Estimate_Check(EST_AMBIENT, EST_AMBIENT);                        // Nothing moves
+  CHECK_EQ(Estimate_Core(), EST_AMBIENT);
+  CHECK_EQ(Estimate_Rate(), 0);
+  Estimate_Check(450, 200);                                        // Warming
+  Estimate_Check(400, 300);
+
+  Core = EstCore; Skin = EstSkin;                                  // A long gap counts as EST_MAX_STEP
+  P[0] = EstP00; P[1] = EstP01; P[2] = EstP11;
+  Estimate_Update(Raw(400), Raw(380), EST_MAX_STEP);
+  i = Estimate_Core();
+  EstCore = Core; EstSkin = Skin;
+  EstP00 = P[0]; EstP01 = P[1]; EstP11 = P[2];
+  Estimate_Update(Raw(400), Raw(380), 10 * 60000UL);
+  CHECK_EQ(Estimate_Core(), i);
+
+  Eta_Reset();
+  CHECK(!Eta_Read(&Min, &Lo, &Hi));
+  CHECK(Eta_Approach(-150, 20, 0.01, &Made) <= 1.0);              // Heading 2 degrees past the goal
+  CHECK(Made > 100);
+  CHECK(Eta_Approach(-100, 50, 0.005, &Made) <= 1.0);
+  CHECK(Made > 100);
+  Eta_Approach(-150, -10, 0.01, &Made);                           // Heading for 1 degree short - never READY
+  CHECK_EQ(Made, 0);
+
+  Eta_Reset();                                                     // Still rising in a straight line
+  for (i = 0; i < ETA_MIN_SAMPLES + 10; i++)
+    Eta_Update(375 - 100 + (i * 0.5), 375);
+  CHECK(Eta_Read(&Min, &Lo, &Hi));
+  CHECK(abs((int)Min - (int)lround((((100 - 5) / 0.5) - (i - 1)) * 5 / 60.0)) <= 1);
+  Eta_Update(375 - 100 + (i * 0.5), 380);                          // A new goal starts again
+  CHECK(!Eta_Read(&Min, &Lo, &Hi));
+
+  return Check_Done("test_estimate");
+}
@@ -0,0 +1,142 @@
+// test_history - the zigzag varint ring of history.c, read back here with a decoder of its own, and the graph
+// History_Draw() builds from it in RAM_G.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include "Arduino_AL.h"            // SPI_AsyncWait()
+#include "Eve2_81x.h"              // END()
+#include "MatrixEve2Conf.h"        // VSIZE
+#include "history.h"               // Code under test
+#include "fake_eve.h"              // FakeEve_rd32()
+#include "sim.h"                   // Sim_Setup()
+#include "check.h"                 // CHECK()
+
+extern uint8_t  HistoryRing[HISTORY_BYTES];
+extern uint16_t HistoryHead, HistoryLen, HistoryCount;
+extern uint16_t HistoryBase[2], HistoryLast[2];
+extern uint8_t  HistoryCopy;
+
+#define SAMPLES   2000
+
+static uint16_t Plate[SAMPLES], Solution[SAMPLES];
+static uint16_t Added;
+
+static void Add(uint16_t p, uint16_t s)
+{
+  Plate[Added] = p;
+  Solution[Added++] = s;
+  History_Add(p, s);
+}
+
+static int16_t Get(uint16_t *Pos)
+{
+  uint16_t zz = 0;
+  uint8_t Shift = 0, b;
+
+  do {
+    b = HistoryRing[*Pos];
+    *Pos = (*Pos + 1) % HISTORY_BYTES;
+    zz |= (uint16_t)(b & 0x7F) << Shift;
+    Shift += 7;
+  } while (b & 0x80);
+  return (zz & 1) ? -(int16_t)((zz + 1) >> 1) : (int16_t)(zz >> 1);
+}
+
+// The ring must hold the newest HistoryCount samples added, in its HistoryLen bytes
+static void Check_Ring(void)
+{
+  uint16_t Pos = HistoryHead, p, s, i, First = Added - HistoryCount;
+
+  CHECK(HistoryLen <= HISTORY_BYTES);
+  CHECK_EQ(HistoryBase[0], Plate[First]);
+  CHECK_EQ(HistoryBase[1], Solution[First]);
+  p = HistoryBase[0];
+  s = HistoryBase[1];
+  for (i = First + 1; i < Added; i++)
+  {
+    p += Get(&Pos);
+    s += Get(&Pos);
+    if (!CHECK_EQ(p, Plate[i]) || !CHECK_EQ(s, Solution[i]))
+      return;
+  }
+  CHECK_EQ(Pos, (HistoryHead + HistoryLen) % HISTORY_BYTES);     // Every byte in use is a delta
+  CHECK_EQ(HistoryLast[0], Plate[Added - 1]);
+  CHECK_EQ(HistoryLast[1], Solution[Added - 1]);
+}
+
+// The two LINE_STRIPs History_Draw() left in RAM_G
+static void Check_Graph(void)
+{
+  uint32_t At = RAMG_HISTORY + (HistoryCopy * HISTORY_DL_MAX), Word, Last = 0;
+  uint16_t Vertices;
+  uint8_t t;
+
+  for (t = 0; t < 2; t++)
+  {
+    At += 4;                                                       // Colour
+    CHECK_EQ(FakeEve_rd32(At), BEGIN(LINE_STRIP));
+    for (Vertices = 0; (Word = FakeEve_rd32(At += 4)) != END(); Vertices++)
+    {
+      Last = Word;
+      if (Vertices > HISTORY_POINTS)
+        break;
+    }
+    At += 4;
+    CHECK(Vertices <= HISTORY_POINTS);
+    CHECK_EQ((Last >> 15) & 0x7FFF, HISTORY_X1 * 16);             // Ends on the newest sample at the right edge
+  }
+}
+
+static void Draw(void)
+{
+  History_Draw();
+  UpdateFIFO();
+  SPI_AsyncWait();
+}
+
+int main(void)
+{
+  SimConfig Config;
+  uint16_t i;
+
+  Sim_Default(&Config);
+  Sim_Setup(&Config);
+  Eve_Reset();
+  FifoWriteLocation = 0;
+  History_Clear();
+
+  Add(200, 200);
+  CHECK_EQ(History_Count(), 1);
+  CHECK_EQ(HistoryLen, 0);
+  for (i = 1; i <= 63; i++)                                        // Changes of up to 6.3 degrees take a byte
+    Add(200 + i, 200 - i);
+  CHECK_EQ(HistoryLen, 2 * 63);
+  Check_Ring();
+  Add(263 + 64, 137 - 65);                                         // +6.4 and -6.5 degrees take two
+  CHECK_EQ(HistoryLen, (2 * 63) + 4);
+  Add(327 + 8192, 72);                                             // Three for the most there can be
+  CHECK_EQ(HistoryLen, (2 * 63) + 4 + 4);
+  Add(327, 72);
+  Add(0, 0xFFFF);                                                  // Deltas wrap as the values do
+  Add(0xFFFF, 0);
+  Check_Ring();
+
+  for (i = 0; i < 1000; i++)                                       // Round the ring several times over
+    Add(300 + ((i * 7) % 90), 250 + ((i * 13) % 200));
+  CHECK(History_Count() < 1000);
+  Check_Ring();
+  Draw();
+  Check_Graph();
+
+  History_Clear();
+  Added = 0;
+  CHECK_EQ(History_Count(), 0);
+  Add(370, 370);
+  Draw();                                                          // One sample draws nothing
+  Add(371, 369);
+  Check_Ring();
+  Draw();
+  Check_Graph();
+
+  return Check_Done("test_history");
+}
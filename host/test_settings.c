@@ -0,0 +1,130 @@
+// test_settings - the EEPROM records of settings.c: saving, loading the newest good one, and falling back to the
+// one before it when the newest is spoilt or its sequence number has wrapped.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include <string.h>                // memcpy()
+#include "Arduino_AL.h"            // MyMillis()
+#include "settings.h"              // Code under test
+#include "sim.h"                   // SimNv
+#include "check.h"                 // CHECK()
+
+#define HEADER            6        // Sequence, Version, Length, CRC
+#define CRCED             4        // Bytes of the header under the CRC
+
+// CRC-16/CCITT, as settings.c should have it
+static uint16_t Crc(uint16_t Crc, uint8_t Byte)
+{
+  uint8_t i;
+
+  Crc ^= (uint16_t)Byte << 8;
+  for (i = 0; i < 8; i++)
+    Crc = (Crc & 0x8000) ? ((Crc << 1) ^ 0x1021) : (Crc << 1);
+  return Crc;
+}
+
+static uint16_t Sequence(uint8_t Slot)
+{
+  return SimNv[Slot * SETTINGS_SLOT] | (SimNv[(Slot * SETTINGS_SLOT) + 1] << 8);
+}
+
+// Give the record in Slot another sequence number, with the CRC to go with it
+static void Renumber(uint8_t Slot, uint16_t Seq)
+{
+  uint8_t *r = &SimNv[Slot * SETTINGS_SLOT];
+  uint16_t Sum = 0xFFFF;
+  uint8_t i;
+
+  r[0] = Seq;
+  r[1] = Seq >> 8;
+  for (i = 0; i < CRCED; i++)
+    Sum = Crc(Sum, r[i]);
+  for (i = 0; i < r[3]; i++)
+    Sum = Crc(Sum, r[HEADER + i]);
+  r[4] = Sum;
+  r[5] = Sum >> 8;
+}
+
+// Save Goal and let CheckSettings() write it, or only the first Bytes which change
+static void Save(uint16_t Goal, uint16_t Bytes)
+{
+  uint32_t Writes = SimNvWrites, Until;
+
+  Settings.Have |= SET_GOAL;
+  Settings.SolutionGoal = Goal;
+  Settings_Save();
+  CheckSettings();
+  Sim_Advance(SETTINGS_DELAY);
+  Until = MyMillis() + 1000;                                       // Plenty for a record at 3.3 mS a byte
+  while (((SimNvWrites - Writes) < Bytes) && (MyMillis() < Until))
+  {
+    CheckSettings();
+    Sim_Advance(1);
+  }
+}
+
+#define ALL       0xFFFF
+
+int main(void)
+{
+  SimConfig Config;
+  uint16_t Check;
+  uint8_t i;
+
+  Sim_Default(&Config);
+  Sim_Setup(&Config);                                              // Erased EEPROM
+  CHECK(!Settings_Load());
+  CHECK_EQ(Settings.Have, 0);
+
+  for (i = 0, Check = 0xFFFF; i < 9; i++)                          // The standard check value
+    Check = Crc(Check, "123456789"[i]);
+  CHECK_EQ(Check, 0x29B1);
+
+  Save(375, ALL);                                                  // Into slot 0 as sequence 1
+  CHECK_EQ(Sequence(0), 1);
+  Renumber(0, 1);                                                  // The CRC comes out the same as it was written
+  CHECK(Settings_Load());
+  CHECK_EQ(Settings.SolutionGoal, 375);
+  CHECK_EQ(Settings.Have, SET_GOAL);
+
+  Save(380, ALL);                                                  // Slot 1, sequence 2
+  CHECK_EQ(Sequence(1), 2);
+  CHECK(Settings_Load());
+  CHECK_EQ(Settings.SolutionGoal, 380);
+
+  SimNv[SETTINGS_SLOT + HEADER + 3] ^= 0x10;                       // Spoil the newest - the one before it loads
+  CHECK(Settings_Load());
+  CHECK_EQ(Settings.SolutionGoal, 375);
+  SimNv[SETTINGS_SLOT + HEADER + 3] ^= 0x10;
+
+  CHECK(Settings_Load());
+  Save(390, 4);                                                    // Cut short by a reset in slot 2
+  CHECK(Settings_Load());
+  CHECK_EQ(Settings.SolutionGoal, 380);
+  Save(395, ALL);                                                  // Written again in the slot after the good one
+  CHECK_EQ(Sequence(2), 3);
+  CHECK(Settings_Load());
+  CHECK_EQ(Settings.SolutionGoal, 395);
+
+  Renumber(0, 0xFFFC);                                             // The count wraps: 0xFFFF, 0, 1 come after 0xFFFE
+  Renumber(1, 0xFFFD);
+  Renumber(2, 0xFFFE);
+  CHECK(Settings_Load());
+  CHECK_EQ(Settings.SolutionGoal, 395);
+  Save(400, ALL);
+  Save(405, ALL);
+  Save(410, ALL);
+  CHECK_EQ(Sequence(5), 1);
+  CHECK(Settings_Load());
+  CHECK_EQ(Settings.SolutionGoal, 410);
+  SimNv[5 * SETTINGS_SLOT + HEADER + 3] ^= 0x10;                   // And the fallback goes back past the wrap
+  CHECK(Settings_Load());
+  CHECK_EQ(Settings.SolutionGoal, 405);
+
+  for (i = 0; i < 20; i++)                                         // Round all 16 slots and on
+    Save(300 + i, ALL);
+  CHECK(Settings_Load());
+  CHECK_EQ(Settings.SolutionGoal, 319);
+
+  return Check_Done("test_settings");
+}
@@ -0,0 +1,155 @@
+// test_widgets - what Eve2_Widgets.c sends, and when it re-encodes a widget rather than sending its cached words.
+//
+// What each widget shows is read back out of the FIFO of the fake Eve after Widgets_Send(), so what is checked is
+// what the coprocessor would draw.  The text values are pairs which a 16 bit checksum of the text cannot tell apart.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include <string.h>                // strcpy()
+#include "Arduino_AL.h"            // SPI_AsyncWait()
+#include "Eve2_81x.h"              // FifoWriteLocation
+#include "Eve2_Widgets.h"          // Code under test
+#include "fake_eve.h"              // FakeEve_rd32()
+#include "sim.h"                   // Sim_Setup()
+#include "check.h"                 // CHECK()
+
+static char Text[6], Label[16];
+static const char Cold[] PROGMEM = "20.0", Warm[] PROGMEM = "21.4";  // Same checksum, different places in flash
+static const char *Flash;
+static uint16_t Needle = 300;
+
+static Widget List[] = {
+//  Type             Tag  X    Y    W    H    Font          Options  Range Offset Scale Color                        Fill           Bind
+  { WIDGET_TEXT,      0,  50,  50,   0,   0, 27,           0,       5,    0,     0,    COLOR_RGB(0x88, 0xFF, 0x88), WIDGET_NOFILL, Text },
+  { WIDGET_BUTTON,   20,  50,  90, 120,  36, 27,           0,       15,   0,     0,    COLOR_RGB(0xFF, 0xAA, 0x55), 0xBB2222,      Label },
+  { WIDGET_BUTTON_P,  1, 230, 207, 124,  52, 29,           0,       15,   0,     0,    COLOR_RGB(0xAA, 0xFF, 0xAA), 0x222288,      &Flash },
+  { WIDGET_GAUGE,     0, 300, 200,  52,   0, (8 << 8) | 4, 0,       700,  0,     1,    COLOR_RGB(0xFF, 0xFF, 0xFF), WIDGET_NOFILL, &Needle } };
+
+#define COUNT(a)        (sizeof(a) / sizeof((a)[0]))
+#define GAUGE           (&List[3])
+
+// Sends the list and returns the FIFO offset of the Nth Cmd which went out, or FT_CMD_FIFO_SIZE for none
+static uint16_t Send_Find(uint32_t Cmd, uint8_t Nth)
+{
+  uint16_t From = FifoWriteLocation, At;
+
+  Widgets_Send(List, COUNT(List));
+  UpdateFIFO();
+  SPI_AsyncWait();
+  for (At = From; At != FifoWriteLocation; At = (At + 4) % FT_CMD_FIFO_SIZE)
+    if ((FakeEve_rd32(RAM_CMD + At) == Cmd) && !Nth--)
+      return At;
+  return FT_CMD_FIFO_SIZE;
+}
+
+// Sends the list and returns the text following the Nth CMD_TEXT or CMD_BUTTON which went out
+static const char *Sent(uint32_t Cmd, uint8_t Nth)
+{
+  static char Found[32];
+  uint16_t At = Send_Find(Cmd, Nth);
+  uint8_t i;
+
+  Found[0] = 0;
+  if (At == FT_CMD_FIFO_SIZE)
+    return Found;
+  At += (Cmd == CMD_TEXT) ? 12 : 16;                               // Past the command's own parameters
+  for (i = 0; (i < sizeof(Found) - 1) && (Found[i] = FakeEveMem[RAM_CMD + (At + i) % FT_CMD_FIFO_SIZE]); i++)
+    ;
+  Found[i] = 0;
+  return Found;
+}
+
+// Sends the list and returns the value the needle of the gauge went out at
+static uint16_t Sent_Gauge(void)
+{
+  uint16_t At = Send_Find(CMD_GAUGE, 0);
+
+  if (At == FT_CMD_FIFO_SIZE)
+    return 0xFFFF;
+  return FakeEve_rd32(RAM_CMD + ((At + 16) % FT_CMD_FIFO_SIZE));   // Value in the low half, range in the high
+}
+
+// Text goes from a to b and the Nth command of its kind must show b.  Bound is NULL for the button in flash.
+static void Change(char *Bound, uint32_t Cmd, uint8_t Nth, const char *a, const char *b)
+{
+  uint16_t Encodes;
+
+  if (Bound) strcpy(Bound, a); else Flash = a;
+  CHECK(!strcmp(Sent(Cmd, Nth), a));
+  if (Bound) strcpy(Bound, b); else Flash = b;
+  Encodes = WidgetEncodes;
+  CHECK(Widgets_Animate(List, COUNT(List)));
+  CHECK(!strcmp(Sent(Cmd, Nth), b));
+  CHECK_EQ(WidgetEncodes, Encodes + 1);
+  Encodes = WidgetEncodes;
+  CHECK(!Widgets_Animate(List, COUNT(List)));                      // And then nothing more changes
+  CHECK(!strcmp(Sent(Cmd, Nth), b));
+  CHECK_EQ(WidgetEncodes, Encodes);
+}
+
+// The needle eases to a new value a frame at a time, only ever patched in, never re-encoded.  Frames where it moves
+// less than a unit send nothing new, so the list is only sent when Widgets_Animate() says so, as the screen does.
+static void Gauge_Move(uint16_t To)
+{
+  uint16_t Encodes = WidgetEncodes, Patches = WidgetPatches, From = Needle, Was = Needle, Now, Frames, Sends = 0;
+
+  Needle = To;
+  for (Frames = 0; Frames < 200; Frames++)
+  {
+    if (!Widgets_Animate(List, COUNT(List)))
+      continue;
+    Now = Sent_Gauge();
+    CHECK((To > From) ? ((Now > Was) && (Now <= To)) : ((Now < Was) && (Now >= To)));  // Each send closer
+    Was = Now;
+    Sends++;
+  }
+  CHECK_EQ(Was, To);
+  CHECK(Sends >= (((To > From) ? (To - From) : (From - To)) > 1 ? 2 : 1));   // Eased, not jumped, unless 1 unit
+  CHECK_EQ(WidgetPatches - Patches, Sends);
+  CHECK_EQ(WidgetEncodes, Encodes);
+}
+
+int main(void)
+{
+  SimConfig Config;
+  uint16_t Encodes;
+
+  Sim_Default(&Config);
+  Sim_Setup(&Config);
+  Eve_Reset();
+  FifoWriteLocation = 0;
+
+  strcpy(Label, "READY");
+  Flash = Cold;
+  CHECK(Widgets_Init(List, COUNT(List)));
+  CHECK_EQ(Sent_Gauge(), 300);                                     // Needles start out at their values
+  CHECK_EQ(WidgetEncodes, COUNT(List));
+
+  Change(Text, CMD_TEXT, 0, "20.0", "21.4");
+  Change(Text, CMD_TEXT, 0, "36.1", "37.5");
+  Change(Text, CMD_TEXT, 0, "37.5", "7.5");                        // Shorter
+  Change(Text, CMD_TEXT, 0, "7.5", "");
+  Change(Text, CMD_TEXT, 0, "", "60.0");
+  Change(Label, CMD_BUTTON, 0, "30.2", "31.6");
+  Change(Label, CMD_BUTTON, 0, "Ready in 12 min", "Ready in 2 min");
+  Change(NULL, CMD_BUTTON, 1, Cold, Warm);
+  Change(NULL, CMD_BUTTON, 1, Warm, Cold);
+
+  Gauge_Move(375);
+  Gauge_Move(374);                                                 // The last fraction of a step is made at once
+  Gauge_Move(200);
+
+  Encodes = WidgetEncodes;                                         // The same colours change nothing
+  Widget_SetColor(GAUGE, GAUGE->Color, GAUGE->Fill);
+  CHECK(!Widgets_Animate(List, COUNT(List)));
+  Widget_SetColor(GAUGE, COLOR_RGB(0xFF, 0, 0), GAUGE->Fill);      // Other ones re-encode just that widget
+  CHECK(Widgets_Animate(List, COUNT(List)));
+  CHECK_EQ(Sent_Gauge(), 200);
+  CHECK_EQ(WidgetEncodes, Encodes + 1);
+  Widget_Invalidate(&List[0]);
+  CHECK(Widgets_Animate(List, COUNT(List)));
+  CHECK(!strcmp(Sent(CMD_TEXT, 0), "60.0"));
+  CHECK_EQ(WidgetEncodes, Encodes + 2);
+
+  return Check_Done("test_widgets");
+}
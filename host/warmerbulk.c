@@ -0,0 +1,131 @@
+// warmerbulk - throughput of CoProWrCmdBuf() against the simulated Eve.
+//
+//   warmerbulk [-k kbytes] [-s spi_ns_per_byte] [-c copro_ns_per_byte]
+//
+// For each size of caller buffer (the chunk) and each EVE_PUBLISH_BYTES, a CMD_INFLATE and -k kilobytes (256 by
+// default) of data after it go through CoProWrCmdBuf() a chunk at a time, the way Load_JPG() sends a file.  The
+// time from the first byte to the coprocessor having taken the last is virtual: -s per byte over SPI (800 nS, 10 MHz
+// by default) and -c per byte the coprocessor takes out of the FIFO (100 nS by default, 0 for instantly).  What is
+// printed is the data rate as a percentage of the SPI line rate.
+//
+// The fake coprocessor keeps a checksum of what it takes from the FIFO, which has to come out as that of the data
+// (padded to whole words at the end of each chunk) for the run to count.  The exit status is 1 if any did not.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include <stdio.h>                 // printf()
+#include <stdlib.h>                // atoi()
+#include <unistd.h>                // getopt()
+#include "Arduino_AL.h"            // MyMicros()
+#include "Eve2_81x.h"              // CoProWrCmdBuf()
+#include "fake_eve.h"              // The coprocessor's checksum
+#include "sim.h"                   // Host build of the sketch
+
+static const uint32_t Chunks[] = { 16, 64, 256, 1024, 4096, 16384, 1001 };    // 1001 pads every chunk
+static const uint16_t Publish[] = { 128, 256, 512, 1024, 2048, 4092 };
+
+#define COUNT(a)        (sizeof(a) / sizeof((a)[0]))
+
+static uint8_t *Data;
+static uint32_t Size;
+static SimConfig Config;
+
+static uint32_t Sum_Word(uint32_t Sum, uint32_t Word)
+{
+  uint8_t i;
+
+  for (i = 0; i < 4; i++)
+    Sum = FakeEve_Sum(Sum, Word >> (i * 8));
+  return Sum;
+}
+
+// Sends all of Data in pieces of Chunk.  Returns the virtual uS it took, or 0 if the coprocessor got something else.
+static uint32_t Run(uint32_t Chunk)
+{
+  uint32_t Sent, Len, Start, i;
+  uint32_t Expect = 0;                                             // FakeEveCmdSum after a reset
+
+  Start = MyMicros();
+  Send_CMD(CMD_INFLATE);
+  Send_CMD(0);                                                     // RAM_G address
+  Expect = Sum_Word(Sum_Word(Expect, CMD_INFLATE), 0);
+  for (Sent = 0; Sent < Size; Sent += Len)
+  {
+    Len = ((Size - Sent) > Chunk) ? Chunk : (Size - Sent);
+    CoProWrCmdBuf(Data + Sent, Len);
+    for (i = 0; i < ((Len + 3) & ~3UL); i++)
+      Expect = FakeEve_Sum(Expect, (i < Len) ? Data[Sent + i] : 0);
+  }
+  Wait4CoProFIFOEmpty();
+
+  return (FakeEveCmdSum == Expect) ? (MyMicros() - Start) : 0;
+}
+
+static void Usage(void)
+{
+  fprintf(stderr, "usage: warmerbulk [-k kbytes] [-s spi_ns_per_byte] [-c copro_ns_per_byte]\n");
+  exit(2);
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t CmdNs = 100, Us, i, j;
+  double Line;
+  bool Bad = false;
+  int opt;
+
+  Sim_Default(&Config);
+  Size = 256 * 1024;
+  SimSpiNsPerByte = 800;
+
+  while ((opt = getopt(argc, argv, "k:s:c:")) != -1)
+  {
+    switch (opt)
+    {
+    case 'k': Size = atoi(optarg) * 1024; break;
+    case 's': SimSpiNsPerByte = atoi(optarg); break;
+    case 'c': CmdNs = atoi(optarg); break;
+    default: Usage();
+    }
+  }
+  if (!Size || !SimSpiNsPerByte)
+    Usage();
+
+  Data = malloc(Size);
+  for (i = 0; i < Size; i++)
+    Data[i] = (i * 2654435761UL) >> 24;                            // Anything but a repeating pattern
+  Line = 1e3 / SimSpiNsPerByte;                                    // Bytes per uS
+
+  printf("%lu KB, SPI %lu nS/byte, coprocessor %lu nS/byte - %% of SPI line rate\n", (unsigned long)(Size / 1024),
+         (unsigned long)SimSpiNsPerByte, (unsigned long)CmdNs);
+  printf("  chunk");
+  for (j = 0; j < COUNT(Publish); j++)
+    printf("  pub %4u", Publish[j]);
+  printf("\n");
+
+  for (i = 0; i < COUNT(Chunks); i++)
+  {
+    printf("  %5lu", (unsigned long)Chunks[i]);
+    for (j = 0; j < COUNT(Publish); j++)
+    {
+      Sim_Setup(&Config);                                          // Clock and fake Eve from scratch
+      Eve_Reset();
+      FifoWriteLocation = 0;
+      FakeEveCmdNsPerByte = CmdNs;
+      SimPublishBytes = Publish[j];
+
+      Us = Run(Chunks[i]);
+      if (Us)
+        printf("  %7.1f%%", 100.0 * Size / (Us * Line));
+      else
+      {
+        printf("  %8s", "BAD");
+        Bad = true;
+      }
+    }
+    printf("\n");
+  }
+
+  free(Data);
+  return Bad;
+}
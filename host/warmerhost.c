@@ -0,0 +1,128 @@
+// warmerhost - the whole firmware running on the host, from setup() on, against the simulated warmer.
+//
+//   warmerhost [-d sd_dir] [-e eeprom_file] [-t minutes] [-a] [-p tag@seconds ...] [-s spi_ns_per_byte]
+//              [-u pass_us] [-v]
+//
+// Everything SolutionWarmer.ino does is done, screens and touch included, on the fake Eve and the thermal plant,
+// for the given minutes of virtual time (60 by default).  -d is the SD card; without one the firmware runs as it
+// would with no card fitted, calibrating the touch screen at each start.  -e keeps the EEPROM in a file, read at
+// the start and written at the end, so what one run saves the next one boots with.  -a presses Activate two seconds
+// in and -p presses any other tag (the calibration dots which pressing TAG_CALIBRATE brings up are then tapped).
+// Virtual time moves by -u for each pass of MainLoop() and by -s for each byte over SPI (800 ns, 10 MHz by default),
+// on top of the delays the firmware makes.
+//
+// At the end the SPI traffic is reported: how long the bus was busy and how much of that the CPU spent waiting
+// (SPI_WriteAsync() transfers run on while the firmware carries on), what Eve_RunBatch() saved, and how many frames
+// were sent and how many were not as the screen was standing still.  So is the time spent in each power state with
+// its estimated current (power.c), and how deep the stack went, found by Mem_Paint() as on the board.  A press after
+// the display has gone dark only wakes it, as on the board.
+//
+// The run is deterministic, which makes it a fair subject for perf, valgrind and before/after timings.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include <stdio.h>                 // printf()
+#include <stdlib.h>                // atoi()
+#include <string.h>                // memset()
+#include <unistd.h>                // getopt()
+#include <time.h>                  // clock_gettime()
+#include "Arduino_AL.h"            // MyMillis()
+#include "MatrixEve2Conf.h"        // DWIDTH
+#include "process.h"               // MainScreen
+#include "Eve2_81x.h"              // EveStats
+#include "screens.h"               // FramesSent
+#include "Eve2_Widgets.h"          // WidgetPatches
+#include "power.h"                 // PowerDuties
+#include "fake_eve.h"              // Traffic counts
+#include "sim.h"                   // Host build of the sketch
+
+#define PRESS_HOLD       300       // mS a scripted finger stays down
+
+static const char *PowerName[POWER_STATES] = { "on", "dim", "off" };
+
+static void Usage(void)
+{
+  fprintf(stderr, "usage: warmerhost [-d sd_dir] [-e eeprom_file] [-t minutes] [-a] [-p tag@seconds ...] "
+          "[-s spi_ns_per_byte] [-u pass_us] [-v]\n");
+  exit(2);
+}
+
+int main(int argc, char **argv)
+{
+  SimConfig Config;
+  struct timespec Start, End;
+  const char *NvFile = NULL;
+  FILE *f;
+  double Wall, Virtual;
+  unsigned Tag;
+  float At;
+  int opt, i;
+
+  Sim_Default(&Config);
+  Sim_Setup(&Config);
+  SimRunUntil = 60 * 60000UL;
+  SimSpiNsPerByte = 800;
+
+  while ((opt = getopt(argc, argv, "d:e:t:ap:s:u:v")) != -1)
+  {
+    switch (opt)
+    {
+    case 'd': SimSdDir = optarg; break;
+    case 'e': NvFile = optarg; break;
+    case 't': SimRunUntil = atof(optarg) * 60000; break;
+    case 'a': Sim_Press(1, DWIDTH / 2, DHEIGHT / 2, 2000, PRESS_HOLD); break;
+    case 'p':
+      if ((sscanf(optarg, "%u@%f", &Tag, &At) != 2) || !Sim_Press(Tag, DWIDTH / 2, DHEIGHT / 2, At * 1000, PRESS_HOLD))
+        Usage();
+      break;
+    case 's': SimSpiNsPerByte = atoi(optarg); break;
+    case 'u': SimPassUs = atoi(optarg); break;
+    case 'v': SimVerbose = true; break;
+    default: Usage();
+    }
+  }
+
+  if (NvFile && (f = fopen(NvFile, "rb")))                         // Left erased if there is no file yet
+  {
+    if (fread(SimNv, 1, sizeof(SimNv), f) != sizeof(SimNv))
+      memset(SimNv, 0xFF, sizeof(SimNv));
+    fclose(f);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &Start);
+  setup();                                                         // Returns when virtual time is up
+  clock_gettime(CLOCK_MONOTONIC, &End);
+
+  if (NvFile)
+  {
+    if (!(f = fopen(NvFile, "wb")) || (fwrite(SimNv, 1, sizeof(SimNv), f) != sizeof(SimNv)))
+      fprintf(stderr, "Could not write %s\n", NvFile);
+    if (f)
+      fclose(f);
+  }
+
+  Wall = (End.tv_sec - Start.tv_sec) + ((End.tv_nsec - Start.tv_nsec) / 1e9);
+  Virtual = MyMillis() / 1000.0;
+  fprintf(stderr, "%.0f s of virtual time in %.2f s (%.0fx real time), %lu passes of MainLoop\n", Virtual, Wall,
+          Virtual / Wall, (unsigned long)SimPasses);
+  fprintf(stderr, "SPI: %lu transactions, %lu bytes (%.0f bytes per virtual second)\n",
+          (unsigned long)FakeEveTransactions, (unsigned long)FakeEveBytes, FakeEveBytes / Virtual);
+  fprintf(stderr, "SPI busy %.0f ms, CPU waiting on it %.0f ms (%.0f%% overlapped)\n", SimSpiBusyNs / 1e6,
+          SimSpiBlockedNs / 1e6, SimSpiBusyNs ? 100.0 * (SimSpiBusyNs - SimSpiBlockedNs) / SimSpiBusyNs : 0.0);
+  fprintf(stderr, "Batches: %lu of %lu ops (largest %u) in %lu frames, %lu address and dummy bytes saved\n",
+          (unsigned long)EveStats.Batches, (unsigned long)EveStats.BatchOps, EveStats.BatchMax,
+          (unsigned long)EveStats.BatchFrames, (unsigned long)EveStats.BatchSaved);
+  fprintf(stderr, "Frames: %lu sent, %lu not sent as nothing had changed, %u needle moves patched in\n",
+          (unsigned long)FramesSent, (unsigned long)FramesSkipped, WidgetPatches);
+  for (i = 0; i < POWER_STATES; i++)
+    if (PowerDuties[i].Ms)
+      fprintf(stderr, "Power %s: %.0f s, MCU asleep %.0f%%, about %u mA\n", PowerName[i], PowerDuties[i].Ms / 1000.0,
+              100.0 * PowerDuties[i].SleepMs / PowerDuties[i].Ms, Power_Current(i));
+  if (FakeEveStandbyAccesses)
+    fprintf(stderr, "Eve: %lu transactions made while it was in standby\n", (unsigned long)FakeEveStandbyAccesses);
+  fprintf(stderr, "EEPROM: %lu bytes written\n", (unsigned long)SimNvWrites);
+  fprintf(stderr, "Stack: %u bytes deep at most (on this machine)\n", Mem_StackUsed());
+  fprintf(stderr, "Plate %.1f C, bag %.1f C, %s, %.1f Wh\n", SimState.Plate, SimState.Bag,
+          MainScreen.Activated ? "activated" : "not activated", SimState.Energy / 3600);
+  return 0;
+}
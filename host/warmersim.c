@@ -0,0 +1,142 @@
+// warmersim - closed loop simulator of the Solution Warmer for tuning on a PC.
+//
+//   warmersim [-r [-d sd_dir]] [-f] [-j workers] [-t hours] [-b bag_ml] [-s start_C] [-g goal_x10] [-v]
+//
+// With -r a single run with the gains and intervals of the sketch is made and its trace written as CSV.  -d gives
+// it an SD card, so the pidlog.txt the sketch writes can be had from there.
+// Otherwise a grid of gains and loop intervals around those is swept on all cores and one CSV line per
+// configuration is written, followed by a summary on stderr.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include <stdio.h>                 // printf()
+#include <stdlib.h>                // atoi()
+#include <unistd.h>                // getopt()
+#include <time.h>                  // clock_gettime()
+#include "Arduino_AL.h"            // FileRemove()
+#include "sim.h"                   // Simulator runs
+#include "sweep.h"                 // Parallel sweep
+
+static const float    Scales[] = { 0.5, 1, 2 };                  // Applied to each swept gain
+static const uint32_t SolutionIntervals[] = { 8000, 16000, 32000 };
+static const uint32_t HeaterIntervals[] = { 2500, 5000 };
+
+#define COUNT(a)  (sizeof(a) / sizeof((a)[0]))
+#define GRID      (COUNT(Scales) * COUNT(Scales) * COUNT(Scales) * COUNT(Scales) * COUNT(SolutionIntervals) * COUNT(HeaterIntervals))
+
+static double Now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+// Make configuration number n of the grid from the base one
+static void Grid_Config(const SimConfig *Base, uint32_t n, SimConfig *c)
+{
+  *c = *Base;
+  c->HeaterGains[0] *= Scales[n % COUNT(Scales)];   n /= COUNT(Scales);
+  c->HeaterGains[1] *= Scales[n % COUNT(Scales)];   n /= COUNT(Scales);
+  c->LoadGains[0]   *= Scales[n % COUNT(Scales)];   n /= COUNT(Scales);
+  c->LoadGains[1]   *= Scales[n % COUNT(Scales)];   n /= COUNT(Scales);
+  c->SolutionInterval = SolutionIntervals[n % COUNT(SolutionIntervals)];  n /= COUNT(SolutionIntervals);
+  c->HeaterInterval = HeaterIntervals[n % COUNT(HeaterIntervals)];
+}
+
+static void Usage(void)
+{
+  fprintf(stderr, "usage: warmersim [-r [-d sd_dir]] [-f] [-j workers] [-t hours] [-b bag_ml] [-s start_C] [-g goal_x10] [-v]\n");
+  exit(2);
+}
+
+int main(int argc, char **argv)
+{
+  SimConfig Base, *Configs;
+  SimResult *Results;
+  SimResult One;
+  bool Single = false;
+  int Workers = sysconf(_SC_NPROCESSORS_ONLN);
+  int Best = -1;
+  double Start, Wall;
+  uint32_t i;
+  int opt;
+
+  Sim_Default(&Base);
+  while ((opt = getopt(argc, argv, "rd:fj:t:b:s:g:v")) != -1)
+  {
+    switch (opt)
+    {
+    case 'r': Single = true; break;
+    case 'd': SimSdDir = optarg; break;
+    case 'f': Base.Feedforward = true; break;
+    case 'j': Workers = atoi(optarg); break;
+    case 't': Base.Duration = atof(optarg) * 3600000; break;
+    case 'b': Base.BagMl = atof(optarg); break;
+    case 's': Base.Start = atof(optarg); break;
+    case 'g': Base.Goal = atoi(optarg); break;
+    case 'v': SimVerbose = true; break;
+    default: Usage();
+    }
+  }
+  if (SimSdDir && !Single)                                         // The runs of a sweep would share the card
+    Usage();
+
+  Start = Now();
+  if (Single)
+  {
+    FileRemove("pidlog.txt");                                      // As setup() does
+    Sim_Run(&Base, &One, stdout);
+    Wall = Now() - Start;
+    fprintf(stderr, "ready %.0f s (bag %.2f C), settled %.0f s, overshoot %.2f C, %.1f Wh%s\n", One.ReadySecs,
+            One.ReadyBag, One.SettleSecs, One.Overshoot, One.EnergyWh, One.OverTemp ? ", OVER TEMP" : "");
+    fprintf(stderr, "bag off by %.2f C rms as read, %.2f C rms (%.2f C at most) as estimated\n", One.ReadError,
+            One.EstError, One.EstMax);
+    fprintf(stderr, "%.1f simulated hours in %.2f s (%.0fx real time)\n", Base.Duration / 3.6e6, Wall,
+            (Base.Duration / 1000.0) / Wall);
+    return 0;
+  }
+
+  Configs = malloc(GRID * sizeof(SimConfig));
+  Results = malloc(GRID * sizeof(SimResult));
+  if (!Configs || !Results)
+    return 1;
+  for (i = 0; i < GRID; i++)
+    Grid_Config(&Base, i, &Configs[i]);
+
+  if (Sweep_Run(Configs, Results, GRID, Workers))
+    return 1;
+  Wall = Now() - Start;
+
+  printf("heater_kp,heater_ki,load_kp,load_ki,heater_ms,solution_ms,ready_s,ready_bag_c,settle_s,overshoot_c,energy_wh,"
+         "over_temp\n");
+  for (i = 0; i < GRID; i++)
+  {
+    SimConfig *c = &Configs[i];
+    SimResult *r = &Results[i];
+
+    printf("%g,%g,%g,%g,%lu,%lu,%.0f,%.2f,%.0f,%.2f,%.1f,%d\n", c->HeaterGains[0], c->HeaterGains[1], c->LoadGains[0],
+           c->LoadGains[1], (unsigned long)c->HeaterInterval, (unsigned long)c->SolutionInterval, r->ReadySecs,
+           r->ReadyBag, r->SettleSecs, r->Overshoot, r->EnergyWh, r->OverTemp);
+
+    // Fastest to READY which settles, stays out of OVER TEMP and overshoots by less than the 1 degree band
+    if ((r->ReadySecs >= 0) && (r->SettleSecs >= 0) && !r->OverTemp && (r->Overshoot < 1.0) &&
+        ((Best < 0) || (r->ReadySecs < Results[Best].ReadySecs)))
+      Best = i;
+  }
+
+  fprintf(stderr, "%.0f simulated hours in %.1f s (%.0fx real time)\n", (GRID * (Base.Duration / 3.6e6)), Wall,
+          (GRID * (Base.Duration / 1000.0)) / Wall);
+  if (Best >= 0)
+    fprintf(stderr, "best: heater Kp %g Ki %g, load Kp %g Ki %g, heater %lu ms, solution %lu ms: ready %.0f s, "
+            "settled %.0f s, overshoot %.2f C, %.1f Wh\n", Configs[Best].HeaterGains[0], Configs[Best].HeaterGains[1],
+            Configs[Best].LoadGains[0], Configs[Best].LoadGains[1], (unsigned long)Configs[Best].HeaterInterval,
+            (unsigned long)Configs[Best].SolutionInterval, Results[Best].ReadySecs, Results[Best].SettleSecs,
+            Results[Best].Overshoot, Results[Best].EnergyWh);
+  else
+    fprintf(stderr, "no configuration settled without overshoot\n");
+
+  free(Configs);
+  free(Results);
+  return 0;
+}
@@ -0,0 +1,109 @@
+// Online first order plus dead time (FOPDT) model of the solution, and the feedforward worked out from it.
+//
+// Each CheckSolution() step the solution moves by
+//     Solution[k] - Solution[k-1] = a * (Plate[k-1-d] - Solution[k-1])
+// i.e. it heads for the plate temperature with a time constant of CheckSolutionInterval / a, after a dead time of
+// d steps.  For every candidate d a least squares estimate of a is kept with exponential forgetting, and the d
+// whose fit has the smallest residual is the model.
+//
+// The feedforward predicts where the solution will be once the plate heat already applied has arrived (the dead
+// time) and asks for the plate demand that would close the rest of the error in MODEL_STEPS steps.  What it adds
+// to the PID is the part of that demand beyond the goal itself, so it is zero once settled and negative when the
+// solution is predicted to pass the goal.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include <stdio.h>                 // sprintf() for Log()
+#include "Arduino_AL.h"            // Log()
+#include "process.h"               // CheckSolutionInterval
+#include "model.h"                 // Header for this file
+
+float    ModelSxx[MODEL_DELAYS];   // Forgetting sums of x*x, x*y and y*y for each dead time
+float    ModelSxy[MODEL_DELAYS];
+float    ModelSyy[MODEL_DELAYS];
+uint16_t PlateHist[MODEL_DELAYS];  // Plate temperatures of the last steps, newest first
+uint16_t LastSolution;
+uint8_t  ModelSamples = 0;
+uint8_t  ModelDelay = 0;           // Best dead time in steps
+float    ModelGain = 0;            // a of the best dead time
+
+// Add a step of plate and solution temperatures (x10 degrees) - call every CheckSolutionInterval
+void Model_Update(uint16_t Plate, uint16_t Solution)
+{
+  float x, y;
+  float Best = 0, Residual;
+  uint8_t d;
+
+  if (ModelSamples)
+  {
+    y = (float)Solution - LastSolution;
+    for (d = 0; d < MODEL_DELAYS; d++)
+    {
+      x = (float)PlateHist[d] - LastSolution;
+      ModelSxx[d] = (ModelSxx[d] * MODEL_FORGET) + (x * x);
+      ModelSxy[d] = (ModelSxy[d] * MODEL_FORGET) + (x * y);
+      ModelSyy[d] = (ModelSyy[d] * MODEL_FORGET) + (y * y);
+    }
+  }
+
+  for (d = MODEL_DELAYS - 1; d > 0; d--)
+    PlateHist[d] = PlateHist[d - 1];
+  PlateHist[0] = Plate;
+  LastSolution = Solution;
+  if (ModelSamples < 255)
+    ModelSamples++;
+
+  // Pick the dead time which explains the solution best
+  for (d = 0; d < MODEL_DELAYS; d++)
+  {
+    if (ModelSxx[d] <= 0)
+      continue;
+    Residual = ModelSyy[d] - ((ModelSxy[d] * ModelSxy[d]) / ModelSxx[d]);
+    if ((d == 0) || (Residual < Best))
+    {
+      Best = Residual;
+      ModelDelay = d;
+    }
+  }
+  if (ModelSxx[ModelDelay] > 0)
+    ModelGain = ModelSxy[ModelDelay] / ModelSxx[ModelDelay];
+}
+
+// The model has seen enough to be used
+bool Model_Valid(void)
+{
+  return ((ModelSamples > MODEL_DELAYS + 4) && (ModelSxx[ModelDelay] > MODEL_MIN_SXX) &&
+          (ModelGain > MODEL_MIN_GAIN) && (ModelGain < MODEL_MAX_GAIN));
+}
+
+// Plate demand (x10 degrees) to add to the output of the load PID.  0 when the model is not ready.
+int16_t Model_Feedforward(uint16_t Goal, uint16_t Solution)
+{
+  float Predicted = Solution;
+  float Extra;
+  uint8_t i;
+
+  if (!Model_Valid())
+    return 0;
+
+  for (i = 0; i < ModelDelay; i++)                                 // Heat on its way through the dead time
+    Predicted += ModelGain * ((float)PlateHist[i] - Solution);
+
+  Extra = ((1 / (ModelGain * MODEL_STEPS)) - 1) * (Goal - Predicted);
+  if (Extra > 600)
+    Extra = 600;
+  if (Extra < -600)
+    Extra = -600;
+  return (int16_t)Extra;
+}
+
+void Model_Log(void)
+{
+  // Gain x10000 and time constant in seconds since there is no %f on AVR
+  long Tau = (ModelGain > 0) ? (long)(CheckSolutionInterval / (1000 * ModelGain)) : 0L;
+
+  if (Model_Valid())
+    Log("Model a %ld d %u tau %ld s\n", (long)(ModelGain * 10000), ModelDelay, Tau);
+  else
+    Log("Model a %ld d %u tau %ld s (not valid)\n", (long)(ModelGain * 10000), ModelDelay, Tau);
+}
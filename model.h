@@ -0,0 +1,27 @@
+#ifndef MODEL_H
+#define MODEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>                   // Find integer types like "uint8_t"
+#include <stdbool.h>                  // Find type "bool"
+
+#define MODEL_DELAYS               8  // Dead times tried, 0 to 7 steps of CheckSolutionInterval (0 to 112 S)
+#define MODEL_FORGET            0.98  // Weight of the past per step - about 13 minutes of memory
+#define MODEL_MIN_SXX         5000.0  // Excitation (sum of squared plate to solution differences) before the model is used
+#define MODEL_MIN_GAIN         0.001  // Plausible range of the solution gain per step
+#define MODEL_MAX_GAIN           0.5
+#define MODEL_STEPS                8  // Steps in which the feedforward aims to close the predicted error
+
+void Model_Update(uint16_t Plate, uint16_t Solution);
+bool Model_Valid(void);
+int16_t Model_Feedforward(uint16_t Goal, uint16_t Solution);
+void Model_Log(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
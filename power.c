@@ -0,0 +1,185 @@
+// Idle power manager.
+//
+// While the warmer is not activated, nobody touching the screen for POWER_DIM_AFTER fades the backlight down to
+// POWER_DIMMED, and for POWER_OFF_AFTER fades it out and puts the Eve in standby.  Any touch brings it all back at
+// full brightness.  In standby the Eve's touch engine stops with its clock, and no interrupt line from the Eve is
+// wired on this board, so every POWER_POLL the Eve is woken for POWER_SETTLE to take a touch sample: that bounds the
+// time a touch on the dark screen takes to wake it.  The touch which woke the display is not taken as a press
+// (Power_Touch() stays false until it lifts).
+//
+// Between passes of MainLoop() the MCU sleeps (MCU_Sleep()) - to the next millisecond while on, and for up to
+// POWER_NAP, never past the next step here, when dim or off.  Nothing else the firmware runs when not activated
+// needs finer timing than that.
+//
+// Time in each state is counted, with how much of it the MCU slept, the Eve was active and the backlight was lit,
+// from which Power_Current() estimates the average current the state draws (POWER_MA_xxx in power.h).
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include "Eve2_81x.h"              // Matrix Orbital Eve2 Driver
+#include "Arduino_AL.h"            // MCU_Sleep() MyMillis()
+#include "process.h"               // MainScreen
+#include "screens.h"               // Screen_Refresh()
+#include "calibrate.h"             // Calibrate_Active()
+#include "power.h"                 // Header for this file
+
+uint8_t   PowerState = POWER_ON;
+PowerDuty PowerDuties[POWER_STATES];
+
+static uint8_t  Duty = POWER_BRIGHT;   // REG_PWM_DUTY as last written
+static bool     Standby;               // Eve is in HCMD_STANDBY, or only awake for a touch check
+static bool     Polling;               // Eve has been woken for a touch check
+static bool     HoldTouch;             // The touch which woke the display has not lifted yet
+static uint32_t LastActivity;          // MyMillis() of the last touch, or of the warmer being active
+static uint32_t Time2CheckPower = 0;   // Next fade step or touch check
+static uint32_t Counted;               // MyMillis() the duty counters are up to
+static uint32_t LightPart;             // mS x duty not yet counted in LightMs
+static uint32_t SleepPart;             // uS of sleep not yet counted in SleepMs
+
+// Bring the duty counters of the current state up to now
+static void Power_Count(void)
+{
+  PowerDuty *d = &PowerDuties[PowerState];
+  uint32_t Ms = MyMillis() - Counted;
+
+  Counted += Ms;
+  d->Ms += Ms;
+  if (!Standby || Polling)
+    d->EveMs += Ms;
+  LightPart += Ms * Duty;
+  d->LightMs += LightPart / POWER_BRIGHT;
+  LightPart %= POWER_BRIGHT;
+}
+
+static void Power_Enter(uint8_t State)
+{
+  Power_Count();
+  Log("Power %u to %u (%u mA averaged in %u)\n", PowerState, State, Power_Current(PowerState), PowerState);
+  PowerState = State;
+}
+
+static void Power_Light(uint8_t Level)
+{
+  Power_Count();
+  Duty = Level;
+  wr8(REG_PWM_DUTY + RAM_REG, Level);
+}
+
+// Something is going on - a touch, or the warmer being active.  The display comes back on at once.
+void Power_Wake(void)
+{
+  LastActivity = MyMillis();
+  if (PowerState == POWER_ON)
+    return;
+
+  if (Standby)
+  {
+    Power_Count();
+    if (!Polling)
+    {
+      HostCommand(HCMD_ACTIVE);
+      MyDelay(POWER_SETTLE);
+    }
+    Standby = Polling = false;
+    Screen_Refresh();                                           // Frames were not sent while it slept
+  }
+  Power_Enter(POWER_ON);
+  Power_Light(POWER_BRIGHT);
+}
+
+// The Eve is awake and the screen may be drawn
+bool Power_Display(void)
+{
+  return !Standby;
+}
+
+// Touches may be acted on
+bool Power_Touch(void)
+{
+  return !Standby && !HoldTouch;
+}
+
+// Average current of a state so far in mA, from the duty counters
+uint16_t Power_Current(uint8_t State)
+{
+  const PowerDuty *d = &PowerDuties[State];
+
+  if (!d->Ms)
+    return 0;
+  return (((float)POWER_MA_MCU * (d->Ms - d->SleepMs)) + ((float)POWER_MA_MCU_IDLE * d->SleepMs) +
+          ((float)POWER_MA_EVE * d->EveMs) + ((float)POWER_MA_EVE_STANDBY * (d->Ms - d->EveMs)) +
+          ((float)POWER_MA_BACKLIGHT * d->LightMs)) / d->Ms;
+}
+
+// Fade, go to standby, check for touch in standby - and sleep until there is something to do
+void CheckPower(void)
+{
+  uint32_t Idle, Until, Start;
+  uint8_t Level;
+
+  if (MainScreen.Activated || Calibrate_Active())               // Never idle while warming (autotuning activates too)
+    Power_Wake();
+
+  if (MyMillis() >= Time2CheckPower)
+  {
+    Time2CheckPower = MyMillis() + POWER_FADE_INTERVAL;
+    if (Polling)                                                // The Eve has had POWER_SETTLE to sample the touch screen
+    {
+      if (rd32(REG_TOUCH_RAW_XY + RAM_REG) != 0xFFFFFFFF)
+      {
+        HoldTouch = true;
+        Power_Wake();
+      }
+      else
+      {
+        Power_Count();
+        HostCommand(HCMD_STANDBY);
+        Polling = false;
+        Time2CheckPower = MyMillis() + POWER_POLL - POWER_SETTLE;
+      }
+    }
+    else if (Standby)
+    {
+      Power_Count();
+      HostCommand(HCMD_ACTIVE);
+      Polling = true;
+      Time2CheckPower = MyMillis() + POWER_SETTLE;
+    }
+    else
+    {
+      if (HoldTouch && (rd32(REG_TOUCH_RAW_XY + RAM_REG) == 0xFFFFFFFF))
+        HoldTouch = false;
+
+      Idle = MyMillis() - LastActivity;
+      if ((PowerState == POWER_ON) && (Idle >= POWER_DIM_AFTER))
+        Power_Enter(POWER_DIM);
+      if ((PowerState == POWER_DIM) && (Idle >= POWER_OFF_AFTER))
+        Power_Enter(POWER_OFF);
+
+      Level = (PowerState == POWER_ON) ? POWER_BRIGHT : (PowerState == POWER_DIM) ? POWER_DIMMED : 0;
+      if (Duty > Level)
+        Power_Light(((Duty - Level) > POWER_FADE) ? (Duty - POWER_FADE) : Level);
+      else if ((PowerState == POWER_OFF) && !HoldTouch)         // Faded out
+      {
+        Wait4CoProFIFOEmpty();                                  // Let the coprocessor finish the last frame
+        Power_Count();
+        HostCommand(HCMD_STANDBY);
+        Standby = true;
+        Time2CheckPower = MyMillis() + POWER_POLL;
+      }
+    }
+  }
+
+  Power_Count();
+  if (MainScreen.Activated)
+    return;
+  Until = MyMillis() + ((PowerState == POWER_ON) ? 1 : POWER_NAP);
+  if (Until > Time2CheckPower)
+    Until = Time2CheckPower;
+  Start = MyMicros();
+  MCU_Sleep(Until);
+  Power_Count();
+  SleepPart += MyMicros() - Start;
+  PowerDuties[PowerState].SleepMs += SleepPart / 1000;
+  SleepPart %= 1000;
+}
@@ -0,0 +1,55 @@
+#ifndef POWER_H
+#define POWER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>                   // Find integer types like "uint8_t"
+#include <stdbool.h>                  // Find type "bool"
+
+// Power states
+#define POWER_ON                   0  // Backlight full, screen drawn as usual
+#define POWER_DIM                  1  // Backlight dimmed, screen still drawn and touch working
+#define POWER_OFF                  2  // Backlight off and Eve in standby - touch is checked every POWER_POLL
+#define POWER_STATES               3
+
+#define POWER_DIM_AFTER        60000  // in mS without a touch while not activated
+#define POWER_OFF_AFTER       300000  // in mS
+#define POWER_BRIGHT             128  // REG_PWM_DUTY when on
+#define POWER_DIMMED              16  // REG_PWM_DUTY when dim
+#define POWER_FADE                 4  // REG_PWM_DUTY steps of a fade, one every POWER_FADE_INTERVAL
+#define POWER_FADE_INTERVAL       20  // in mS
+#define POWER_POLL               100  // in mS - touch check in standby, the most a touch waits to wake the display
+#define POWER_SETTLE               5  // in mS - Eve woken up for a touch check gets this long to take a sample
+#define POWER_NAP                 10  // in mS - longest MCU sleep at a time when dim or off
+
+// Current estimates for the duty counters, in mA.  Typical figures for this board from the data sheets - measure
+// the board to have the averages mean more.
+#define POWER_MA_MCU              15  // ATmega328P running at 16 MHz, 5 V
+#define POWER_MA_MCU_IDLE          4  // ATmega328P in SLEEP_MODE_IDLE
+#define POWER_MA_EVE              35  // FT81x active, display scanned out
+#define POWER_MA_EVE_STANDBY       2  // FT81x in HCMD_STANDBY
+#define POWER_MA_BACKLIGHT       250  // at REG_PWM_DUTY 128, in proportion below that
+
+typedef struct {
+  uint32_t Ms;                        // Time spent in the state
+  uint32_t SleepMs;                   // Of that, time the MCU slept
+  uint32_t EveMs;                     // Time the Eve was active (not in standby)
+  uint32_t LightMs;                   // Backlight on time as if it were at full brightness
+} PowerDuty;
+
+extern uint8_t   PowerState;
+extern PowerDuty PowerDuties[POWER_STATES];
+
+void Power_Wake(void);
+bool Power_Display(void);
+bool Power_Touch(void);
+uint16_t Power_Current(uint8_t State);
+void CheckPower(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
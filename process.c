@@ -9,91 +9,109 @@
 // 
 
 #include <stdint.h>                // Find integer types like "uint8_t"  
+#include <string.h>                // strcpy_P() where flash is ordinary memory
 #include "Eve2_81x.h"              // Matrix Orbital Eve2 Driver
 #include "Arduino_AL.h"            // include the hardware specific abstraction layer header for the specific hardware in use.
 #include "MatrixEve2Conf.h"        // Header for EVE2 Display configuration settings
+#include "Eve2_Widgets.h"          // Retained widgets
+#include "screens.h"               // Screen manager
+#include "history.h"               // Temperature history
+#include "autotune.h"              // PID autotuner
+#include "model.h"                 // Solution model and feedforward
+#include "eta.h"                   // Time to READY estimate
+#include "settings.h"              // The goal is kept over power cycles
+#include "calibrate.h"             // Touch screen calibration
+#include "power.h"                 // Idle power manager
+#include "estimate.h"              // Solution temperature inside the bag
 #include "process.h"               // Every c file has it's header and this is the one for this file
 
 uint32_t Time2CheckSensor = 0;     // Private variable holding time of next reading of the temperature sensors 
+uint32_t Time2Report = 0;          // Private variable holding time of next ETA update and READY beep - every CheckSensorInterval
+uint32_t LastSensor = 0;           // Private variable holding time of the last reading, for the filter weight
+uint16_t SensorInterval;           // Private variable - CheckSensorInterval or CheckSensorFastInterval
+uint16_t Sounded = 0;              // Private variable - the alert last played, 0 after UNREADY
 uint32_t Time2CheckSolution = 0;   // Private variable holding time of next check of the solution heat request PID loop
 uint32_t Time2CheckHeater = 0;     // Private variable holding time of next check of the heater power request PID loop
 uint32_t Time2CheckTouch = 0;      // Private variable holding time of next check for user input
 uint32_t Time2UpdateScreen = 0;    // Private variable holding time of next screen update
 uint32_t Time2CheckPWM = 0;        // Private variable holding time of next PWM sub-period (in resolution of CheckPWMInterval)
+uint32_t Time2CheckHistory = CheckHistoryInterval; // Private variable holding time of next history sample - the first waits for the filter to settle
 uint32_t PressTimeout = 0;         // Private variable counting down time you can spend pressing the screen
 uint8_t  PWM_Base_Count = 0;       // Private variable - The timebase is pre-chosen to be 256 counts
 uint8_t  PWM_Val;                  // Private variable - this is the "on time" per PWM base period in CheckPWMInterval counts
 float HeaterVal;                   // Private variable - holds a float version of the current temperature of the plate                 
 float SolutionVal;                 // Private variable - holds a float version of the current temperature of the solution 
+float SolutionRate = 0;            // Private variable - x10 degrees per minute over the last SensorRateWindow
+float RateFrom;                    // Private variable - SolutionVal at RateTime
+uint32_t RateTime = 0;             // Private variable holding time the rate window started
+int16_t PlateRaw, SolutionRaw;     // Private variable - the last probe readings as they came (x2), for pidlog.txt
 uint16_t SaveCount = 0;
+FileHandle PidLog = FILE_NONE;     // Private variable - pidlog.txt, open while readings are being written to it
+#ifdef PROFILE_SCREEN
+uint32_t ProfileTime = 0;          // Private variable accumulating time spent building screens
+uint8_t  ProfileFrames = 0;        // Private variable counting the screens built
+#endif
 
 ScreenParms MainScreen;            // Global parameters related to the singular screen of the application
 
+const char Text_Activate[]   PROGMEM = "Activate";
+const char Text_Deactivate[] PROGMEM = "Deactivate";
+const char Text_Ready[]      PROGMEM = "READY";
+const char Text_OverTemp[]   PROGMEM = "OVER TEMP";
+const char Text_Unready[]    PROGMEM = "UNREADY";
+const char Text_Pid[]        PROGMEM = "PID";
+const char Text_PidFF[]      PROGMEM = "PID+FF";
+
+// The main screen is the gradient, kept in RAM_G by the screen manager (screens.c), with a list of retained widgets
+// on top (see Eve2_Widgets.c).  Each widget is only encoded again when the value or text it is bound to changes, so
+// building a frame mostly consists of sending the cached words.
+//
 // This screen construction is built to work with the screen rotated.  Due to the fact that the screen has a "natural" size in
 // the y direction (VSIZE) which is different than its actual size (DHEIGHT), rotating a screen made "natural" will shift it
 // off of the real screen.  The required translation looks like: Ynatural + (VSIZE - DHEIGHT)
-void MakeScreen_Main(void)
+#define MW_PLATEGOAL  0                      // Index of widgets in MainWidgets[] with colours that change
+#define MW_READY      9
+#define MW_COUNT     10
+Widget MainWidgets[MW_COUNT] = {
+//  Type             Tag  X    Y                    W    H    Font      Options                  Range Offset Scale Color                        Fill           Bind
+  { WIDGET_GAUGE,     0,  57, 211,                  52,   0, (8 << 8) | 4, 0,                   700,  0,    1,    COLOR_RGB(0x88, 0x88, 0x88), 0x444444,      &MainScreen.PlateGoal },      // Grey needle for the plate temperature goal - BG shows heater state
+  { WIDGET_GAUGE,     0,  57, 211,                  52,   0, (8 << 8) | 4, OPT_NOBACK|OPT_NOTICKS, 700,  0,    1,    COLOR_RGB(0xFF, 0xFF, 0xFF), WIDGET_NOFILL, &MainScreen.PlateTemp },      // White needle for plate temperature
+  { WIDGET_TEXT,      0,  57, 248,                   0,   0, 27,       OPT_CENTER,              5,    0,    0,    COLOR_RGB(0x88, 0xFF, 0x88), WIDGET_NOFILL, MainScreen.PlateTempText },
+  { WIDGET_GAUGE,     0, 165, 211,                  52,   0, (8 << 8) | 4, 0,                   200, -200,  1,    COLOR_RGB(0x88, 0x88, 0x88), 0x222288,      &MainScreen.SolutionGoal },   // Solution gauges start at 20 degrees (see notes at top of file)
+  { WIDGET_GAUGE,     0, 165, 211,                  52,   0, (8 << 8) | 4, OPT_NOBACK|OPT_NOTICKS, 200, -200,  1,    COLOR_RGB(0xFF, 0xFF, 0xFF), WIDGET_NOFILL, &MainScreen.SolutionTemp },
+  { WIDGET_TEXT,      0, 165, 248,                   0,   0, 27,       OPT_CENTER,              5,    0,    0,    COLOR_RGB(0x88, 0xFF, 0x88), WIDGET_NOFILL, MainScreen.SolutionTempText },
+  { WIDGET_BUTTON_P,  1, 230, 207,                 124,  52, 29,       0,                       15,   0,    0,    COLOR_RGB(0xAA, 0xFF, 0xAA), 0x222288,      &MainScreen.ButtonText },     // Activation button - tag 1
+  { WIDGET_DIAL,     11, 421, 211,                  52,   0, 0,        0,                       0,    0,    327,  COLOR_RGB(0xFF, 0xFF, 0xFF), WIDGET_NOFILL, &MainScreen.SolutionGoal },   // Setpoint dial - tag 11.  327 = 65536/200 where 200 is the range of the dial
+  { WIDGET_TEXT,      0, 421, 211,                   0,   0, 28,       OPT_CENTER,              5,    0,    0,    COLOR_RGB(0x88, 0xFF, 0x88), WIDGET_NOFILL, MainScreen.GoalText },
+  { WIDGET_BUTTON,   20, 230, 6 + (VSIZE-DHEIGHT), 124,  36, 27,       OPT_FLAT,                15,   0,    0,    COLOR_RGB(0xFF, 0xAA, 0x55), 0xBB2222,      MainScreen.ReadyText },       // Ready indicator - tag 20 (TAG_NEXTSCREEN)
+};
+
+static void MainScreen_Colors(void)
 {
-//  Log("Enter Makescreen\n");
-
-  Send_CMD(CMD_DLSTART);
-  Send_CMD(CLEAR(1,1,1));
-
-  Cmd_Gradient(194, 21, 0x007FFF, 250, 280, 0x70FF00);                                // Diagonal gradient blueish to yellowish
-
-  Cmd_FGcolor(0x222288);                                                              // Clear color before starting the screen
-  //==================== Plate Gauge setup and implementation ============================
   if(MainScreen.HeaterOn)
-    Cmd_BGcolor(0x992222);                                                            // Reddish colour indicates heater is on
+    Widget_SetColor(&MainWidgets[MW_PLATEGOAL], COLOR_RGB(0x88, 0x88, 0x88), 0x992222);    // Reddish colour indicates heater is on
   else
-    Cmd_BGcolor(0x444444);                                                            // Grey colour indicates heater is off
-
-  Send_CMD(COLOR_RGB( 0x88, 0x88, 0x88));                                             // Change color of plate temperature goal needle
-  Cmd_Gauge(57, 211, 52, 0, 4, 8, MainScreen.PlateGoal, 700);                         // Show gauge needle on top for plate temperature goal
-  Send_CMD(COLOR_RGB(0xFF, 0xFF, 0xFF));                                              // Change color of needle
-  Cmd_Gauge(57, 211, 52, OPT_NOBACK|OPT_NOTICKS, 4, 8, MainScreen.PlateTemp, 700);    // Show gauge for plate temperature
-  Send_CMD(COLOR_RGB( 0x88, 0xFF, 0x88));                                             // Change color of text temperature display
-  Cmd_Text(57, 248, 27, OPT_CENTER, MainScreen.PlateTempText);                        // display the modified string on top of the control
-
-  //==================== Solution Gauge setup and implementation ==========================
-  Cmd_BGcolor(0x222288);                                                              // Background colour of the solution gauge
-
-  Send_CMD(COLOR_RGB( 0x88, 0x88, 0x88));                                             // Change color of solution temperature goal needle
-  Cmd_Gauge(165, 211, 52, 0, 4, 8, MainScreen.SolutionGoal-200, 200);                 // Show Gauge needle on top for solution temperature goal (see notes at top of file)
-  Send_CMD(COLOR_RGB( 0xFF, 0xFF, 0xFF));                                             // Change color of needle
-  Cmd_Gauge(165,211,52,OPT_NOBACK|OPT_NOTICKS,4,8, MainScreen.SolutionTemp-200, 200); // Show gauge for solution temperature 
-  Send_CMD(COLOR_RGB( 0x88, 0xFF, 0x88));                                             // Change color of text temperature display
-  Cmd_Text(165, 248, 27, OPT_CENTER, MainScreen.SolutionTempText);                    // display the modified string on top of the control
-
-  //=================== Activation button setup and implementation ========================
-  Send_CMD(COLOR_RGB( 0xAA, 0xFF, 0xAA));                                             // Change color of Text
-  Send_CMD(TAG(1));                                                                   // Tag the following button as a touch region with a return value of 1
-  Cmd_Button(230, 207, 124, 52, 29, 0, MainScreen.ButtonText);
-
-  //================ Setpoint selection dial setup and implementation =====================
-  Send_CMD(COLOR_RGB( 0xFF, 0xFF, 0xFF));                                             // Change color of Dial Indicator
-  Cmd_Track(421, 211, 1, 1, 11);                                                      // Make a tracker matching the following tag of 11
-  Send_CMD(TAG(11));                                                                  // Tag the following dial with a return value of 11
-  Cmd_Dial(421, 211, 52, 0, MainScreen.SolutionGoal * 327);                           // 327 = pre-calculated scaling factor = 65536/200 where 200 is the range of the dial
-  Send_CMD(COLOR_RGB( 0x88, 0xFF, 0x88));                                             // Change color of text goal display
-  Cmd_Text(421, 211, 28, OPT_CENTER, MainScreen.GoalText);                            // display the modified string on top of the control
-
-  //==================== Ready Indicator setup and implementation =========================
+    Widget_SetColor(&MainWidgets[MW_PLATEGOAL], COLOR_RGB(0x88, 0x88, 0x88), 0x444444);    // Grey colour indicates heater is off
+
   if(MainScreen.Ready)
-  {
-    Cmd_FGcolor(0x00AA11);                                                            // Greenish colour indicates ready
-    Send_CMD(COLOR_RGB( 0x55, 0xFF, 0xBB));                                           // Change color of Text
-  }
+    Widget_SetColor(&MainWidgets[MW_READY], COLOR_RGB(0x55, 0xFF, 0xBB), 0x00AA11);        // Greenish colour indicates ready
   else
-  {
-    Cmd_FGcolor(0xBB2222);                                                            // Reddish colour indicates not ready
-    Send_CMD(COLOR_RGB( 0xFF, 0xAA, 0x55));                                           // Change color of Text
-  }
-  Cmd_Button(230, 6 + (VSIZE-DHEIGHT), 124, 36, 27, OPT_FLAT, MainScreen.ReadyText);
+    Widget_SetColor(&MainWidgets[MW_READY], COLOR_RGB(0xFF, 0xAA, 0x55), 0xBB2222);        // Reddish colour indicates not ready
+}
+
+void MakeScreen_Main(void)
+{
+//  Log("Enter Makescreen\n");
 
-  Send_CMD(DISPLAY());
-  Send_CMD(CMD_SWAP);
-  UpdateFIFO();                                                                      // Trigger the CoProcessor to start processing commands out of the FIFO
+  MainScreen_Colors();
+  Widgets_Send(MainWidgets, MW_COUNT);                                               // Re-encode what changed and send them all
+}
+
+// Move the needles on and say whether the main screen now looks any different (see Screen_Update())
+bool MainScreen_Changed(void)
+{
+  MainScreen_Colors();
+  return Widgets_Animate(MainWidgets, MW_COUNT);
 }
 
 void SetupMainScreen(void)
@@ -108,23 +126,45 @@ void SetupMainScreen(void)
   HeaterVal = MainScreen.PlateTemp * 5;                              // multiply the temperature by 10 to simulate a decimal place
   MainScreen.SolutionTemp = readTempProbe(OWTP_Solution);            // read the temp probe and initiate next measurement (comes in x2)
   SolutionVal = MainScreen.SolutionTemp * 5;                         // multiply the temperature by 10 to simulate a decimal place
+  SensorInterval = CheckSensorInterval;
+  LastSensor = RateTime = MyMillis();
+  RateFrom = SolutionVal;
   
   MainScreen.PlateGoal = 450;
-  MainScreen.SolutionGoal = 375;
+  MainScreen.SolutionGoal = (Settings.Have & SET_GOAL) ? Settings.SolutionGoal : 375;   // Where the user left it
   MainScreen.Activated = false;
-  sprintf(MainScreen.GoalText, "37.5");
-  sprintf(MainScreen.ButtonText, "Activate");
+  MainScreen.Feedforward = false;
+  sprintf_P(MainScreen.GoalText, PSTR("%d"), MainScreen.SolutionGoal);
+  InsertDecimal(MainScreen.GoalText);
+  MainScreen.ButtonText = Text_Activate;
   PID_Load_SetRange(MainScreen.SolutionGoal, 600);                   // set range of heater demand to safe levels.  Specified x10 in celsius
 
   MainScreen.Ready = false;
+  Widgets_Init(MainWidgets, MW_COUNT);
 }
 
 void CheckScreen(void)
 {
+  if (Calibrate_Active() || !Power_Display())                          // The calibration dots are on the display, or
+    return;                                                            // the Eve is in standby
   if (MyMillis() >= Time2UpdateScreen)
   {
-    Time2UpdateScreen = MyMillis() + ScreenUpdateInterval;
-    MakeScreen_Main();
+    Time2UpdateScreen = MyMillis() + ((CurrentScreen == SCREEN_MAIN) ? ScreenAnimateInterval : ScreenUpdateInterval);
+#ifdef PROFILE_SCREEN
+    uint32_t Start = MyMicros();
+    if (!Screen_Update())
+      return;
+    ProfileTime += MyMicros() - Start;
+    if (!(++ProfileFrames % 64))                                       // Report the average over 64 frames
+    {
+      Log("Screen: %lu uS %u enc %u patch\n", (unsigned long)(ProfileTime / 64), WidgetEncodes, WidgetPatches);
+      ProfileTime = 0;
+      WidgetEncodes = 0;
+      WidgetPatches = 0;
+    }
+#else
+    Screen_Update();
+#endif
   }
 }
 
@@ -135,55 +175,141 @@ void CheckScreen(void)
 // by 5, so we just leave the value as is and add it to the previous number
 // after subtracting 1/5 of its previous total.
 //
+// The probes are read every CheckSensorFastInterval while the solution is warming (or cooling) or is just short of
+// READY, and every CheckSensorInterval once it is steady or the warmer is off (Sensor_Rate()).  Each reading is
+// weighted by the mS since the last one against SensorFilterKeep mS (SensorFastFilterKeep while read fast), both in
+// periods of CheckSensorInterval, so the filter's time constant is set in time rather than in samples: 20000 gives
+// the old (Val * 4) / 5 + Raw at 5 S.
+// SensorFastFilterKeep of 8000 keeps 10 fast readings against each new one, a time constant of about 8 S where the
+// old 5 samples gave 22 S at 5 S and would give under 4 S at 800 mS.  In the simulator with probe noise of 0.4 C
+// rms, that under 4 S let the filtered reading run up to 1.0 C over the bag - the whole OVER TEMP margin - against
+// 0.6 C with 8000, for 0.03 C rms more lag while warming.
+// The PID loops run on their own timers at the rates their gains were tuned for, and only see fresher temperatures.
+// The time to READY estimate and the READY beep stay at CheckSensorInterval, but a new READY or OVER TEMP is sounded
+// as soon as it is seen.
+//
+// The raw readings also go to the estimate of the solution inside the bag (estimate.c), which once settled is what
+// the load PID, READY and the time to READY go by (Solution_Core()).  OVER TEMP is declared on either.
+//
 // This filtering could be removed and quantize the selector to 0.5 degrees
 // since the derivative term is not really affecting the loop anyway.
+static float Sensor_Filter(float Val, int16_t Raw, uint32_t Ms)
+{
+  uint16_t KeepMs = (SensorInterval < CheckSensorInterval) ? SensorFastFilterKeep : SensorFilterKeep;
+  float Periods = (float)Ms / CheckSensorInterval;                 // Against a fixed period, whatever the rate
+  float Keep = (float)KeepMs / CheckSensorInterval;                // 4 for SensorFilterKeep
+  float Sum = Keep + Periods;
+
+  return ((Val * Keep) / Sum) + ((Raw * 5 * Periods) / Sum);       // Raw x2, Val x10
+}
+
+// The solution temperature the loop and READY go by - inside the bag, once there is an estimate of that
+static uint16_t Solution_Core(void)
+{
+  return Estimate_Valid() ? Estimate_Core() : MainScreen.SolutionTemp;
+}
+
+// Choose the sample period for the next reading
+static void Sensor_Rate(void)
+{
+  uint16_t Interval = CheckSensorInterval;
+  float Rate;
+
+  if ((MyMillis() - RateTime) >= SensorRateWindow)
+  {
+    SolutionRate = ((SolutionVal - RateFrom) * 60000) / (MyMillis() - RateTime);
+    RateFrom = SolutionVal;
+    RateTime = MyMillis();
+  }
+
+  Rate = Estimate_Valid() ? Estimate_Rate() : SolutionRate;      // The model's rate comes without the window's delay
+  if (MainScreen.Activated && ((Rate >= SensorSteadyRate) || (Rate <= -SensorSteadyRate) ||
+                               (!MainScreen.Ready && ((Solution_Core() + SensorNearGoal) >= MainScreen.SolutionGoal))))
+    Interval = CheckSensorFastInterval;
+  if (Interval != SensorInterval)
+  {
+    Log("Sensors every %u mS\n", Interval);
+    SensorInterval = Interval;
+  }
+}
+
 void CheckSensors(void)
 {
+  uint32_t Ms;
+  uint16_t Solution;
+  bool Report;
+
   if (MyMillis() >= Time2CheckSensor)
   {
-    Time2CheckSensor = MyMillis() + CheckSensorInterval;
+    Time2CheckSensor = MyMillis() + SensorInterval;
+    Ms = MyMillis() - LastSensor;
+    LastSensor = MyMillis();
+    Report = (MyMillis() >= Time2Report);
+    if (Report)
+    {
+      Time2Report += CheckSensorInterval;                             // Keeps the cadence when read fast
+      if (MyMillis() >= Time2Report)
+        Time2Report = MyMillis() + CheckSensorInterval;
+    }
     
-    HeaterVal = ((HeaterVal * 4) / 5) + readTempProbe(OWTP_Plate);    // get new sample and filter by 5 samples  
+    PlateRaw = readTempProbe(OWTP_Plate);                             // read the temp probe and initiate next measurement (comes in x2)
+    HeaterVal = Sensor_Filter(HeaterVal, PlateRaw, Ms);               // get new sample and filter by 5 samples  
     if(HeaterVal < 100) HeaterVal = 100;                              // We choose to peg the value to the lowest possible gauge value  
     MainScreen.PlateTemp = HeaterVal;                                 // Save the calculated value 
-    snprintf(MainScreen.PlateTempText, 5, "%d", MainScreen.PlateTemp);
+    snprintf_P(MainScreen.PlateTempText, 5, PSTR("%d"), MainScreen.PlateTemp);
     InsertDecimal(MainScreen.PlateTempText);                          // Pre-format the aquired value into decimal number text
    
-//    uint16_t newval = readTempProbe(OWTP_Solution);                 // read the temp probe and initiate next measurement (comes in x2)
-//    float tmp = (SolutionVal * 4) / 5;                              // get 1/5 of the previous value and  multiply that value by 4   
-//    SolutionVal = tmp + newval;                                     // add the new sample to it (which is already 1/5 scale)      
-
-    SolutionVal = ((SolutionVal * 4) / 5) + readTempProbe(OWTP_Solution);// get new sample and filter by 5 samples
+    SolutionRaw = readTempProbe(OWTP_Solution);                          // read the temp probe and initiate next measurement (comes in x2)
+    SolutionVal = Sensor_Filter(SolutionVal, SolutionRaw, Ms);           // get new sample and filter by 5 samples
     if(SolutionVal < 200) SolutionVal = 200;                             // We choose to peg the value to the lowest possible gauge value  
     MainScreen.SolutionTemp = SolutionVal;                               // Save the calculated value 
-    snprintf(MainScreen.SolutionTempText, 5, "%d", MainScreen.SolutionTemp);
+    snprintf_P(MainScreen.SolutionTempText, 5, PSTR("%d"), MainScreen.SolutionTemp);
     InsertDecimal(MainScreen.SolutionTempText);                          // Pre-format the aquired value into decimal number text
 
-    if (MainScreen.SolutionTemp >= (MainScreen.SolutionGoal - 5))    // Alert the user when we get within a half degree of the goal
+    Estimate_Update(PlateRaw, SolutionRaw, Ms);                          // Follow the solution inside the bag
+    Solution = Solution_Core();
+
+    if (!MainScreen.Activated)
+      Eta_Reset();
+    else if (Report)
+      Eta_Update(Estimate_Valid() ? Solution : SolutionVal, MainScreen.SolutionGoal);   // Estimate the time to READY
+
+    if (Solution >= (MainScreen.SolutionGoal - 5))                   // Alert the user when we get within a half degree of the goal
     {
       uint16_t sound = 0x4841;                                       // Select Xylophone note C3
       MainScreen.Ready = true;
-      sprintf(MainScreen.ReadyText, "READY");
-      if (MainScreen.SolutionTemp > (MainScreen.SolutionGoal + 10))  // This is too hot!  Set the danger alert  
+      strcpy_P(MainScreen.ReadyText, Text_Ready);
+      if ((Solution > (MainScreen.SolutionGoal + 10)) ||              // This is too hot!  Set the danger alert  
+          (MainScreen.SolutionTemp > (MainScreen.SolutionGoal + 10)))
       {
         MainScreen.Ready = false;
-        sprintf(MainScreen.ReadyText, "OVER TEMP");
+        strcpy_P(MainScreen.ReadyText, Text_OverTemp);
         sound = 0x4845;
       }
       
-      SetPin(EveAudioEnable_PIN, 1);                                // Enable Audio
-      wr8(REG_VOL_SOUND + RAM_REG, 0xFF);                           // Set the volume to maximum
-      wr16(REG_SOUND + RAM_REG, sound);                             // 
-      wr8(REG_PLAY + RAM_REG, 1);                                   // Play the sound
-      while(rd8(REG_PLAY + RAM_REG));                               // Wait until sound finished
-      SetPin(EveAudioEnable_PIN, 0);                                // Disable Audio
+      EveRegOp Beep[3] = {
+        EVE_WR8(REG_VOL_SOUND + RAM_REG, 0xFF),                     // Set the volume to maximum
+        EVE_WR16(REG_SOUND + RAM_REG, sound),                       // 
+        EVE_WR8(REG_PLAY + RAM_REG, 1) };                           // Play the sound
+
+      if ((Report || (sound != Sounded)) && Power_Display())        // Not with the Eve in standby (warm bag, warmer idle)
+      {
+        SetPin(EveAudioEnable_PIN, 1);                              // Enable Audio
+        Eve_RunBatch(Beep, 3);
+        while(rd8(REG_PLAY + RAM_REG));                             // Wait until sound finished
+        SetPin(EveAudioEnable_PIN, 0);                              // Disable Audio
+        Sounded = sound;
+      }
     }
     else
     {
       MainScreen.Ready = false;
-      sprintf(MainScreen.ReadyText, "UNREADY");
+      Sounded = 0;
+      if (!(MainScreen.Activated && Eta_Text(MainScreen.ReadyText)))  // Time to READY if there is an estimate
+        strcpy_P(MainScreen.ReadyText, Text_Unready);
     }
 
+    Sensor_Rate();
   }
 }
 
@@ -195,8 +321,72 @@ void CheckSolution(void)
     
     // This is where we call the PID calculator for the solution
     // It generates the demand value which determines the heater setpoint goal
-    MainScreen.PlateGoal = PID_Load_Step(MainScreen.SolutionGoal, MainScreen.SolutionTemp);
+    int16_t Demand;
+
+    Model_Update(MainScreen.PlateTemp, MainScreen.SolutionTemp);  // Learn from whatever is driving the loop
+
+    if (Autotune_Loop() != TUNE_LOAD)                        // Unless the autotuner is driving this loop
+    {
+      Demand = PID_Load_Step(MainScreen.SolutionGoal, Solution_Core());
+      if (MainScreen.Feedforward)                            // Optional model based boost on top of the PID
+      {
+        Demand += Model_Feedforward(MainScreen.SolutionGoal, Solution_Core());
+        if (Demand < (int16_t)MainScreen.SolutionGoal) Demand = MainScreen.SolutionGoal;  // Same range as PID_Load_SetRange()
+        if (Demand > 600) Demand = 600;
+      }
+      MainScreen.PlateGoal = Demand;
+    }
+  }
+}
+
+static void PidLog_Close(void)
+{
+  FileClose(PidLog);
+  PidLog = FILE_NONE;
+}
+
+// Turn the warmer on - for the Activate button and the autotuner alike, so that either starts a new run of
+// pidlog.txt
+void Warmer_Activate(void)
+{
+  PID_ClearAll();                                               // Clean PID state in case it is still wound up from previous run.
+  SaveCount = 0;                                                // Sample counter
+  MainScreen.Activated = true;
+  MainScreen.ButtonText = Text_Deactivate;
+}
+
+// Data logging for testing - the first PidLogRecords readings after each Activate go to pidlog.txt.  The file stays
+// open meanwhile and is flushed every PidLogFlush readings, rather than being opened and closed for each one.
+// The readings are the probes' own (x10), not filtered, under a line "raw" - with the probes read faster than the
+// log is written, the filtered temperatures could no longer be taken back to the readings (host/replay.c).
+static void PidLog_Record(void)
+{
+  char tmpstr[16];
+  int Len;
+
+  if (SaveCount >= PidLogRecords)
+    return;
+  if (!SaveCount && (PidLog == FILE_NONE))
+  {
+    PidLog = FileOpen("pidlog.txt", FILEAPPEND);
+    if (PidLog == FILE_NONE)
+      Log("No file\n");
+  }
+
+  if (!SaveCount)
+  {
+    strcpy_P(tmpstr, PSTR("raw\n"));
+    FileWriteStr(PidLog, tmpstr, 4);
   }
+
+  // Log("%d: %d  %d\n", SaveCount, MainScreen.PlateTemp, MainScreen.SolutionTemp );
+  Len = snprintf_P(tmpstr, sizeof(tmpstr), PSTR("%d,%d\n"), PlateRaw * 5, SolutionRaw * 5);
+  FileWriteStr(PidLog, tmpstr, Len);
+  SaveCount++;
+  if (SaveCount == PidLogRecords)
+    PidLog_Close();
+  else if (!(SaveCount % PidLogFlush))
+    FileFlush(PidLog);
 }
 
 void CheckHeater(void)
@@ -204,17 +394,10 @@ void CheckHeater(void)
   if ( (MyMillis() >= Time2CheckHeater) && (MainScreen.Activated) )// Check for needed modifications to the output power (PWM)
   {
     Time2CheckHeater = MyMillis() + CheckHeaterInterval;
-    PWM_Val = PID_Heater_Step(MainScreen.PlateGoal, MainScreen.PlateTemp);
+    if (Autotune_Loop() != TUNE_HEATER)                      // Unless the autotuner is driving this loop
+      PWM_Val = PID_Heater_Step(MainScreen.PlateGoal, MainScreen.PlateTemp);
 
-    // Data logging for testing - save the first 1000 readings
-    if (SaveCount < 1000)
-    {
-      // Log("%d: %d  %d\n", SaveCount, MainScreen.PlateTemp, MainScreen.SolutionTemp );
-      uint8_t tmpstr[12];
-      sprintf(tmpstr, "%d,%d\n", MainScreen.PlateTemp, MainScreen.SolutionTemp);
-      FileWriteStr(tmpstr, 8);
-      SaveCount++;
-    }
+    PidLog_Record();                                       // Data logging for testing
   }
 
   if ((MyMillis() >= Time2CheckPWM) && (MainScreen.Activated)) // Actually do the PWM generation (software PWM) if system active
@@ -236,18 +419,72 @@ void CheckHeater(void)
   }
 }
 
+// Record the temperatures for the History screen
+void CheckHistory(void)
+{
+  if (MyMillis() >= Time2CheckHistory)
+  {
+    Time2CheckHistory = MyMillis() + CheckHistoryInterval;
+    History_Add(MainScreen.PlateTemp, MainScreen.SolutionTemp);
+#ifdef EVE_STATS
+    Eve_LogStats();                                                // SPI traffic so far
+#endif
+  }
+}
+
+// Sit here until the finger comes off the screen (or we have waited as long as we are willing to)
+static void WaitRelease(void)
+{
+  uint8_t Tag;
+
+  do
+  {
+    MyDelay(50);                                                  // Let's not do this too fast... 
+    Tag = rd8(REG_TOUCH_TAG + RAM_REG);                           // Read finger status (this is a somewhat cheesy check) 
+  }while (Tag && (MyMillis() < PressTimeout));
+}
+
+// Keep the goal the user set for the next power up (written to EEPROM once it stops changing)
+static void SaveGoal(void)
+{
+  if ((Settings.Have & SET_GOAL) && (Settings.SolutionGoal == MainScreen.SolutionGoal))
+    return;
+  Settings.SolutionGoal = MainScreen.SolutionGoal;
+  Settings.Have |= SET_GOAL;
+  Settings_Save();
+}
+
+// Start the interactive touch calibration.  CheckCalibrate() runs it and saves the result while everything else
+// carries on, and the old calibration stays if nobody taps the dots.
+void Recalibrate(void)
+{
+  Calibrate_Start(false);
+}
+
 void CheckTouch(void)
 {
   uint8_t Tag = 0;
-  uint32_t tracker;
+  EveTouch Touch;
   bool FingerDown = false;
   uint32_t tmp;
   static bool FirstTouch = false;
   static uint16_t X_First, Y_First, X_Last, Y_Last;
   
+  if (Calibrate_Active() || !Power_Touch())                       // The touches are calibration taps, or the
+  {                                                               // display is dark or has just been woken
+    FirstTouch = false;
+    return;
+  }
   if (MyMillis() >= Time2CheckTouch)
   {
-    tmp = rd32(REG_TOUCH_RAW_XY + RAM_REG); // This read eats any detected tag value (clears REG_TOUCH_TAG)
+    tmp = rd32(REG_TOUCH_RAW_XY + RAM_REG);                       // Nobody touching is the usual case - keep that cheap
+    if (tmp != 0xFFFFFFFF)
+      Power_Wake();                                               // Not idle
+    if ((tmp != 0xFFFFFFFF) && !FirstTouch)                       // A new touch is decided on one whole sample
+    {
+      Eve_ReadTouch(&Touch, false);
+      tmp = Touch.RawXY;
+    }
 
     // Check to see if we have non-FFFF values for raw X and Y coordinates
     if (tmp == 0xFFFFFFFF)
@@ -259,11 +496,7 @@ void CheckTouch(void)
         if ( (abs(X_First - X_Last) > 0x200) && (abs(Y_First - Y_Last) > 0x100) )
         {
 //         Log("\nSWIPE\n");
-          Cmd_SetRotate(0);  // Rotate the display to normal orientation to do the calibration
-          Calibrate_Manual(DWIDTH, DHEIGHT, PIXVOFFSET, PIXHOFFSET);
-          SaveTouchMatrix();
-//          LoadTouchMatrix(); // reload from flash to compare values
-          Cmd_SetRotate(1);  // Rotate the display back to where it was.  The main screen is automatically redrawn.
+          Recalibrate();
         }
         FirstTouch = false;
       }
@@ -278,10 +511,7 @@ void CheckTouch(void)
       }
       else                                                       // Finger down, but not already in swipe detection
       {
-        // We need to wait here while the Eve gets another touch sample since we ate the one that got us here
-        MyDelay(15);                                             
-        
-        Tag = rd8(REG_TOUCH_TAG + RAM_REG);                      // Check for tag touches
+        Tag = Touch.Tag;                                         // Check for tag touches
         Log("TAG: %d\n",Tag);
         if(Tag)
         {
@@ -295,23 +525,51 @@ void CheckTouch(void)
               MainScreen.Activated = false;
               MainScreen.HeaterOn = false;                       // Heater turns off when the system is deactivated
               SetPin(ControlOutput_PIN, 0);                      // Turn that heater OFF!
-              sprintf(MainScreen.ButtonText, "Activate");
+              PidLog_Close();                                    // The log of this run is finished
+              MainScreen.ButtonText = Text_Activate;
             }
             else
             {
-              PID_ClearAll();                                   // Clean PID state in case it is still wound up from previous run.
-              SaveCount = 0;                                    // Sample counter
-              MainScreen.Activated = true;
-              sprintf(MainScreen.ButtonText, "Deactivate");
+              Warmer_Activate();
+              Warmup_Start();                                   // Log how this warm-up goes
             }
 
-            do
-            {
-              MyDelay(50);                                        // Let's not do this too fast... 
-              Tag = rd8(REG_TOUCH_TAG + RAM_REG);                 // Read finger status (this is a somewhat cheesy check) 
-              if  ( (!Tag) || (MyMillis() >= PressTimeout) )
-                FingerDown = false; 
-            }while (FingerDown);
+            WaitRelease();
+            break;
+          case TAG_NEXTSCREEN:
+            Screen_Next();
+            WaitRelease();
+            break;
+          case TAG_GOALDOWN:
+          case TAG_GOALUP:
+            if ((Tag == TAG_GOALDOWN) && (MainScreen.SolutionGoal > 200))
+              MainScreen.SolutionGoal -= 5;                       // Half a degree at a time
+            if ((Tag == TAG_GOALUP) && (MainScreen.SolutionGoal < 400))
+              MainScreen.SolutionGoal += 5;
+            PID_Load_SetRange(MainScreen.SolutionGoal, 600);      // set the requested solution temperature.  Specified x10 in celsius
+            SaveGoal();
+            sprintf_P(MainScreen.GoalText, PSTR("%d"), MainScreen.SolutionGoal);
+            InsertDecimal(MainScreen.GoalText);
+            Screen_Draw();
+            WaitRelease();
+            break;
+          case TAG_CALIBRATE:
+            WaitRelease();
+            Recalibrate();
+            break;
+          case TAG_MODE:
+            MainScreen.Feedforward = !MainScreen.Feedforward;
+            Model_Log();
+            Screen_Draw();
+            WaitRelease();
+            break;
+          case TAG_AUTOTUNE:
+            if (Autotune_Loop() == TUNE_IDLE)
+              Autotune_Start();
+            else
+              Autotune_Cancel();
+            Screen_Draw();
+            WaitRelease();
             break;
           case 11:
             // Since we need to update the screen here as we move the finger, this input function blocks all other operations.
@@ -321,23 +579,24 @@ void CheckTouch(void)
         
             do
             {
-              tracker = rd32(REG_TRACKER + RAM_REG);
-              if ((tracker & 0xff) == 11)
+              Eve_ReadTouch(&Touch, true);                        // The tracker and the finger from one sample
+              if ((Touch.Tracker & 0xff) == 11)
               {
-                MainScreen.SolutionGoal = 200 + ((tracker >> 16) * 200) / 65536; 
+                MainScreen.SolutionGoal = 200 + ((Touch.Tracker >> 16) * 200) / 65536; 
                 PID_Load_SetRange(MainScreen.SolutionGoal, 600);  // set the requested solution temperature.  Specified x10 in celsius
+                SaveGoal();
               }
 
               // Pre-format the aquired value into decimal number text
-              sprintf(MainScreen.GoalText, "%d", MainScreen.SolutionGoal);
+              sprintf_P(MainScreen.GoalText, PSTR("%d"), MainScreen.SolutionGoal);
               InsertDecimal(MainScreen.GoalText);
           
-              MakeScreen_Main();                                  // Update the screen
+              Screen_Draw();                                      // Update the screen
                   
-              MyDelay(30);                                        // Let's not do this too fast... 
-              Tag = rd8(REG_TOUCH_TAG + RAM_REG);                 // Read finger status (this is a somewhat cheesy check)
-              if ( (!Tag) || (MyMillis() >= PressTimeout) )       // You can mess with touching this for only a limited time
+              if ( (!Touch.Tag) || (MyMillis() >= PressTimeout) ) // You can mess with touching this for only a limited time
                 FingerDown = false;                               // Finger is no longer touching
+              else
+                MyDelay(30);                                      // Let's not do this too fast... 
             }while (FingerDown);
             break; 
           default:                                                // Invalid tag value (importantly includes value 255)
@@ -375,17 +634,17 @@ uint32_t Load_JPG(uint32_t BaseAdd, uint32_t Options, char *filename)
 {
   uint32_t Remaining;
   uint32_t ReadBlockSize = 0;
+  FileHandle h;
 
   // Open the file on SD card by name
-  FileOpen(filename, FILEREAD);
-  if(!myFileIsOpen())
+  h = FileOpen(filename, FILEREAD);
+  if(h == FILE_NONE)
   {
 //    Log("%s not open\n", filename);
-    FileClose();
     return false;
   }
   
-  Remaining = FileSize();                                      // Store the size of the currently opened file
+  Remaining = FileSize(h);                                      // Store the size of the currently opened file
   
   Send_CMD(CMD_LOADIMAGE);                                     // Tell the CoProcessor to prepare for compressed data
   Send_CMD(BaseAdd);                                           // This is the address where decompressed data will go 
@@ -398,7 +657,13 @@ uint32_t Load_JPG(uint32_t BaseAdd, uint32_t Options, char *filename)
     else
       ReadBlockSize = Remaining;
     
-    FileReadBuf(LogBuf, ReadBlockSize); // Read a block of data from the file
+    ReadBlockSize = FileReadBuf(h, LogBuf, ReadBlockSize);   // Read a block of data from the file - what there was of it
+    if (!ReadBlockSize)                                      // Card error - the coprocessor is left wanting the rest
+    {
+      FileClose(h);
+      Log("%s read failed\n", filename);
+      return false;
+    }
     
     // write the block to FIFO
     CoProWrCmdBuf(LogBuf, ReadBlockSize);                    // Does FIFO triggering
@@ -407,7 +672,7 @@ uint32_t Load_JPG(uint32_t BaseAdd, uint32_t Options, char *filename)
     Remaining -= ReadBlockSize;                              // Reduce remaining data value by amount just read
     // Log("Remaining = %ld RBS = %ld\n", Remaining, ReadBlockSize);
   }
-  FileClose();
+  FileClose(h);
 
   Wait4CoProFIFOEmpty();                                     // wait here until the coprocessor has read and executed every pending command.
 
@@ -429,4 +694,4 @@ void InsertDecimal(char * str)
   str[i] = str[i-1];                                  // move the last digit over
   str[i-1] = '.';                                     // Insert a decimal
 }
-
+
@@ -5,14 +5,35 @@
 extern "C" {
 #endif
 
+// The loop intervals may be given by the build instead (the host simulator sweeps them)
+#ifndef CheckSensorInterval
 #define CheckSensorInterval     5000  // in mS
+#endif
+#ifndef CheckSensorFastInterval
+#define CheckSensorFastInterval  800  // in mS - while the solution warms or nears the goal (DS18S20 takes 750 mS)
+#endif
+#ifndef CheckHeaterInterval
 #define CheckHeaterInterval     5000  // in mS
+#endif
+#ifndef CheckSolutionInterval
 #define CheckSolutionInterval   16000 // in mS
+#endif
+#define SensorFilterKeep       20000  // in mS - what the filter keeps against each reading's time (Sensor_Filter())
+#define SensorFastFilterKeep    8000  // in mS - the same while read fast
+#define SensorRateWindow       60000  // in mS - the solution's rate of change is measured over this long
+#define SensorSteadyRate           5  // x10 degrees per minute - the solution is steady when changing slower
+#define SensorNearGoal            10  // x10 degrees - fast sampling this close below the goal until READY
 #define PressTimoutInterval     4000  // in mS
 #define CheckTouchInterval        15  // in mS
 #define CheckSwipeInterval        60  // in mS
 #define CheckPWMInterval          16  // in mS - PWM Base period = 256 * CheckPWMInterval
 #define ScreenUpdateInterval      50  // in mS
+#define ScreenAnimateInterval     33  // in mS - the main screen, only sent when something on it has changed
+#define CheckHistoryInterval   60000  // in mS - at about 2 bytes a sample the history ring holds over 2.5 hours
+#define PidLogRecords           1000  // CheckHeater() readings written to pidlog.txt after each Activate
+#define PidLogFlush               12  // Readings between flushes of pidlog.txt - a minute at CheckHeaterInterval
+
+// #define PROFILE_SCREEN                // Uncomment to log the average time taken to build the main screen
 
 // These integer values are x10 too big in order to get a decimal place but still use integers
 typedef struct {
@@ -20,7 +41,7 @@ typedef struct {
   uint16_t PlateGoal;
   uint16_t SolutionTemp;
   uint16_t SolutionGoal;
-  char ButtonText[16];
+  const char *ButtonText;             // In flash - Text_Activate or Text_Deactivate
   char ReadyText[16];
   char PlateTempText[6];
   char SolutionTempText[6];
@@ -28,22 +49,37 @@ typedef struct {
   bool HeaterOn;
   bool Activated;
   bool Ready;
+  bool Feedforward;                   // Load PID output has the model feedforward added (model.c)
 }ScreenParms;
 
 extern ScreenParms MainScreen;
 
+// Constant text of the main screen, in flash (PROGMEM)
+extern const char Text_Activate[];
+extern const char Text_Deactivate[];
+extern const char Text_Ready[];
+extern const char Text_OverTemp[];
+extern const char Text_Unready[];
+extern const char Text_Pid[];
+extern const char Text_PidFF[];
+extern uint8_t PWM_Val;
+
 void MakeScreen_Main(void);
+bool MainScreen_Changed(void);
 uint32_t Load_JPG(uint32_t BaseAdd, uint32_t Options, char *filename); 
 void CheckScreen(void);
 void CheckSensors(void);
-void CheckSolution(void);   // Check the sensor data and update TimeTillCat value
+void CheckSolution(void);   // Run the load PID loop to set the plate goal
 void CheckHeater(void) __attribute__((__optimize__("O2")));     // Run PID loop for heater
 void CheckTouch(void);      // Check for user touching and update values
+void CheckHistory(void);    // Record the temperatures in the history ring
 void InsertDecimal(char * str);
 void SetupMainScreen(void);
+void Warmer_Activate(void);
+void Recalibrate(void);
 
 #ifdef __cplusplus
 }
 #endif
 
-#endif
+#endif
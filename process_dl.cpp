@@ -0,0 +1,61 @@
+// Compile time command blobs for the screens built in process.c.
+// See Eve2_81x_DL.h for how these are made.
+
+#include <stdint.h>              // Find integer types like "uint8_t"
+#include "Eve2_81x.h"            // Matrix Orbital Eve2 Driver
+#include "Eve2_81x_DL.h"         // Compile time display list templates
+#include "MatrixEve2Conf.h"      // Header for EVE2 Display configuration settings
+#include "process.h"             // Prototypes for the blobs made here
+#include "screens.h"             // Touch tags and prototypes for the blobs made here
+#include "history.h"             // Plot area of the History screen
+
+using namespace EveDL;
+
+#define Y0 (VSIZE-DHEIGHT)       // Top of the visible area of the rotated screen - see MakeScreen_Main()
+
+// Static parts of the screens.  These are run once and the resulting display lists kept in RAM_G (screens.c).
+
+// Main - everything else is retained widgets in MakeScreen_Main()
+EVE_BLOB(Blob_MainStatic,     Cmd(CLEAR(1,1,1)) +
+                              Gradient(194, 21, 0x007FFF, 250, 280, 0x70FF00))     // Diagonal gradient blueish to yellowish
+
+// Settings - goal value between the -/+ buttons is drawn by MakeScreen_Settings()
+EVE_BLOB(Blob_SettingsStatic, Cmd(CLEAR(1,1,1)) +
+                              Gradient(194, 21, 0x007FFF, 250, 280, 0x70FF00) +
+                              Cmd(COLOR_RGB(0xFF, 0xFF, 0xFF)) + Text(10, Y0 + 8, 28, 0, "Settings") +
+                              Text(110, Y0 + 60, 26, OPT_CENTER, "Goal") +
+                              FGcolor(0x222288) + Cmd(COLOR_RGB(0xAA, 0xFF, 0xAA)) +
+                              Cmd(TAG(TAG_NEXTSCREEN)) + Button(370, Y0 + 6, 104, 36, 27, 0, "Next") +
+                              Cmd(TAG(TAG_GOALDOWN)) + Button(10, Y0 + 50, 60, 56, 31, 0, "-") +
+                              Cmd(TAG(TAG_GOALUP)) + Button(150, Y0 + 50, 60, 56, 31, 0, "+") +
+                              Cmd(TAG(TAG_CALIBRATE)) + Button(230, Y0 + 50, 120, 56, 28, 0, "Calibrate") +
+                              Cmd(TAG(TAG_AUTOTUNE)) + Button(360, Y0 + 50, 114, 56, 28, 0, "Autotune") +
+                              Cmd(TAG(0)))
+
+// History - plot area as given in history.h, the traces are appended by MakeScreen_History()
+EVE_BLOB(Blob_HistoryStatic,  Cmd(CLEAR_COLOR_RGB(0x10, 0x10, 0x30)) + Cmd(CLEAR(1,1,1)) +
+                              Cmd(COLOR_RGB(0xFF, 0xFF, 0xFF)) + Text(10, Y0 + 8, 28, 0, "History") +
+                              Text(HISTORY_X0 - 4, Y0 + HISTORY_YTOP, 26, OPT_RIGHTX|OPT_CENTERY, "70") +
+                              Text(HISTORY_X0 - 4, Y0 + HISTORY_YBOT, 26, OPT_RIGHTX|OPT_CENTERY, "20") +
+                              Cmd(COLOR_RGB(0x66, 0x66, 0x88)) + Cmd(BEGIN(LINE_STRIP)) +
+                              Cmd(VERTEX2F(HISTORY_X0 * 16, (Y0 + HISTORY_YTOP) * 16)) + Cmd(VERTEX2F(HISTORY_X1 * 16, (Y0 + HISTORY_YTOP) * 16)) +
+                              Cmd(VERTEX2F(HISTORY_X1 * 16, (Y0 + HISTORY_YBOT) * 16)) + Cmd(VERTEX2F(HISTORY_X0 * 16, (Y0 + HISTORY_YBOT) * 16)) +
+                              Cmd(VERTEX2F(HISTORY_X0 * 16, (Y0 + HISTORY_YTOP) * 16)) + Cmd(END()) +
+                              FGcolor(0x222288) + Cmd(COLOR_RGB(0xAA, 0xFF, 0xAA)) +
+                              Cmd(TAG(TAG_NEXTSCREEN)) + Button(370, Y0 + 6, 104, 36, 27, 0, "Next") +
+                              Cmd(TAG(0)))
+
+// Diagnostics - values are drawn by MakeScreen_Diag()
+EVE_BLOB(Blob_DiagStatic,     Cmd(CLEAR_COLOR_RGB(0x10, 0x10, 0x30)) + Cmd(CLEAR(1,1,1)) +
+                              Cmd(COLOR_RGB(0xFF, 0xFF, 0xFF)) + Text(10, Y0 + 8, 28, 0, "Diagnostics") +
+                              Text(10, Y0 + 60, 26, OPT_CENTERY, "Switch uS") +
+                              Text(10, Y0 + 80, 26, OPT_CENTERY, "Snapshot B") +
+                              Text(10, Y0 + 100, 26, OPT_CENTERY, "Uptime s") +
+                              Text(240, Y0 + 60, 26, OPT_CENTERY, "PWM") +
+                              Text(240, Y0 + 80, 26, OPT_CENTERY, "Plate goal") +
+                              Text(240, Y0 + 100, 26, OPT_CENTERY, "FIFO free") +
+                              Text(10, Y0 + 120, 26, OPT_CENTERY, "Stack B") +
+                              Text(240, Y0 + 120, 26, OPT_CENTERY, "RAM free") +
+                              FGcolor(0x222288) + Cmd(COLOR_RGB(0xAA, 0xFF, 0xAA)) +
+                              Cmd(TAG(TAG_NEXTSCREEN)) + Button(370, Y0 + 6, 104, 36, 27, 0, "Next") +
+                              Cmd(TAG(0)))
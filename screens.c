@@ -0,0 +1,200 @@
+// Screen manager.
+//
+// Every screen is split into a static part which never changes and an overlay of live values drawn on top of it.
+// The static part is run through the coprocessor once and the display list which it produces is copied into RAM_G
+// (a snapshot).  From then on a frame is CMD_DLSTART, a single CMD_APPEND of the snapshot, the overlay, and the
+// swap.  Nothing about the static part is sent again, so switching screens costs no more than drawing one frame.
+//
+// A screen with a Changed function is only sent when that says the overlay would look different, or after
+// Screen_Refresh() - the Eve goes on showing the last frame by itself.  The main screen's needles are animated this
+// way, at a high frame rate while they move and no frames at all once they have stopped.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdio.h>                 // sprintf_P() where flash is ordinary memory
+#include "Eve2_81x.h"              // Matrix Orbital Eve2 Driver
+#include "Arduino_AL.h"            // include the hardware specific abstraction layer header for the specific hardware in use.
+#include "MatrixEve2Conf.h"        // Header for EVE2 Display configuration settings
+#include "process.h"               // MainScreen
+#include "history.h"               // History_Draw()
+#include "autotune.h"              // Autotune_Status()
+#include "screens.h"               // Header for this file
+
+Screen Screens[SCREEN_COUNT] = {
+//  Static               Overlay              Changed              Snapshot address                      Size
+  { Blob_MainStatic,     MakeScreen_Main,     MainScreen_Changed,  RAMG_SCREENS + (0 * SCREEN_DL_MAX), 0 },
+  { Blob_SettingsStatic, MakeScreen_Settings, 0,                   RAMG_SCREENS + (1 * SCREEN_DL_MAX), 0 },
+  { Blob_HistoryStatic,  MakeScreen_History,  0,                   RAMG_SCREENS + (2 * SCREEN_DL_MAX), 0 },
+  { Blob_DiagStatic,     MakeScreen_Diag,     0,                   RAMG_SCREENS + (3 * SCREEN_DL_MAX), 0 },
+};
+
+uint8_t CurrentScreen = SCREEN_MAIN;
+uint32_t SwitchLatency = 0;
+uint32_t FramesSent = 0;
+uint32_t FramesSkipped = 0;
+static bool Shown = false;                                      // The last frame sent is of the current screen as it is
+
+// Run the static part of a screen through the coprocessor and copy the resulting display list into RAM_G.
+// The display list is never swapped in, so nothing of this shows up on the display.
+static void Screen_Snapshot(Screen *s)
+{
+  uint16_t Size;
+
+  s->Size = 0;
+  Send_CMD(CMD_DLSTART);
+  s->Static();
+  UpdateFIFO();                                                 // Trigger the CoProcessor to start processing commands out of the FIFO
+  Wait4CoProFIFOEmpty();                                        // wait here until the coprocessor has read and executed every pending command.
+
+  Size = rd16(REG_CMD_DL + RAM_REG);                            // Number of bytes of display list the coprocessor made
+  if (Size > SCREEN_DL_MAX)
+  {
+    Log("Snapshot too big: %u\n", Size);                        // This screen will have its static part rebuilt every frame
+    return;
+  }
+
+  Cmd_Memcpy(s->Addr, RAM_DL, Size);                            // Keep a copy in RAM_G
+  UpdateFIFO();
+  Wait4CoProFIFOEmpty();
+  s->Size = Size;
+}
+
+// Make the snapshots of all screens - must be done before any Screen_Draw()
+void Screens_Init(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < SCREEN_COUNT; i++)
+  {
+    Screen_Snapshot(&Screens[i]);
+    Log("Screen %d: %u bytes\n", i, Screens[i].Size);
+  }
+}
+
+// Rebuild the snapshots, e.g. after anything has disturbed RAM_G
+void Screens_Invalidate(void)
+{
+  Screens_Init();
+}
+
+// Make a new frame of the current screen
+void Screen_Draw(void)
+{
+  Screen *s = &Screens[CurrentScreen];
+  uint32_t Head[4];
+
+  Head[0] = CMD_DLSTART;
+  if (s->Size)
+  {
+    Head[1] = CMD_APPEND;                                       // The static part is just the copy in RAM_G
+    Head[2] = s->Addr;
+    Head[3] = s->Size;
+    Send_CMD_Words(Head, 4);
+  }
+  else
+  {
+    Send_CMD_Words(Head, 1);                                    // No snapshot - the static part is sent every time
+    s->Static();
+  }
+
+  s->Overlay();
+  Blob_FrameEnd();
+  UpdateFIFO();                                                 // Trigger the CoProcessor to start processing commands out of the FIFO
+  Shown = true;
+}
+
+// Make a new frame of the current screen if it would be any different from the last one.  Call once a frame.
+// Returns false if no frame was made.
+bool Screen_Update(void)
+{
+  Screen *s = &Screens[CurrentScreen];
+
+  if (s->Changed && !s->Changed() && Shown)
+  {
+    FramesSkipped++;
+    return false;
+  }
+  Screen_Draw();
+  FramesSent++;
+  return true;
+}
+
+// Have the next Screen_Update() make a frame whatever the screen says, e.g. when something else has been on the display
+void Screen_Refresh(void)
+{
+  Shown = false;
+}
+
+// Switch to another screen and draw it immediately
+void Screen_Show(uint8_t Id)
+{
+  uint32_t Start = MyMicros();
+
+  if (Id >= SCREEN_COUNT)
+    return;
+
+  CurrentScreen = Id;
+  Screen_Draw();
+
+  SwitchLatency = MyMicros() - Start;
+  Log("Screen %d in %lu uS\n", Id, (unsigned long)SwitchLatency);
+}
+
+// Cycle through the screens in order
+void Screen_Next(void)
+{
+  Screen_Show((CurrentScreen + 1) % SCREEN_COUNT);
+}
+
+// ************************************ Screen overlays ************************************
+// The static parts are blobs in process_dl.cpp.  See MakeScreen_Main() for notes on coordinates.
+
+void MakeScreen_Settings(void)
+{
+  Send_CMD(COLOR_RGB(0x88, 0xFF, 0x88));
+  Cmd_Text(110, 84 + (VSIZE-DHEIGHT), 29, OPT_CENTER, MainScreen.GoalText);    // Between the - and + buttons
+  Send_CMD(COLOR_RGB(0xFF, 0xFF, 0xFF));
+  Cmd_Text(120, 24 + (VSIZE-DHEIGHT), 26, OPT_CENTERY, Autotune_Status());
+  Cmd_FGcolor(MainScreen.Feedforward ? 0x228822 : 0x222288);
+  Send_CMD(COLOR_RGB(0xAA, 0xFF, 0xAA));
+  Send_CMD(TAG(TAG_MODE));
+  Cmd_Button_P(250, 6 + (VSIZE-DHEIGHT), 110, 36, 27, 0, MainScreen.Feedforward ? Text_PidFF : Text_Pid);  // Controller mode
+  Send_CMD(TAG(0));
+}
+
+void MakeScreen_History(void)
+{
+  char Buf[24];
+
+  History_Draw();                                               // The graph - colours match the text below
+
+  Send_CMD(COLOR_RGB(0xFF, 0xAA, 0x55));
+  Cmd_Text(250, 24 + (VSIZE-DHEIGHT), 27, OPT_CENTERY, MainScreen.PlateTempText);
+  Send_CMD(COLOR_RGB(0x55, 0xCC, 0xFF));
+  Cmd_Text(310, 24 + (VSIZE-DHEIGHT), 27, OPT_CENTERY, MainScreen.SolutionTempText);
+  sprintf_P(Buf, PSTR("%lu min"), (unsigned long)History_Count() * (CheckHistoryInterval / 1000) / 60);
+  Send_CMD(COLOR_RGB(0xAA, 0xAA, 0xAA));
+  Cmd_Text(130, 24 + (VSIZE-DHEIGHT), 26, OPT_CENTERY, Buf);
+}
+
+void MakeScreen_Diag(void)
+{
+  char Buf[12];
+
+  Send_CMD(COLOR_RGB(0x88, 0xFF, 0x88));
+  sprintf_P(Buf, PSTR("%lu"), (unsigned long)SwitchLatency);
+  Cmd_Text(130, 60 + (VSIZE-DHEIGHT), 26, OPT_CENTERY, Buf);
+  sprintf_P(Buf, PSTR("%u"), Screens[CurrentScreen].Size);
+  Cmd_Text(130, 80 + (VSIZE-DHEIGHT), 26, OPT_CENTERY, Buf);
+  sprintf_P(Buf, PSTR("%lu"), (unsigned long)(MyMillis() / 1000));
+  Cmd_Text(130, 100 + (VSIZE-DHEIGHT), 26, OPT_CENTERY, Buf);
+  sprintf_P(Buf, PSTR("%u"), PWM_Val);
+  Cmd_Text(360, 60 + (VSIZE-DHEIGHT), 26, OPT_CENTERY, Buf);
+  sprintf_P(Buf, PSTR("%u"), MainScreen.PlateGoal);
+  Cmd_Text(360, 80 + (VSIZE-DHEIGHT), 26, OPT_CENTERY, Buf);
+  sprintf_P(Buf, PSTR("%u"), CoProFIFO_FreeSpace());
+  Cmd_Text(360, 100 + (VSIZE-DHEIGHT), 26, OPT_CENTERY, Buf);
+  sprintf_P(Buf, PSTR("%u"), Mem_StackUsed());                 // 0 where the board does not say
+  Cmd_Text(130, 120 + (VSIZE-DHEIGHT), 26, OPT_CENTERY, Buf);
+  sprintf_P(Buf, PSTR("%u"), Mem_Free());
+  Cmd_Text(360, 120 + (VSIZE-DHEIGHT), 26, OPT_CENTERY, Buf);
+}
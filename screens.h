@@ -0,0 +1,66 @@
+#ifndef SCREENS_H
+#define SCREENS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>                   // Find integer types like "uint8_t"
+#include <stdbool.h>                  // Find type "bool"
+
+#define SCREEN_MAIN                0
+#define SCREEN_SETTINGS            1
+#define SCREEN_HISTORY             2
+#define SCREEN_DIAG                3
+#define SCREEN_COUNT               4
+
+// The static display list of every screen is kept in RAM_G from RAMG_SCREENS up, SCREEN_DL_MAX bytes apiece
+#define RAMG_SCREENS         0xF0000
+#define SCREEN_DL_MAX         0x1000
+
+// Touch tags used by the screens (the main screen also uses 1 for the activate button and 11 for the dial)
+#define TAG_NEXTSCREEN            20
+#define TAG_GOALDOWN              30
+#define TAG_GOALUP                31
+#define TAG_CALIBRATE             32
+#define TAG_AUTOTUNE              33
+#define TAG_MODE                  34
+
+typedef struct {
+  void (*Static)(void);               // Sends the part of the screen which never changes (no DL start or DISPLAY)
+  void (*Overlay)(void);              // Sends the live part of the screen, drawn on top of the static part
+  bool (*Changed)(void);              // Called once a frame - false if the overlay would be the same as last time.
+                                      // NULL for screens which are drawn every frame.
+  uint32_t Addr;                      // RAM_G address of the copy of the static display list
+  uint16_t Size;                      // Size of that copy in bytes - 0 if there is none
+} Screen;
+
+extern uint8_t CurrentScreen;
+extern uint32_t SwitchLatency;        // uS taken by the last screen switch until its first frame was queued
+extern uint32_t FramesSent;           // By Screen_Update()
+extern uint32_t FramesSkipped;        // Not sent by Screen_Update() as nothing had changed
+
+void Screens_Init(void);
+void Screens_Invalidate(void);
+void Screen_Show(uint8_t Id);
+void Screen_Next(void);
+void Screen_Draw(void);
+bool Screen_Update(void);
+void Screen_Refresh(void);
+
+// Overlays of the screens other than main (main is MakeScreen_Main() in process.c)
+void MakeScreen_Settings(void);
+void MakeScreen_History(void);
+void MakeScreen_Diag(void);
+
+// Compile time command blobs for the static parts - built in process_dl.cpp
+void Blob_MainStatic(void);
+void Blob_SettingsStatic(void);
+void Blob_HistoryStatic(void);
+void Blob_DiagStatic(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,185 @@
+// Settings kept over a power cycle - touch calibration, the solution goal and autotuned PID gains.
+//
+// Settings lives in EEPROM (NV_Read() and friends of the hardware abstraction layer) as records of SETTINGS_SLOT
+// bytes each:
+//     Sequence (2 bytes), Version, Length, CRC (2 bytes), Length bytes of SettingsType
+// Every save goes into the slot after the last one with a sequence number one higher, so the writes are spread
+// over the whole EEPROM, and a save cut short by a reset leaves the record before it to be found.  At boot the
+// record with the highest sequence number and a good CRC is loaded: a few hundred EEPROM reads instead of mounting
+// the SD card and reading files, so the touch screen is calibrated before the SD card is looked at.
+//
+// A record of another version loads the fields the two have in common, as fields are only ever added at the end
+// of SettingsType and Have says which of them hold values.  Records are SettingsType as the processor lays it out,
+// so they belong to the board that wrote them.
+//
+// Writing is done by CheckSettings() a byte per pass of MainLoop(), whenever the EEPROM is not busy (an AVR byte
+// write takes 3.3 mS), once Settings_Save() has not been called for SETTINGS_DELAY.  The SD card files of
+// SaveTouchMatrix() and SavePIDGains() are still written: they are imported when there is no record, and they are
+// all there is on boards without EEPROM.
+
+#include <stdint.h>                // Find integer types like "uint8_t"
+#include <stdbool.h>               // Find type "bool"
+#include <string.h>                // memset()
+#include <stdio.h>                 // sprintf()
+#include "Arduino_AL.h"            // NV_Read() MyMillis()
+#include "settings.h"              // Header for this file
+
+typedef struct {
+  uint16_t Sequence;
+  uint8_t  Version;
+  uint8_t  Length;                 // Bytes of SettingsType after the header
+  uint16_t Crc;                    // Of the header up to here and the Length bytes
+} SettingsHeader;
+
+#define HEADER_CRCED    4          // Bytes of the header under the CRC
+
+SettingsType Settings;
+
+static SettingsHeader Head;        // Of the record being written, or the last one
+static uint8_t  Slot;              // Being written, or the next to be
+static uint8_t  Written;           // Bytes of the record written so far
+static bool     Writing;
+static bool     Pending;           // Settings_Save() was called
+static uint32_t Due;               // MyMillis() to start writing
+
+// CRC-16/CCITT
+static uint16_t Settings_Crc(uint16_t Crc, uint8_t Byte)
+{
+  uint8_t i;
+
+  Crc ^= (uint16_t)Byte << 8;
+  for (i = 0; i < 8; i++)
+    Crc = (Crc & 0x8000) ? ((Crc << 1) ^ 0x1021) : (Crc << 1);
+  return Crc;
+}
+
+static uint8_t Settings_Slots(void)
+{
+  uint16_t n = NV_Size() / SETTINGS_SLOT;
+
+  return (n > SETTINGS_SLOTS) ? SETTINGS_SLOTS : n;
+}
+
+static void Settings_Read(uint16_t Address, void *Data, uint8_t Len)
+{
+  uint8_t *p = (uint8_t *)Data;
+
+  while (Len--)
+    *p++ = NV_Read(Address++);
+}
+
+// True if the record in slot s has the CRC its header says
+static bool Settings_Good(uint8_t s, const SettingsHeader *h)
+{
+  uint16_t Address = (s * SETTINGS_SLOT) + sizeof(SettingsHeader);
+  uint16_t Crc = 0xFFFF;
+  uint8_t i;
+
+  for (i = 0; i < HEADER_CRCED; i++)
+    Crc = Settings_Crc(Crc, ((const uint8_t *)h)[i]);
+  for (i = 0; i < h->Length; i++)
+    Crc = Settings_Crc(Crc, NV_Read(Address + i));
+  return (Crc == h->Crc);
+}
+
+// Load the newest good record into Settings.  Returns false, with nothing in Settings, if there is none.
+bool Settings_Load(void)
+{
+  SettingsHeader h, Best;
+  uint32_t Rejected = 0;           // Slots whose CRC is bad
+  uint8_t n = Settings_Slots();
+  uint8_t s, Found;
+
+  memset(&Settings, 0, sizeof(Settings));
+  memset(&Head, 0, sizeof(Head));
+  memset(&Best, 0, sizeof(Best));
+  Slot = 0;
+  Writing = Pending = false;
+
+  while (true)
+  {
+    Found = n;
+    for (s = 0; s < n; s++)
+    {
+      if (Rejected & (1UL << s))
+        continue;
+      Settings_Read(s * SETTINGS_SLOT, &h, sizeof(h));
+      if ((h.Version == 0) || (h.Version == 0xFF) || !h.Length ||        // Erased or never written
+          (h.Length > (SETTINGS_SLOT - sizeof(SettingsHeader))))
+        continue;
+      if ((Found == n) || ((int16_t)(h.Sequence - Best.Sequence) > 0))  // Newer, allowing for the count wrapping
+      {
+        Best = h;
+        Found = s;
+      }
+    }
+    if (Found == n)
+    {
+      Log("No settings\n");
+      return false;
+    }
+    if (Settings_Good(Found, &Best))
+      break;
+    Rejected |= 1UL << Found;                                      // Try the one before it
+  }
+
+  Settings_Read((Found * SETTINGS_SLOT) + sizeof(SettingsHeader), &Settings,
+                (Best.Length < sizeof(Settings)) ? Best.Length : sizeof(Settings));
+  Head = Best;
+  Slot = (Found + 1) % n;
+  Log("Settings %u v%u: %02x\n", Head.Sequence, Head.Version, Settings.Have);
+  return true;
+}
+
+// Have Settings written to EEPROM once they stop changing
+void Settings_Save(void)
+{
+  Pending = true;
+  Due = MyMillis() + SETTINGS_DELAY;
+}
+
+// Write the next byte of a saved record, if the EEPROM is ready for it.  A change made while a record is being
+// written spoils its CRC and is written again into the next slot.
+void CheckSettings(void)
+{
+  uint8_t n = Settings_Slots();
+  uint8_t i, Byte;
+
+  if (!n)                                                          // No EEPROM on this board
+    return;
+
+  if (!Writing)
+  {
+    if (!Pending || (MyMillis() < Due))
+      return;
+    Pending = false;
+    Head.Sequence++;
+    Head.Version = SETTINGS_VERSION;
+    Head.Length = sizeof(Settings);
+    Head.Crc = 0xFFFF;
+    for (i = 0; i < HEADER_CRCED; i++)
+      Head.Crc = Settings_Crc(Head.Crc, ((uint8_t *)&Head)[i]);
+    for (i = 0; i < sizeof(Settings); i++)
+      Head.Crc = Settings_Crc(Head.Crc, ((uint8_t *)&Settings)[i]);
+    Written = 0;
+    Writing = true;
+  }
+
+  if (NV_Busy())
+    return;
+  if (Written < sizeof(Head))
+    Byte = ((uint8_t *)&Head)[Written];
+  else
+    Byte = ((uint8_t *)&Settings)[Written - sizeof(Head)];
+  NV_Write((Slot * SETTINGS_SLOT) + Written, Byte);
+
+  if (++Written == (sizeof(Head) + sizeof(Settings)))
+  {
+    NV_Commit();
+    Writing = false;
+    Slot = (Slot + 1) % n;
+  }
+}
+
+// The record has to fit its slot
+typedef char SettingsFitsSlot[((sizeof(SettingsHeader) + sizeof(SettingsType)) <= SETTINGS_SLOT) ? 1 : -1];
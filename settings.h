@@ -0,0 +1,38 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>                   // Find integer types like "uint8_t"
+#include <stdbool.h>                  // Find type "bool"
+
+#define SETTINGS_VERSION           1  // Goes up when fields are added - only ever at the end of SettingsType
+#define SETTINGS_SLOT             64  // Bytes of EEPROM per record
+#define SETTINGS_SLOTS            32  // Most slots used, however big the EEPROM
+#define SETTINGS_DELAY          3000  // mS a change has to stand before it is written (the dial makes many)
+
+#define SET_TOUCH               0x01  // Settings.Have - TouchMatrix holds a calibration
+#define SET_GOAL                0x02  // SolutionGoal was set by the user
+#define SET_GAINS               0x04  // HeaterGains and LoadGains were autotuned
+
+typedef struct {
+  uint8_t  Have;                      // SET_xxx - which of the rest hold values
+  uint16_t SolutionGoal;              // x10 degrees
+  uint32_t TouchMatrix[6];            // REG_TOUCH_TRANSFORM_A to F
+  float    HeaterGains[3];            // Kp, Ki, Kd
+  float    LoadGains[3];
+} SettingsType;
+
+extern SettingsType Settings;
+
+bool Settings_Load(void);
+void Settings_Save(void);
+void CheckSettings(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif